@@ -54,6 +54,8 @@ void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
 
+void MAIN_processAudioBlock(void);
+
 /* USER CODE END EFP */
 
 /* Private defines -----------------------------------------------------------*/
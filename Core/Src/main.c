@@ -60,6 +60,8 @@ SRAM_HandleTypeDef hsram1;
 
 /* USER CODE BEGIN PV */
 
+static volatile uint8_t audio_processing_started;
+
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -135,6 +137,11 @@ int main(void)
   k_BspInit();
   DAMC_start();
 
+  // Audio processing runs in PendSV at the lowest priority: it preempts the main loop
+  // but not the USB interrupt which raises it
+  HAL_NVIC_SetPriority(PendSV_IRQn, 15, 0);
+  audio_processing_started = 1;
+
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -144,44 +151,7 @@ int main(void)
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
-	  if(usb_new_frame_flag) {
-		  usb_new_frame_flag = 0;
-
-		  size_t nframes = usb_audio_endpoint_out_data[0].nominal_packet_size / USBD_AUDIO_BYTES_PER_SAMPLE / USBD_AUDIO_CHANNELS;
-
-		  USBD_AUDIO_LoopbackDataTypeDef* data_out[2] = {
-			&usb_audio_endpoint_out_data[0],
-			&usb_audio_endpoint_out_data[1],
-		  };
-		  USBD_AUDIO_LoopbackDataTypeDef* data_in[1] = {
-			&usb_audio_endpoint_in_data[0]
-		  };
-
-		  uint8_t* endpoint_out_buffer[2];
-		  uint8_t* endpoint_in_buffer[1];
-
-		  for(size_t i = 0; i < sizeof(data_out)/sizeof(data_out[0]); i++) {
-			  endpoint_out_buffer[i] = USBD_AUDIO_GetBufferFromApp(data_out[i]);
-		  }
-		  for(size_t i = 0; i < sizeof(data_in)/sizeof(data_in[0]); i++) {
-			  endpoint_in_buffer[i] = USBD_AUDIO_GetBufferFromApp(data_in[i]);
-		  }
-
-		  DAMC_processAudioInterleaved(
-				  (const int16_t**)endpoint_out_buffer,
-				  sizeof(data_out)/sizeof(data_out[0]),
-				  (int16_t**)endpoint_in_buffer,
-				  sizeof(data_in)/sizeof(data_in[0]),
-				  nframes);
-
-		  for(size_t i = 0; i < sizeof(data_out)/sizeof(data_out[0]); i++) {
-			  USBD_AUDIO_ReleaseBufferFromApp(data_out[i]);
-		  }
-		  for(size_t i = 0; i < sizeof(data_in)/sizeof(data_in[0]); i++) {
-			  USBD_AUDIO_ReleaseBufferFromApp(data_in[i]);
-		  }
-	  }
-
+	  // Audio blocks are processed in PendSV_Handler, raised on USB SOF
 	  DAMC_mainLoop();
   }
   /* USER CODE END 3 */
@@ -838,6 +808,53 @@ static void MX_GPIO_Init(void)
 
 /* USER CODE BEGIN 4 */
 
+/**
+ * @brief Process one audio block, called from PendSV_Handler when USBD_AUDIO_SOF raises it
+ * @param None
+ * @retval None
+ */
+void MAIN_processAudioBlock(void)
+{
+  if(!usb_new_frame_flag || !audio_processing_started)
+	return;
+
+  usb_new_frame_flag = 0;
+
+  size_t nframes = usb_audio_endpoint_out_data[0].nominal_packet_size / USBD_AUDIO_BYTES_PER_SAMPLE / USBD_AUDIO_CHANNELS;
+
+  USBD_AUDIO_LoopbackDataTypeDef* data_out[2] = {
+	&usb_audio_endpoint_out_data[0],
+	&usb_audio_endpoint_out_data[1],
+  };
+  USBD_AUDIO_LoopbackDataTypeDef* data_in[1] = {
+	&usb_audio_endpoint_in_data[0]
+  };
+
+  uint8_t* endpoint_out_buffer[2];
+  uint8_t* endpoint_in_buffer[1];
+
+  for(size_t i = 0; i < sizeof(data_out)/sizeof(data_out[0]); i++) {
+	  endpoint_out_buffer[i] = USBD_AUDIO_GetBufferFromApp(data_out[i]);
+  }
+  for(size_t i = 0; i < sizeof(data_in)/sizeof(data_in[0]); i++) {
+	  endpoint_in_buffer[i] = USBD_AUDIO_GetBufferFromApp(data_in[i]);
+  }
+
+  DAMC_processAudioInterleaved(
+		  (const int16_t**)endpoint_out_buffer,
+		  sizeof(data_out)/sizeof(data_out[0]),
+		  (int16_t**)endpoint_in_buffer,
+		  sizeof(data_in)/sizeof(data_in[0]),
+		  nframes);
+
+  for(size_t i = 0; i < sizeof(data_out)/sizeof(data_out[0]); i++) {
+	  USBD_AUDIO_ReleaseBufferFromApp(data_out[i]);
+  }
+  for(size_t i = 0; i < sizeof(data_in)/sizeof(data_in[0]); i++) {
+	  USBD_AUDIO_ReleaseBufferFromApp(data_in[i]);
+  }
+}
+
 
 
 /**
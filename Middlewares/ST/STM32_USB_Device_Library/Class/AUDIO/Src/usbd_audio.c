@@ -625,6 +625,8 @@ static uint8_t USBD_AUDIO_SOF(USBD_HandleTypeDef *pdev)
 
   if((frameNumber % 8) == 0) {
 	  usb_new_frame_flag = 1;
+	  // Process the audio block in PendSV, after this interrupt
+	  SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
   }
 
   for(size_t i = 0; i < AUDIO_IN_NUMBER; i++) {
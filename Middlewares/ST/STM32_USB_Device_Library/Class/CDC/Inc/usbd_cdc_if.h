@@ -36,8 +36,17 @@ extern USBD_CDC_ItfTypeDef  USBD_CDC_IF_fops;
 /* Exported functions ------------------------------------------------------- */
 
 void USB_CDC_IF_TX_write(const uint8_t *Buf, uint32_t Len);
+
+/* Zero-copy TX: write directly in the TX ring then commit the written size */
+uint32_t USB_CDC_IF_TX_get_free_size(void);
+uint8_t* USB_CDC_IF_TX_get_write_span(uint32_t *size);
+void USB_CDC_IF_TX_commit(uint32_t size);
 uint32_t USB_CDC_IF_RX_read(uint8_t *Buf, uint32_t max_len);
 
+/* Zero-copy RX: parse received data in place in the RX ring then consume the parsed size */
+const uint8_t* USB_CDC_IF_RX_get_read_span(uint32_t *size);
+void USB_CDC_IF_RX_consume(uint32_t size);
+
 #ifdef __cplusplus
 }
 #endif
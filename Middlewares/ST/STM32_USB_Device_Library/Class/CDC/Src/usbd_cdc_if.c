@@ -103,35 +103,65 @@ static USBD_HandleTypeDef *usb_pdev;
 
 /* Private functions ---------------------------------------------------------*/
 
-static void USB_CDC_IF_BUFFER_write_char(struct USBD_CDC_CircularBuffer* buffer, uint8_t c)
+static uint32_t USB_CDC_IF_BUFFER_write(struct USBD_CDC_CircularBuffer* buffer, const uint8_t *data, uint32_t len)
 {
-  assert(buffer->write_index < sizeof(buffer->buffer));
-  assert(buffer->read_index < sizeof(buffer->buffer));
-
-  uint16_t next_write_index = (buffer->write_index + 1) % sizeof(buffer->buffer);
-  if(next_write_index != buffer->read_index) {
-    // Buffer not full
-    buffer->buffer[buffer->write_index] = c;
-    assert(next_write_index < sizeof(buffer->buffer));
-    __DSB();
-    buffer->write_index = next_write_index;
+  uint16_t start = buffer->write_index;
+  uint16_t max_size = (buffer->read_index - buffer->write_index - 1 + sizeof(buffer->buffer)) % sizeof(buffer->buffer);
+
+  assert(start < sizeof(buffer->buffer));
+
+  // Data not fitting in the buffer is discarded
+  if(len > max_size)
+    len = max_size;
+
+  uint16_t end = (start + len) % sizeof(buffer->buffer);
+
+  if(end < start) {
+    // Copy between start and end of buffer
+    uint16_t first_chunk_size = sizeof(buffer->buffer) - start;
+    memcpy(&buffer->buffer[start], data, first_chunk_size);
+
+    // then between begin of buffer and end
+    memcpy(&buffer->buffer[0], &data[first_chunk_size], end);
+  } else {
+    // Copy from start to end
+    memcpy(&buffer->buffer[start], data, end - start);
   }
+
+  __DSB();
+  buffer->write_index = end;
+
+  return len;
 }
 
-static uint8_t USB_CDC_IF_BUFFER_read_char(struct USBD_CDC_CircularBuffer* buffer, uint8_t* c)
+static uint32_t USB_CDC_IF_BUFFER_read(struct USBD_CDC_CircularBuffer* buffer, uint8_t *data, uint32_t max_len)
 {
-  if(buffer->read_index == buffer->write_index) {
-    // Buffer empty
-    return 0;
-  }
+  uint16_t start = buffer->read_index;
+  uint16_t len = (buffer->write_index - start + sizeof(buffer->buffer)) % sizeof(buffer->buffer);
+
+  assert(start < sizeof(buffer->buffer));
+
+  if(len > max_len)
+    len = max_len;
 
-  assert(buffer->read_index < sizeof(buffer->buffer));
+  uint16_t end = (start + len) % sizeof(buffer->buffer);
+
+  if(end < start) {
+    // Copy between start and end of buffer
+    uint16_t first_chunk_size = sizeof(buffer->buffer) - start;
+    memcpy(data, &buffer->buffer[start], first_chunk_size);
+
+    // then between begin of buffer and end
+    memcpy(&data[first_chunk_size], &buffer->buffer[0], end);
+  } else {
+    // Copy from start to end
+    memcpy(data, &buffer->buffer[start], end - start);
+  }
 
-  *c = buffer->buffer[buffer->read_index];
   __DSB();
-  buffer->read_index = (buffer->read_index + 1) % sizeof(buffer->buffer);
+  buffer->read_index = end;
 
-  return 1;
+  return len;
 }
 
 static void USB_CDC_IF_sendPending() {
@@ -316,38 +346,11 @@ static int8_t USB_CDC_IF_Control(USBD_SetupReqTypedef *req, uint8_t *pbuf, uint1
   */
 static int8_t USB_CDC_IF_Receive(uint8_t *Buf, uint32_t *Len)
 {
-  uint16_t start = rxBuffer.write_index;
-  uint16_t size = *Len;
-  uint16_t max_size = (rxBuffer.read_index - rxBuffer.write_index - 1 + sizeof(rxBuffer.buffer)) % sizeof(rxBuffer.buffer);
-
-  rxBuffer.current_theorical_size += size;
+  rxBuffer.current_theorical_size += *Len;
   if(rxBuffer.max_write_size < rxBuffer.current_theorical_size)
     rxBuffer.max_write_size = rxBuffer.current_theorical_size;
 
-  if(size > max_size)
-    size = max_size;
-
-  uint16_t end = (start + size) % sizeof(rxBuffer.buffer);
-
-  assert(start < sizeof(rxBuffer.buffer));
-  assert(end < sizeof(rxBuffer.buffer));
-
-
-  if(end < start) {
-    // Copy between start and end of buffer
-    uint16_t first_chunk_size = sizeof(rxBuffer.buffer) - start;
-    memcpy(&rxBuffer.buffer[start], rxBuffer.usb_buffer, first_chunk_size);
-
-    // then between begin of buffer and end
-    memcpy(&rxBuffer.buffer[0], &rxBuffer.usb_buffer[first_chunk_size], end);
-  } else {
-    // Copy from start to end
-    memcpy(&rxBuffer.buffer[start], rxBuffer.usb_buffer, end - start);
-  }
-
-  assert(end < sizeof(rxBuffer.buffer));
-  __DSB();
-  rxBuffer.write_index = end;
+  USB_CDC_IF_BUFFER_write(&rxBuffer, rxBuffer.usb_buffer, *Len);
 
   USBD_CDC_ReceivePacket(usb_pdev);
 
@@ -385,10 +388,7 @@ void USB_CDC_IF_TX_write(const uint8_t *Buf, uint32_t Len)
   if(!usb_pdev)
     return;
 
-  size_t i;
-  for(i = 0; i < Len; i++) {
-    USB_CDC_IF_BUFFER_write_char(&txBuffer, Buf[i]);
-  }
+  USB_CDC_IF_BUFFER_write(&txBuffer, Buf, Len);
 
   txBuffer.current_theorical_size += Len;
   if(txBuffer.max_write_size < txBuffer.current_theorical_size)
@@ -397,19 +397,99 @@ void USB_CDC_IF_TX_write(const uint8_t *Buf, uint32_t Len)
   USB_CDC_IF_sendPending();
 }
 
-uint32_t USB_CDC_IF_RX_read(uint8_t *Buf, uint32_t max_len)
+uint32_t USB_CDC_IF_TX_get_free_size(void)
 {
-  size_t i = 0;
-  while(i < max_len && USB_CDC_IF_BUFFER_read_char(&rxBuffer, &Buf[i])) {
-    i++;
+  if(!usb_pdev)
+    return 0;
+
+  return (txBuffer.read_index - txBuffer.write_index - 1 + sizeof(txBuffer.buffer)) % sizeof(txBuffer.buffer);
+}
+
+/**
+  * @brief  USB_CDC_IF_TX_get_write_span
+  *         Get the contiguous free space at the TX write position.
+  *         When the free space wraps around the end of the ring, a second call after
+  *         USB_CDC_IF_TX_commit returns the remaining part.
+  * @param  size: set to the number of bytes that can be written at the returned pointer
+  * @retval Pointer where to write data
+  */
+uint8_t* USB_CDC_IF_TX_get_write_span(uint32_t *size)
+{
+  uint16_t read_index = txBuffer.read_index;
+  uint16_t write_index = txBuffer.write_index;
+
+  if(read_index > write_index) {
+    *size = read_index - write_index - 1;
+  } else {
+    // Up to the end of the ring, keep one byte free if the reader is at the start
+    *size = sizeof(txBuffer.buffer) - write_index - (read_index == 0 ? 1 : 0);
   }
+
+  return &txBuffer.buffer[write_index];
+}
+
+void USB_CDC_IF_TX_commit(uint32_t size)
+{
+  if(!usb_pdev || size == 0)
+    return;
+
+  __DSB();
+  txBuffer.write_index = (txBuffer.write_index + size) % sizeof(txBuffer.buffer);
+
+  txBuffer.current_theorical_size += size;
+  if(txBuffer.max_write_size < txBuffer.current_theorical_size)
+    txBuffer.max_write_size = txBuffer.current_theorical_size;
+
+  USB_CDC_IF_sendPending();
+}
+
+static void USB_CDC_IF_RX_update_size(uint32_t read_size)
+{
   if(rxBuffer.read_index == rxBuffer.write_index) {
     rxBuffer.current_theorical_size = 0;
   } else {
-    rxBuffer.current_theorical_size -= i;
+    rxBuffer.current_theorical_size -= read_size;
   }
+}
+
+uint32_t USB_CDC_IF_RX_read(uint8_t *Buf, uint32_t max_len)
+{
+  uint32_t size = USB_CDC_IF_BUFFER_read(&rxBuffer, Buf, max_len);
+  USB_CDC_IF_RX_update_size(size);
 
-  return i;
+  return size;
+}
+
+/**
+  * @brief  USB_CDC_IF_RX_get_read_span
+  *         Get the contiguous received data at the RX read position, without copying it.
+  *         When the data wraps around the end of the ring, a second call after
+  *         USB_CDC_IF_RX_consume returns the remaining part.
+  * @param  size: set to the number of bytes readable at the returned pointer
+  * @retval Pointer to received data
+  */
+const uint8_t* USB_CDC_IF_RX_get_read_span(uint32_t *size)
+{
+  uint16_t read_index = rxBuffer.read_index;
+  uint16_t write_index = rxBuffer.write_index;
+
+  if(write_index >= read_index) {
+    *size = write_index - read_index;
+  } else {
+    *size = sizeof(rxBuffer.buffer) - read_index;
+  }
+
+  return &rxBuffer.buffer[read_index];
+}
+
+void USB_CDC_IF_RX_consume(uint32_t size)
+{
+  if(size == 0)
+    return;
+
+  __DSB();
+  rxBuffer.read_index = (rxBuffer.read_index + size) % sizeof(rxBuffer.buffer);
+  USB_CDC_IF_RX_update_size(size);
 }
 
 
@@ -4,22 +4,49 @@
 #include <algorithm>
 #include <fastapprox/fastexp.h>
 #include <fastapprox/fastlog.h>
+#include <iterator>
 #include <math.h>
 #include <string.h>
 
+namespace {
+using Parameters = CompressorFilter::Parameters;
+
+constexpr OscSchemaEntry SCHEMA[] = {
+    OSC_SCHEMA_ENTRY(Parameters, enable, false),
+    OSC_SCHEMA_ENTRY(Parameters, attackTime, 0.f, 0.f, OSC_NO_LIMIT, "s"),
+    OSC_SCHEMA_ENTRY(Parameters, releaseTime, 2.f, 0.f, OSC_NO_LIMIT, "s"),
+    OSC_SCHEMA_ENTRY(Parameters, threshold, -50.f, -OSC_NO_LIMIT, OSC_NO_LIMIT, "dB"),
+    OSC_SCHEMA_ENTRY(Parameters, makeUpGain, 0.f, -OSC_NO_LIMIT, OSC_NO_LIMIT, "dB"),
+    OSC_SCHEMA_ENTRY(Parameters, ratio, 1000.f, 1.f, OSC_NO_LIMIT),
+    OSC_SCHEMA_ENTRY(Parameters, kneeWidth, 0.f, 0.f, OSC_NO_LIMIT, "dB"),
+    OSC_SCHEMA_ENTRY(Parameters, useMovingMax, false),
+};
+static_assert(oscSchemaIsValid(SCHEMA));
+}  // namespace
+
 CompressorFilter::CompressorFilter(OscContainer* parent)
-    : OscContainer(parent, "compressorFilter", 9),
-      enable(this, "enable", false),
-      attackTime(this, "attackTime", 0),
-      releaseTime(this, "releaseTime", 2),
-      threshold(this, "threshold", -50),
-      makeUpGain(this, "makeUpGain", 0),
-      ratio(this, "ratio", 1000),
-      kneeWidth(this, "kneeWidth", 0),
-      useMovingMax(this, "useMovingMax", false) {
-	attackTime.addChangeCallback([this](float oscValue) { alphaA = oscValue != 0 ? expf(-1 / (oscValue * fs)) : 0; });
-	releaseTime.addChangeCallback([this](float oscValue) { alphaR = oscValue != 0 ? expf(-1 / (oscValue * fs)) : 0; });
-	ratio.addChangeCallback([this](float oscValue) { gainDiffRatio = 1 - 1 / oscValue; });
+    : OscSchemaNode(parent, "compressorFilter", SCHEMA, std::size(SCHEMA), &parameters) {
+	initValues();
+}
+
+void CompressorFilter::onValueChanged(size_t index) {
+	if(parameterChangedHook)
+		parameterChangedHook();
+}
+
+void CompressorFilter::setOnParameterChanged(std::function<void()> onParameterChanged) {
+	parameterChangedHook = std::move(onParameterChanged);
+}
+
+void CompressorFilter::compileParameters(FilterChainParameters::Dynamics& dynamics) const {
+	dynamics.enable = parameters.enable;
+	dynamics.useMovingMax = parameters.useMovingMax;
+	dynamics.threshold = parameters.threshold;
+	dynamics.kneeWidth = parameters.kneeWidth;
+	dynamics.makeUpGain = parameters.makeUpGain;
+	dynamics.alphaA = parameters.attackTime != 0 ? expf(-1 / (parameters.attackTime * fs)) : 0;
+	dynamics.alphaR = parameters.releaseTime != 0 ? expf(-1 / (parameters.releaseTime * fs)) : 0;
+	dynamics.gainDiffRatio = 1 - 1 / parameters.ratio;
 }
 
 void CompressorFilter::init(size_t numChannel) {
@@ -33,13 +60,15 @@ void CompressorFilter::reset(float fs) {
 	std::fill_n(perChannelData.begin(), numChannel, PerChannelData{});
 }
 
-void CompressorFilter::processSamples(float** samples, size_t count) {
-	if(enable) {
-		float staticGain = gainComputer(0) + makeUpGain;
+void CompressorFilter::processSamples(float** samples,
+                                      size_t count,
+                                      const FilterChainParameters::Dynamics& dynamics) {
+	if(dynamics.enable) {
+		float staticGain = gainComputer(0, dynamics) + dynamics.makeUpGain;
 		for(size_t i = 0; i < count; i++) {
 			float largerCompressionDb = 0;
 			for(size_t channel = 0; channel < numChannel; channel++) {
-				float dbGain = doCompression(samples[channel][i], perChannelData[channel]);
+				float dbGain = doCompression(samples[channel][i], perChannelData[channel], dynamics);
 				if(dbGain < largerCompressionDb)
 					largerCompressionDb = dbGain;
 			}
@@ -54,16 +83,21 @@ void CompressorFilter::processSamples(float** samples, size_t count) {
 	}
 }
 
-float CompressorFilter::doCompression(float sample, PerChannelData& perChannelData) {
+float CompressorFilter::doCompression(float sample,
+                                      PerChannelData& perChannelData,
+                                      const FilterChainParameters::Dynamics& dynamics) {
 	if(sample == 0)
 		return 0;
 
 	float dbSample = fastlog2(fabsf(sample)) / LOG10_VALUE_DIV_20;
-	levelDetector(gainComputer(dbSample), perChannelData);
+	levelDetector(gainComputer(dbSample, dynamics), perChannelData, dynamics);
 	return -perChannelData.yL;
 }
 
-float CompressorFilter::gainComputer(float dbSample) const {
+float CompressorFilter::gainComputer(float dbSample, const FilterChainParameters::Dynamics& dynamics) const {
+	float threshold = dynamics.threshold;
+	float kneeWidth = dynamics.kneeWidth;
+	float gainDiffRatio = dynamics.gainDiffRatio;
 	float zone = 2 * (dbSample - threshold);
 	if(zone == -INFINITY || zone <= -kneeWidth) {
 		return 0;
@@ -93,9 +127,13 @@ float CompressorFilter::PerChannelData::noProcessing(float dbCompression) {
 	return dbCompression;
 }
 
-void CompressorFilter::levelDetector(float dbCompression, PerChannelData& perChannelData) {
+void CompressorFilter::levelDetector(float dbCompression,
+                                     PerChannelData& perChannelData,
+                                     const FilterChainParameters::Dynamics& dynamics) {
+	float alphaA = dynamics.alphaA;
+	float alphaR = dynamics.alphaR;
 	float decayedCompression = alphaR * perChannelData.y1 + (1 - alphaR) * dbCompression;
-	if(useMovingMax)
+	if(dynamics.useMovingMax)
 		perChannelData.y1 = fmaxf(perChannelData.movingMax(dbCompression), decayedCompression);
 	else
 		perChannelData.y1 = fmaxf(dbCompression, decayedCompression);
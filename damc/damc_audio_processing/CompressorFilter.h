@@ -1,13 +1,14 @@
 #pragma once
 
-#include <Osc/OscContainer.h>
-#include <Osc/OscVariable.h>
+#include "FilterChainParameters.h"
+#include <Osc/OscSchemaNode.h>
 #include <array>
 #include <deque>
+#include <functional>
 #include <stddef.h>
 #include <vector>
 
-class CompressorFilter : public OscContainer {
+class CompressorFilter : public OscSchemaNode {
 protected:
 	struct PerChannelData {
 		float y1;
@@ -24,31 +25,39 @@ protected:
 	};
 
 public:
+	// OSC parameters, described by the schema of the node
+	struct Parameters {
+		bool enable;
+		float attackTime;
+		float releaseTime;
+		float threshold;
+		float makeUpGain;
+		float ratio;
+		float kneeWidth;
+		bool useMovingMax;
+	};
+
 	CompressorFilter(OscContainer* parent);
 	void init(size_t numChannel);
 	void reset(float fs);
-	void processSamples(float** samples, size_t count);
+
+	// Compiled parameters, as EqFilter: parameter changes call the hook and the owner compiles them
+	void setOnParameterChanged(std::function<void()> onParameterChanged);
+	void compileParameters(FilterChainParameters::Dynamics& dynamics) const;
+	void processSamples(float** samples, size_t count, const FilterChainParameters::Dynamics& dynamics);
 
 protected:
-	float doCompression(float sample, PerChannelData& perChannelData);
-	float gainComputer(float sample) const;
-	void levelDetector(float sample, PerChannelData& perChannelData);
+	float doCompression(float sample, PerChannelData& perChannelData, const FilterChainParameters::Dynamics& dynamics);
+	float gainComputer(float sample, const FilterChainParameters::Dynamics& dynamics) const;
+	void levelDetector(float sample, PerChannelData& perChannelData, const FilterChainParameters::Dynamics& dynamics);
+	void onValueChanged(size_t index) override;
 
 private:
 	size_t numChannel;
 	std::vector<PerChannelData> perChannelData;
 
-	OscVariable<bool> enable;
+	Parameters parameters;
 	float fs = 48000;
-	float alphaR;
-	float alphaA;
-	OscVariable<float> attackTime;
-	OscVariable<float> releaseTime;
-	OscVariable<float> threshold;
-	OscVariable<float> makeUpGain;
-	OscVariable<float> ratio;
-	float gainDiffRatio = 0;
-	OscVariable<float> kneeWidth;
 	uint32_t gainHoldSamples = 48000 / 20;  // 20Hz period
-	OscVariable<bool> useMovingMax;
+	std::function<void()> parameterChangedHook;
 };
@@ -0,0 +1,94 @@
+#include "CrossfeedFilter.h"
+
+#include <MathUtils.h>
+#include <fastapprox/fastexp.h>
+#include <math.h>
+
+CrossfeedFilter::CrossfeedFilter(OscContainer* parent)
+    : OscContainer(parent, "crossfeed", 6),
+      enable(this, "enable", false),
+      preset(this, "preset", (int32_t) Preset::Default),
+      cutoff(this, "cutoff", 700),
+      feedLevel(this, "feedLevel", 4.5),
+      delay(this, "delay", 14) {
+	preset.addCheckCallback(
+	    [](int32_t value) -> bool { return value >= (int32_t) Preset::Custom && value <= (int32_t) Preset::JanMeier; });
+	delay.addCheckCallback([](int32_t value) -> bool { return value >= 0 && value <= 64; });
+
+	preset.addChangeCallback([this](int32_t value) {
+		switch((Preset) value) {
+			case Preset::Custom:
+				break;
+			case Preset::Default:
+				applyPreset(700, 4.5);
+				break;
+			case Preset::ChuMoy:
+				applyPreset(700, 6);
+				break;
+			case Preset::JanMeier:
+				applyPreset(650, 9.5);
+				break;
+		}
+	});
+
+	auto onChangeCallback = [this](auto) { computeFilter(); };
+	cutoff.addChangeCallback(onChangeCallback);
+	feedLevel.addChangeCallback(onChangeCallback);
+
+	// Delay lines are resized
+	delay.setMainLoopOnly();
+	delay.addChangeCallback([this](int32_t newValue) {
+		for(DelayFilter& filter : delayFilters) {
+			filter.setParameters(newValue);
+		}
+	});
+}
+
+void CrossfeedFilter::reset(float fs) {
+	this->fs = fs;
+	for(DelayFilter& filter : delayFilters) {
+		filter.reset();
+	}
+	computeFilter();
+}
+
+void CrossfeedFilter::applyPreset(float cutoff, float feedLevel) {
+	// Only touch values that differ to keep default values as default
+	if(this->cutoff.get() != cutoff)
+		this->cutoff.set(cutoff);
+	if(this->feedLevel.get() != feedLevel)
+		this->feedLevel.set(feedLevel);
+}
+
+void CrossfeedFilter::computeFilter() {
+	// feedLevel is the attenuation of the crossfeed path in dB
+	float feed = fastpow2(-feedLevel * LOG10_VALUE_DIV_20);
+
+	directGain = 1 / (1 + feed);
+	feedGain = feed / (1 + feed);
+
+	for(BiquadFilter& filter : lowPassFilters) {
+		filter.computeFilter(true, FilterType::LowPass, cutoff, fs, 0, 0.5);
+	}
+}
+
+void CrossfeedFilter::processSamples(float** samples, size_t count) {
+	if(!enable)
+		return;
+
+	float* left = samples[0];
+	float* right = samples[1];
+	const float directGain = this->directGain;
+	const float feedGain = this->feedGain;
+
+	for(size_t i = 0; i < count; i++) {
+		float l = left[i];
+		float r = right[i];
+
+		float leftToRight = delayFilters[0].processOneSample(lowPassFilters[0].put(l));
+		float rightToLeft = delayFilters[1].processOneSample(lowPassFilters[1].put(r));
+
+		left[i] = directGain * l + feedGain * rightToLeft;
+		right[i] = directGain * r + feedGain * leftToRight;
+	}
+}
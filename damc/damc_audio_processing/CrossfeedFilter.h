@@ -0,0 +1,48 @@
+#pragma once
+
+#include "BiquadFilter.h"
+#include "DelayFilter.h"
+#include <Osc/OscContainer.h>
+#include <Osc/OscVariable.h>
+#include <stddef.h>
+
+/**
+ * @brief Headphone crossfeed (Bauer / BS2B style).
+ * Each output channel receives its own channel plus a low-passed and delayed copy of the opposite channel.
+ * This mimics the acoustic crosstalk of speakers to reduce fatigue with hard-panned content on headphones.
+ *
+ * The direct and crossfeed gains are normalized so the low frequency level of a mono signal is unchanged.
+ * Both channels are processed in a single pass (stereo only).
+ */
+class CrossfeedFilter : public OscContainer {
+public:
+	enum class Preset {
+		Custom,
+		Default,  // 700 Hz, 4.5 dB
+		ChuMoy,   // 700 Hz, 6 dB
+		JanMeier  // 650 Hz, 9.5 dB
+	};
+
+	CrossfeedFilter(OscContainer* parent);
+
+	void reset(float fs);
+	void processSamples(float** samples, size_t count);
+
+protected:
+	void applyPreset(float cutoff, float feedLevel);
+	void computeFilter();
+
+private:
+	OscVariable<bool> enable;
+	OscVariable<int32_t> preset;
+	OscVariable<float> cutoff;
+	OscVariable<float> feedLevel;
+	OscVariable<int32_t> delay;
+	float fs = 48000;
+
+	float directGain = 1;
+	float feedGain = 0;
+
+	BiquadFilter lowPassFilters[2];
+	DelayFilter delayFilters[2];
+};
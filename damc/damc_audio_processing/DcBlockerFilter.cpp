@@ -0,0 +1,18 @@
+#include "DcBlockerFilter.h"
+
+#include <math.h>
+
+void DcBlockerFilter::reset() {
+	previousInput = 0;
+	previousOutput = 0;
+}
+
+float DcBlockerFilter::computeCoefficient(float fc, float fs) {
+	return expf(-2 * (float) M_PI * fc / fs);
+}
+
+void DcBlockerFilter::processSamples(float* samples, size_t count) {
+	for(size_t i = 0; i < count; i++) {
+		samples[i] = processOneSample(samples[i]);
+	}
+}
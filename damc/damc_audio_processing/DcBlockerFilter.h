@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * @brief One-pole DC blocker: y[n] = x[n] - x[n-1] + R * y[n-1].
+ * R is derived from the -3 dB cutoff frequency, so it can also be used as a gentle 6 dB/oct high-pass.
+ */
+class DcBlockerFilter {
+public:
+	void reset();
+	void setParameters(float fc, float fs) { R = computeCoefficient(fc, fs); }
+	static float computeCoefficient(float fc, float fs);
+	void setCoefficient(float R) { this->R = R; }
+
+	void processSamples(float* samples, size_t count);
+	float processOneSample(float input) {
+		float output = input - previousInput + R * previousOutput;
+		previousInput = input;
+		previousOutput = output;
+		return output;
+	}
+
+private:
+	float R = 0.9987f;
+	float previousInput = 0;
+	float previousOutput = 0;
+};
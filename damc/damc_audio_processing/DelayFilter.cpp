@@ -4,6 +4,7 @@
 #include <string.h>
 
 DelayFilter::DelayFilter() {
+	this->delay = 0;
 	this->inputIndex = 0;
 	this->outputIndex = 0;
 	setParameters(0);
@@ -31,15 +32,30 @@ float DelayFilter::processOneSample(float input) {
 }
 
 void DelayFilter::setParameters(unsigned int delay) {
+	reserve(delay);
+	setDelay(delay);
+}
+
+void DelayFilter::reserve(unsigned int delay) {
 	int powerOfTwo;
 	int targetDelay = delay;
 
-	this->delay = delay;
-
 	powerOfTwo = 0;
 	while((1 << powerOfTwo) < (targetDelay + 1))
 		powerOfTwo++;
+	if(!this->delayedSamples.empty() && powerOfTwo <= (int) this->power2Size)
+		return;
+
 	this->power2Size = powerOfTwo;
 	this->delayedSamples.resize(1 << power2Size, 0);
-	outputIndex = (inputIndex + this->delayedSamples.size() - targetDelay) & ((1 << power2Size) - 1);
+	setDelay(this->delay);
+}
+
+void DelayFilter::setDelay(unsigned int delay) {
+	// A delay not reserved is limited to the delay line size
+	if(delay >= this->delayedSamples.size())
+		delay = this->delayedSamples.size() - 1;
+
+	this->delay = delay;
+	outputIndex = (inputIndex + this->delayedSamples.size() - delay) & ((1 << power2Size) - 1);
 }
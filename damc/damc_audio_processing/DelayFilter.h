@@ -14,6 +14,11 @@ public:
 	void setParameters(unsigned int delay);
 	void getParameters(unsigned int& delay) { delay = this->delay; }
 
+	// setParameters in 2 steps: reserve allocates the delay line for delay (it never shrinks), setDelay only moves
+	// the read index so the audio processing can call it for any reserved delay
+	void reserve(unsigned int delay);
+	void setDelay(unsigned int delay);
+
 private:
 	std::vector<float> delayedSamples;
 	unsigned int delay;
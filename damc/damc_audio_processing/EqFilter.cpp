@@ -1,56 +1,234 @@
 #include "EqFilter.h"
 
+#include <MathUtils.h>
 #include <algorithm>
 #include <cmath>
+#include <fastapprox/fastlog.h>
 #include <string.h>
 
+namespace {
+// Labels of FilterType values
+constexpr OscMetadata FILTER_TYPE_METADATA =
+    oscEnum("none,lowPass,highPass,bandPassConstantSkirt,bandPassConstantPeak,notch,allPass,peak,lowShelf,highShelf");
+static_assert(FILTER_TYPE_METADATA.maxValue == (float) FilterType::HighShelf);
+
+// Below half the sample rate (48 kHz): at w0 = pi the low-pass and peak biquads have poles on the unit circle
+constexpr OscMetadata FREQUENCY_METADATA = oscRange(10, 20000, "Hz");
+constexpr OscMetadata LEVEL_METADATA = oscUnit("dB");
+constexpr OscMetadata Q_METADATA = oscRange(0.01f, OSC_NO_LIMIT);
+constexpr OscMetadata RATIO_METADATA = oscRange(1, OSC_NO_LIMIT);
+constexpr OscMetadata TIME_METADATA = oscRange(0, OSC_NO_LIMIT, "s");
+}  // namespace
+
 EqFilter::EqFilter(OscContainer* parent, const std::string_view& name)
-    : OscContainer(parent, name),
+    : OscContainer(parent, name, 11),
       enabled(this, "enable", false),
       filterType(this, "type", (int32_t) FilterType::None),
       f0(this, "f0", 1000),
       gain(this, "gain", 0),
-      Q(this, "Q", 0.5) {
-	auto onChangeCallback = [this](auto) { computeFilter(); };
+      Q(this, "Q", 0.5),
+      dynamic(this, "dynamic", false),
+      threshold(this, "threshold", -30),
+      ratio(this, "ratio", 4),
+      attackTime(this, "attackTime", 0.001),
+      releaseTime(this, "releaseTime", 0.05) {
+	filterType.setMetadata(&FILTER_TYPE_METADATA);
+	f0.setMetadata(&FREQUENCY_METADATA);
+	gain.setMetadata(&LEVEL_METADATA);
+	Q.setMetadata(&Q_METADATA);
+	threshold.setMetadata(&LEVEL_METADATA);
+	ratio.setMetadata(&RATIO_METADATA);
+	attackTime.setMetadata(&TIME_METADATA);
+	releaseTime.setMetadata(&TIME_METADATA);
+
+	auto onChangeCallback = [this](auto) { onParameterChanged(); };
 	enabled.addChangeCallback(onChangeCallback);
 	filterType.addChangeCallback(onChangeCallback);
 	f0.addChangeCallback(onChangeCallback);
 	gain.addChangeCallback(onChangeCallback);
 	Q.addChangeCallback(onChangeCallback);
+	dynamic.addChangeCallback(onChangeCallback);
+
+	// Detector parameters are read by the audio processing, only compiled parameters need to know they changed
+	auto onDetectorChangeCallback = [this](float) {
+		updateDetector();
+		if(parameterChangedHook)
+			parameterChangedHook();
+	};
+	threshold.addChangeCallback(onDetectorChangeCallback);
+	ratio.addChangeCallback(onDetectorChangeCallback);
+	attackTime.addChangeCallback(onDetectorChangeCallback);
+	releaseTime.addChangeCallback(onDetectorChangeCallback);
 }
 
 void EqFilter::init(size_t numChannel) {
 	biquadFilters.resize(numChannel);
+	detectorFilters.resize(numChannel);
+	detectorLevels.resize(numChannel, 0);
+	computeFilter();
+	if(parameterChangedHook)
+		parameterChangedHook();
 }
 
 void EqFilter::reset(float fs) {
 	this->fs = fs;
+	std::fill(detectorLevels.begin(), detectorLevels.end(), 0);
+	updateDetector();
 	computeFilter();
+	if(parameterChangedHook)
+		parameterChangedHook();
+}
+
+void EqFilter::setOnParameterChanged(std::function<void()> onParameterChanged) {
+	parameterChangedHook = std::move(onParameterChanged);
+}
+
+void EqFilter::onParameterChanged() {
+	if(parameterChangedHook)
+		parameterChangedHook();
+	else
+		computeFilter();
+}
+
+void EqFilter::compileParameters(FilterChainParameters::EqBand& band) {
+	band.enabled = enabled;
+	band.dynamic = enabled && dynamic;
+	band.filterType = filterType;
+	band.f0 = f0;
+	band.gain = gain;
+	band.Q = Q;
+
+	BiquadFilter::computeFilter(
+	    band.enabled, (FilterType) band.filterType, band.f0, fs, band.gain, band.Q, band.a_coefs, band.b_coefs);
+	BiquadFilter::computeFilter(band.dynamic,
+	                            FilterType::BandPassConstantPeak,
+	                            band.f0,
+	                            fs,
+	                            0,
+	                            band.Q,
+	                            band.detector_a_coefs,
+	                            band.detector_b_coefs);
+
+	band.threshold = threshold;
+	band.alphaA = attackTime != 0 ? expf(-1 / (attackTime * fs)) : 0;
+	band.alphaR = releaseTime != 0 ? expf(-1 / (releaseTime * fs)) : 0;
+	band.gainDiffRatio = 1 - 1 / ratio;
+}
+
+void EqFilter::updateDetector() {
+	alphaA = attackTime != 0 ? expf(-1 / (attackTime * fs)) : 0;
+	alphaR = releaseTime != 0 ? expf(-1 / (releaseTime * fs)) : 0;
+	gainDiffRatio = 1 - 1 / ratio;
 }
 
 void EqFilter::processSamples(float** samples, size_t count) {
 	if(enabled) {
-		for(size_t channel = 0; channel < biquadFilters.size(); channel++) {
-			BiquadFilter& biquadFilter = biquadFilters[channel];
-			float* outputChannel = samples[channel];
-			const float* inputChannel = samples[channel];
-
-			for(size_t i = 0; i < count; i++) {
-				outputChannel[i] = biquadFilter.put(inputChannel[i]);
-			}
+		if(dynamic)
+			updateDynamicGain(samples, count, nullptr);
+
+		applyBiquads(samples, count);
+	}
+}
+
+void EqFilter::processSamples(float** samples,
+                              size_t count,
+                              const FilterChainParameters::EqBand& band,
+                              bool changed) {
+	if(changed) {
+		currentGain = band.gain;
+		for(BiquadFilter& biquadFilter : biquadFilters)
+			biquadFilter.update(band.a_coefs, band.b_coefs);
+		for(BiquadFilter& detectorFilter : detectorFilters)
+			detectorFilter.update(band.detector_a_coefs, band.detector_b_coefs);
+	}
+
+	if(band.enabled) {
+		if(band.dynamic)
+			updateDynamicGain(samples, count, &band);
+
+		applyBiquads(samples, count);
+	}
+}
+
+void EqFilter::applyBiquads(float** samples, size_t count) {
+	for(size_t channel = 0; channel < biquadFilters.size(); channel++) {
+		BiquadFilter& biquadFilter = biquadFilters[channel];
+		float* outputChannel = samples[channel];
+		const float* inputChannel = samples[channel];
+
+		for(size_t i = 0; i < count; i++) {
+			outputChannel[i] = biquadFilter.put(inputChannel[i]);
 		}
 	}
 }
 
+void EqFilter::updateDynamicGain(float** samples, size_t count, const FilterChainParameters::EqBand* band) {
+	const float alphaA = band ? band->alphaA : this->alphaA;
+	const float alphaR = band ? band->alphaR : this->alphaR;
+	const float threshold = band ? band->threshold : this->threshold.get();
+	const float gainDiffRatio = band ? band->gainDiffRatio : this->gainDiffRatio;
+	float level = 0;
+
+	for(size_t channel = 0; channel < detectorFilters.size(); channel++) {
+		BiquadFilter& detectorFilter = detectorFilters[channel];
+		const float* inputChannel = samples[channel];
+		float detectorLevel = detectorLevels[channel];
+
+		for(size_t i = 0; i < count; i++) {
+			float detectedSample = fabsf(detectorFilter.put(inputChannel[i]));
+			float alpha = detectedSample > detectorLevel ? alphaA : alphaR;
+			detectorLevel = alpha * detectorLevel + (1 - alpha) * detectedSample;
+		}
+
+		detectorLevels[channel] = detectorLevel;
+		level = fmaxf(level, detectorLevel);
+	}
+
+	// Control rate part: compute the gain reduction from the linked detector level
+	float targetGain = band ? band->gain : gain.get();
+	if(level > 0) {
+		float levelDb = fastlog2(level) / LOG10_VALUE_DIV_20;
+		if(levelDb > threshold)
+			targetGain -= gainDiffRatio * (levelDb - threshold);
+	}
+
+	// Avoid recomputing coefficients for inaudible gain changes
+	if(fabsf(targetGain - currentGain) >= 0.1f) {
+		if(band)
+			computeCoefficients(band->enabled, (FilterType) band->filterType, band->f0, band->Q, targetGain);
+		else
+			computeCoefficients(targetGain);
+	}
+}
+
 std::complex<float> EqFilter::getResponse(float f0) {
 	return biquadFilters.front().getResponse(f0, fs);
 }
 
 void EqFilter::computeFilter() {
+	computeCoefficients(gain);
+
 	float a_coefs[3];
 	float b_coefs[3];
 
-	BiquadFilter::computeFilter(enabled, (FilterType) filterType.get(), f0, fs, gain, Q, a_coefs, b_coefs);
+	BiquadFilter::computeFilter(
+	    enabled && dynamic, FilterType::BandPassConstantPeak, f0, fs, 0, Q, a_coefs, b_coefs);
+
+	for(BiquadFilter& detectorFilter : detectorFilters)
+		detectorFilter.update(a_coefs, b_coefs);
+}
+
+void EqFilter::computeCoefficients(float gain) {
+	computeCoefficients(enabled, (FilterType) filterType.get(), f0, Q, gain);
+}
+
+void EqFilter::computeCoefficients(bool enabled, FilterType filterType, float f0, float Q, float gain) {
+	float a_coefs[3];
+	float b_coefs[3];
+
+	currentGain = gain;
+
+	BiquadFilter::computeFilter(enabled, filterType, f0, fs, gain, Q, a_coefs, b_coefs);
 
 	for(BiquadFilter& biquadFilter : biquadFilters)
 		biquadFilter.update(a_coefs, b_coefs);
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "BiquadFilter.h"
+#include "FilterChainParameters.h"
 #include <Osc/OscContainer.h>
 #include <Osc/OscVariable.h>
 #include <complex>
+#include <functional>
 #include <stddef.h>
 
 class EqFilter : public OscContainer {
@@ -14,8 +16,26 @@ public:
 	void reset(float fs);
 	void processSamples(float** samples, size_t count);
 
+	// Compiled parameters: parameter changes call the hook instead of updating the biquads.
+	// The owner then compiles the band and passes it to processSamples, with changed set on the first block using it.
+	void setOnParameterChanged(std::function<void()> onParameterChanged);
+	void compileParameters(FilterChainParameters::EqBand& band);
+	void processSamples(float** samples, size_t count, const FilterChainParameters::EqBand& band, bool changed);
+
 	std::complex<float> getResponse(float f0);
 
+	// Used by stages that fuse a static EQ band in their own loop
+	BiquadFilter& getBiquadFilter(size_t channel) { return biquadFilters[channel]; }
+
+protected:
+	// Dynamic EQ: a band-pass detector centered on f0 drives the band gain.
+	// The detector runs per sample, the biquad coefficients are updated once per block.
+	// band is null when not using compiled parameters
+	void updateDynamicGain(float** samples, size_t count, const FilterChainParameters::EqBand* band);
+	void onParameterChanged();
+	void updateDetector();
+	void applyBiquads(float** samples, size_t count);
+
 private:
 	OscVariable<bool> enabled;
 	OscVariable<int32_t> filterType;
@@ -24,7 +44,22 @@ private:
 	OscVariable<float> gain;
 	OscVariable<float> Q;
 
+	OscVariable<bool> dynamic;
+	OscVariable<float> threshold;
+	OscVariable<float> ratio;
+	OscVariable<float> attackTime;
+	OscVariable<float> releaseTime;
+	float alphaA = 0;
+	float alphaR = 0;
+	float gainDiffRatio = 0;
+	float currentGain = 0;
+
 	std::vector<BiquadFilter> biquadFilters;
+	std::vector<BiquadFilter> detectorFilters;
+	std::vector<float> detectorLevels;
+	std::function<void()> parameterChangedHook;
 
 	void computeFilter();
+	void computeCoefficients(float gain);
+	void computeCoefficients(bool enabled, FilterType filterType, float f0, float Q, float gain);
 };
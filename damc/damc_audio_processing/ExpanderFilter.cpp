@@ -4,21 +4,48 @@
 #include <algorithm>
 #include <fastapprox/fastexp.h>
 #include <fastapprox/fastlog.h>
+#include <iterator>
 #include <math.h>
 #include <string.h>
 
+namespace {
+using Parameters = ExpanderFilter::Parameters;
+
+constexpr OscSchemaEntry SCHEMA[] = {
+    OSC_SCHEMA_ENTRY(Parameters, enable, false),
+    OSC_SCHEMA_ENTRY(Parameters, attackTime, 0.f, 0.f, OSC_NO_LIMIT, "s"),
+    OSC_SCHEMA_ENTRY(Parameters, releaseTime, 8000.f, 0.f, OSC_NO_LIMIT, "s"),
+    OSC_SCHEMA_ENTRY(Parameters, threshold, -50.f, -OSC_NO_LIMIT, OSC_NO_LIMIT, "dB"),
+    OSC_SCHEMA_ENTRY(Parameters, makeUpGain, 0.f, -OSC_NO_LIMIT, OSC_NO_LIMIT, "dB"),
+    OSC_SCHEMA_ENTRY(Parameters, ratio, 4.f, 1.f, OSC_NO_LIMIT),
+    OSC_SCHEMA_ENTRY(Parameters, kneeWidth, 0.f, 0.f, OSC_NO_LIMIT, "dB"),
+};
+static_assert(oscSchemaIsValid(SCHEMA));
+}  // namespace
+
 ExpanderFilter::ExpanderFilter(OscContainer* parent)
-    : OscContainer(parent, "expanderFilter", 8),
-      enable(this, "enable", false),
-      attackTime(this, "attackTime", 0),
-      releaseTime(this, "releaseTime", 8000),
-      threshold(this, "threshold", -50),
-      makeUpGain(this, "makeUpGain", 0),
-      ratio(this, "ratio", 4),
-      kneeWidth(this, "kneeWidth", 0) {
-	attackTime.addChangeCallback([this](float oscValue) { alphaA = oscValue != 0 ? expf(-1 / (oscValue * fs)) : 0; });
-	releaseTime.addChangeCallback([this](float oscValue) { alphaR = oscValue != 0 ? expf(-1 / (oscValue * fs)) : 0; });
-	ratio.addChangeCallback([this](float oscValue) { gainDiffRatio = oscValue - 1; });
+    : OscSchemaNode(parent, "expanderFilter", SCHEMA, std::size(SCHEMA), &parameters) {
+	initValues();
+}
+
+void ExpanderFilter::onValueChanged(size_t index) {
+	if(parameterChangedHook)
+		parameterChangedHook();
+}
+
+void ExpanderFilter::setOnParameterChanged(std::function<void()> onParameterChanged) {
+	parameterChangedHook = std::move(onParameterChanged);
+}
+
+void ExpanderFilter::compileParameters(FilterChainParameters::Dynamics& dynamics) const {
+	dynamics.enable = parameters.enable;
+	dynamics.useMovingMax = false;
+	dynamics.threshold = parameters.threshold;
+	dynamics.kneeWidth = parameters.kneeWidth;
+	dynamics.makeUpGain = parameters.makeUpGain;
+	dynamics.alphaA = parameters.attackTime != 0 ? expf(-1 / (parameters.attackTime * fs)) : 0;
+	dynamics.alphaR = parameters.releaseTime != 0 ? expf(-1 / (parameters.releaseTime * fs)) : 0;
+	dynamics.gainDiffRatio = parameters.ratio - 1;
 }
 
 void ExpanderFilter::init(size_t numChannel) {
@@ -33,9 +60,9 @@ void ExpanderFilter::reset(float fs) {
 	std::fill_n(previousLevelDetectorOutput.begin(), numChannel, 0);
 }
 
-void ExpanderFilter::processSamples(float** samples, size_t count) {
-	if(enable) {
-		float makeUpGain = this->makeUpGain;
+void ExpanderFilter::processSamples(float** samples, size_t count, const FilterChainParameters::Dynamics& dynamics) {
+	if(dynamics.enable) {
+		float makeUpGain = dynamics.makeUpGain;
 
 		for(size_t i = 0; i < count; i++) {
 			float lowestCompressionDb = -INFINITY;
@@ -43,7 +70,8 @@ void ExpanderFilter::processSamples(float** samples, size_t count) {
 			for(size_t channel = 0; channel < numChannel; channel++) {
 				float dbGain = doCompression(samples[channel][i],
 				                             previousPartialGainComputerOutput[channel],
-				                             previousLevelDetectorOutput[channel]);
+				                             previousLevelDetectorOutput[channel],
+				                             dynamics);
 				if(dbGain > lowestCompressionDb)
 					lowestCompressionDb = dbGain;
 			}
@@ -65,16 +93,22 @@ void ExpanderFilter::processSamples(float** samples, size_t count) {
 	}
 }
 
-float ExpanderFilter::doCompression(float sample, float& y1, float& yL) {
+float ExpanderFilter::doCompression(float sample,
+                                    float& y1,
+                                    float& yL,
+                                    const FilterChainParameters::Dynamics& dynamics) {
 	if(sample == 0)
 		return -INFINITY;
 
 	float dbSample = fastlog2(fabsf(sample)) / LOG10_VALUE_DIV_20;
-	levelDetector(gainComputer(dbSample), y1, yL);
+	levelDetector(gainComputer(dbSample, dynamics), y1, yL, dynamics);
 	return -yL;
 }
 
-float ExpanderFilter::gainComputer(float dbSample) {
+float ExpanderFilter::gainComputer(float dbSample, const FilterChainParameters::Dynamics& dynamics) {
+	float threshold = dynamics.threshold;
+	float kneeWidth = dynamics.kneeWidth;
+	float gainDiffRatio = dynamics.gainDiffRatio;
 	float zone = 2 * (dbSample - threshold);
 	if(zone == -INFINITY || zone <= -kneeWidth) {
 		return gainDiffRatio * (threshold - dbSample);
@@ -86,7 +120,12 @@ float ExpanderFilter::gainComputer(float dbSample) {
 	}
 }
 
-void ExpanderFilter::levelDetector(float dbSample, float& y1, float& yL) {
+void ExpanderFilter::levelDetector(float dbSample,
+                                   float& y1,
+                                   float& yL,
+                                   const FilterChainParameters::Dynamics& dynamics) {
+	float alphaA = dynamics.alphaA;
+	float alphaR = dynamics.alphaR;
 	y1 = fminf(dbSample, alphaR * y1 + (1 - alphaR) * dbSample);
 	yL = alphaA * yL + (1 - alphaA) * y1;
 }
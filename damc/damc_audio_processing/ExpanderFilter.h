@@ -1,36 +1,45 @@
 #pragma once
 
-#include <Osc/OscContainer.h>
-#include <Osc/OscVariable.h>
+#include "FilterChainParameters.h"
+#include <Osc/OscSchemaNode.h>
+#include <functional>
 #include <stddef.h>
 #include <vector>
 
-class ExpanderFilter : public OscContainer {
+class ExpanderFilter : public OscSchemaNode {
 public:
+	// OSC parameters, described by the schema of the node
+	struct Parameters {
+		bool enable;
+		float attackTime;
+		float releaseTime;
+		float threshold;
+		float makeUpGain;
+		float ratio;
+		float kneeWidth;
+	};
+
 	ExpanderFilter(OscContainer* parent);
 	void init(size_t numChannel);
 	void reset(float fs);
-	void processSamples(float** samples, size_t count);
+
+	// Compiled parameters, as EqFilter: parameter changes call the hook and the owner compiles them
+	void setOnParameterChanged(std::function<void()> onParameterChanged);
+	void compileParameters(FilterChainParameters::Dynamics& dynamics) const;
+	void processSamples(float** samples, size_t count, const FilterChainParameters::Dynamics& dynamics);
 
 protected:
-	float doCompression(float sample, float& y1, float& yL);
-	float gainComputer(float sample);
-	void levelDetector(float sample, float& y1, float& yL);
+	float doCompression(float sample, float& y1, float& yL, const FilterChainParameters::Dynamics& dynamics);
+	float gainComputer(float sample, const FilterChainParameters::Dynamics& dynamics);
+	void levelDetector(float sample, float& y1, float& yL, const FilterChainParameters::Dynamics& dynamics);
+	void onValueChanged(size_t index) override;
 
 private:
 	size_t numChannel;
 	std::vector<float> previousPartialGainComputerOutput;
 	std::vector<float> previousLevelDetectorOutput;
 
-	OscVariable<bool> enable;
+	Parameters parameters;
 	float fs = 48000;
-	float alphaR;
-	float alphaA;
-	OscVariable<float> attackTime;
-	OscVariable<float> releaseTime;
-	OscVariable<float> threshold;
-	OscVariable<float> makeUpGain;
-	OscVariable<float> ratio;
-	float gainDiffRatio = 0;
-	OscVariable<float> kneeWidth;
+	std::function<void()> parameterChangedHook;
 };
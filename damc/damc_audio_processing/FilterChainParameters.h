@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Parameters read by FilterChain on each audio block, compiled from the OSC variables outside of the audio
+ * processing.
+ * FilterChain keeps 2 copies: the audio processing reads the active one while the next one is compiled in the shadow
+ * one. Both are swapped at the start of an audio block, so all parameters of a strip change at once.
+ * Timetagged changes are compiled directly in the active copy between two segments of a block, so they apply at their
+ * sample.
+ */
+struct FilterChainParameters {
+	static constexpr size_t MAX_CHANNELS = 2;
+	static constexpr size_t EQ_BANDS = 6;
+
+	struct EqBand {
+		bool enabled;
+		// Dynamic bands update their coefficients from their detector level in the audio processing
+		bool dynamic;
+		int32_t filterType;
+		float f0;
+		float gain;
+		float Q;
+		float a_coefs[3];
+		float b_coefs[3];
+		float detector_a_coefs[3];
+		float detector_b_coefs[3];
+		// Dynamic band detector
+		float threshold;
+		float alphaA;
+		float alphaR;
+		float gainDiffRatio;
+	};
+
+	// Compressor and expander, with attack and release times as smoothing coefficients
+	struct Dynamics {
+		bool enable;
+		// Compressor only
+		bool useMovingMax;
+		float threshold;
+		float kneeWidth;
+		float makeUpGain;
+		float alphaA;
+		float alphaR;
+		// 1 - 1 / ratio for the compressor, ratio - 1 for the expander
+		float gainDiffRatio;
+	};
+
+	struct Saturation {
+		bool enable;
+		bool oversampling;
+		float driveRatio;
+		// Output level / tanh(driveRatio)
+		float outputRatio;
+	};
+
+	struct MidSide {
+		bool enable;
+		// The 1/2 of the M/S encoding is folded into the scales
+		float midScale;
+		float sideScale;
+		EqBand sideEq;
+	};
+
+	// The main loop resizes the delay lines before a longer delay is compiled
+	uint32_t delay;
+	bool dcBlocker;
+	float dcBlockerCoefficient;
+	EqBand eqBands[EQ_BANDS];
+	Dynamics expander;
+	Dynamics compressor;
+	Saturation saturation;
+	MidSide midSide;
+	// Balance * volume, negated when the signal is reversed
+	float volumes[MAX_CHANNELS];
+	bool mute;
+
+	// Change sequence of FilterChain when these parameters were compiled
+	uint32_t sequence;
+};
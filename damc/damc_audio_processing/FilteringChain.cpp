@@ -6,41 +6,72 @@
 #include <string.h>
 #include <Utils.h>
 
-float LogScaleFromOsc(float value) {
-	return fastpow2(value * LOG10_VALUE_DIV_20);
-}
-
-float LogScaleToOsc(float value) {
-	float logValue = fastlog2(value) / LOG10_VALUE_DIV_20;
-	logValue = roundf(logValue*100.f)/100.f;
-	return logValue;
-}
+namespace {
+constexpr OscMetadata DELAY_METADATA = oscRange(0, OSC_NO_LIMIT, "samples");
+// Clamped values must pass the check callback: above 0 and below half the sample rate (48 kHz)
+constexpr OscMetadata DC_BLOCKER_FREQUENCY_METADATA = oscRange(1, 20000, "Hz");
+constexpr OscMetadata VOLUME_METADATA = oscUnit("dB");
+}  // namespace
 
 FilterChain::FilterChain(OscContainer* parent,
                          OscReadOnlyVariable<int32_t>* oscNumChannel,
                          OscReadOnlyVariable<int32_t>* oscSampleRate)
-    : OscContainer(parent, "filterChain", 10),
+    : OscContainer(parent, "filterChain", 14),
       // reverbFilters(this, "reverbFilter"),
       eqFilters(this, "eqFilters"),
       compressorFilter(this),
       expanderFilter(this),
+      saturationFilter(this),
+      midSideFilter(this),
       peakMeter(parent, oscNumChannel, oscSampleRate),
       delay(this, "delay", 0),
+      dcBlocker(this, "dcBlocker", false),
+      dcBlockerFrequency(this, "dcBlockerFrequency", 10),
       volume(this, "balance", 1.0f),
       masterVolume(this, "volume", 1.0f),
       mute(this, "mute", false),
-      reverseAudioSignal(this, "reverseAudioSignal", false) {
+      reverseAudioSignal(this, "reverseAudioSignal", false),
+      parameterBlocks{},
+      activeParameters(&parameterBlocks[0]),
+      shadowParameters(&parameterBlocks[1]),
+      changeSequence(1),
+      compiledSequence(0),
+      parametersChanged(false) {
 	//	reverbFilters.setFactory(
 	//	    [](OscContainer* parent, int name) { return new ReverbFilter(parent, Utils::toString(name)); });
-	eqFilters.setFactory([](OscContainer* parent, int name) { return new EqFilter(parent, Utils::toString(name)); });
+	eqFilters.setFactory([this](OscContainer* parent, int name) {
+		EqFilter* filter = new EqFilter(parent, Utils::toString(name));
+		filter->setOnParameterChanged([this]() { markParametersChanged(); });
+		return filter;
+	});
+	compressorFilter.setOnParameterChanged([this]() { markParametersChanged(); });
+	expanderFilter.setOnParameterChanged([this]() { markParametersChanged(); });
+	saturationFilter.setOnParameterChanged([this]() { markParametersChanged(); });
+	midSideFilter.setOnParameterChanged([this]() { markParametersChanged(); });
+
+	delay.setMetadata(&DELAY_METADATA);
+	dcBlockerFrequency.setMetadata(&DC_BLOCKER_FREQUENCY_METADATA);
+	masterVolume.setMetadata(&VOLUME_METADATA);
 
+	// Delay lines are resized here, the new delay is applied with the other parameters
+	delay.setMainLoopOnly();
 	delay.addChangeCallback([this](int32_t newValue) {
 		for(DelayFilter& filter : delayFilters) {
-			filter.setParameters(newValue);
+			filter.reserve(newValue);
 		}
+		markParametersChanged();
 	});
-	volume.setOscConverters(&LogScaleToOsc, &LogScaleFromOsc);
-	masterVolume.setOscConverters(&LogScaleToOsc, &LogScaleFromOsc);
+	dcBlocker.addChangeCallback([this](bool) { markParametersChanged(); });
+	dcBlockerFrequency.addCheckCallback([this](float value) -> bool { return value > 0 && value < fs / 2; });
+	dcBlockerFrequency.addChangeCallback([this](float) { markParametersChanged(); });
+
+	volume.setOscConverters(&LogScaleOscConverter);
+	masterVolume.setOscConverters(&LogScaleOscConverter);
+
+	volume.addChangeCallback([this](float) { markParametersChanged(); });
+	masterVolume.addChangeCallback([this](float) { markParametersChanged(); });
+	mute.addChangeCallback([this](bool) { markParametersChanged(); });
+	reverseAudioSignal.addChangeCallback([this](bool) { markParametersChanged(); });
 
 	oscNumChannel->addChangeCallback([this](int32_t newValue) {
 		if(newValue > 0)
@@ -50,6 +81,10 @@ FilterChain::FilterChain(OscContainer* parent,
 
 void FilterChain::updateNumChannels(size_t numChannel) {
 	delayFilters.resize(numChannel + 1);  // +1 for side channel
+	for(DelayFilter& filter : delayFilters) {
+		filter.reserve(delay);
+	}
+	dcBlockerFilters.resize(numChannel);
 	// reverbFilters.resize(numChannel);
 	volume.resize(numChannel);
 
@@ -61,12 +96,20 @@ void FilterChain::updateNumChannels(size_t numChannel) {
 
 	compressorFilter.init(numChannel);
 	expanderFilter.init(numChannel);
+	saturationFilter.init(numChannel);
+
+	markParametersChanged();
 }
 
 void FilterChain::reset(float fs) {
+	this->fs = fs;
+
 	for(DelayFilter& delayFilter : delayFilters) {
 		delayFilter.reset();
 	}
+	for(DcBlockerFilter& dcBlockerFilter : dcBlockerFilters) {
+		dcBlockerFilter.reset();
+	}
 	//	for(auto& reverbFilter : reverbFilters) {
 	//		reverbFilter.second->reset();
 	//	}
@@ -77,53 +120,213 @@ void FilterChain::reset(float fs) {
 
 	compressorFilter.reset(fs);
 	expanderFilter.reset(fs);
+	saturationFilter.reset(fs);
+	midSideFilter.reset(fs);
+
+	// Coefficients depend on the sample rate
+	markParametersChanged();
+}
+
+bool FilterChain::compileParameters() {
+	// Read first so a change done while compiling is compiled again on the next call
+	uint32_t sequence = changeSequence.load(std::memory_order_relaxed);
+	if(sequence == compiledSequence.load(std::memory_order_relaxed))
+		return false;
+
+	// May replace a newer sequence stored by compileActiveParameters meanwhile, which only compiles again
+	compiledSequence.store(sequence, std::memory_order_relaxed);
+	compileParametersInto(*shadowParameters);
+	shadowParameters->sequence = sequence;
+
+	return true;
+}
+
+void FilterChain::compileActiveParameters() {
+	uint32_t sequence = changeSequence.load(std::memory_order_relaxed);
+	if(sequence == activeParameters->sequence)
+		return;
+
+	// The shadow parameters, if compiled but not swapped yet, are older and won't be swapped
+	compiledSequence.store(sequence, std::memory_order_relaxed);
+	compileParametersInto(*activeParameters);
+	activeParameters->sequence = sequence;
+	parametersChanged = true;
+}
+
+void FilterChain::compileParametersInto(FilterChainParameters& parameters) {
+	parameters.delay = delay;
+	parameters.dcBlocker = dcBlocker;
+	parameters.dcBlockerCoefficient = DcBlockerFilter::computeCoefficient(dcBlockerFrequency, fs);
+
+	float masterVolume = reverseAudioSignal ? -this->masterVolume.get() : this->masterVolume.get();
+
+	for(size_t channel = 0; channel < FilterChainParameters::MAX_CHANNELS; channel++) {
+		parameters.volumes[channel] = channel < volume.size() ? volume.at(channel).get() * masterVolume : 0;
+	}
+	parameters.mute = mute;
+
+	size_t band = 0;
+	for(auto& filter : eqFilters) {
+		if(band >= FilterChainParameters::EQ_BANDS)
+			break;
+		filter->compileParameters(parameters.eqBands[band]);
+		band++;
+	}
+	for(; band < FilterChainParameters::EQ_BANDS; band++) {
+		parameters.eqBands[band].enabled = false;
+		parameters.eqBands[band].dynamic = false;
+	}
+
+	expanderFilter.compileParameters(parameters.expander);
+	compressorFilter.compileParameters(parameters.compressor);
+	saturationFilter.compileParameters(parameters.saturation);
+	midSideFilter.compileParameters(parameters.midSide);
+}
+
+void FilterChain::swapParameters() {
+	// compileActiveParameters compiled newer parameters since the shadow ones
+	if((int32_t) (shadowParameters->sequence - activeParameters->sequence) <= 0)
+		return;
+
+	std::swap(activeParameters, shadowParameters);
+	parametersChanged = true;
 }
 
 void FilterChain::processSamples(float** samples, size_t numChannel, size_t count) {
 	float* peaks = (float*) alloca(sizeof(float) * numChannel);
-	float masterVolume = this->masterVolume.get();
+	const FilterChainParameters& parameters = *activeParameters;
+	bool parametersChanged = this->parametersChanged;
+	this->parametersChanged = false;
 
-	if(reverseAudioSignal) {
-		masterVolume *= -1;
+	if(parametersChanged) {
+		for(DelayFilter& delayFilter : delayFilters) {
+			delayFilter.setDelay(parameters.delay);
+		}
+		for(DcBlockerFilter& dcBlockerFilter : dcBlockerFilters) {
+			dcBlockerFilter.setCoefficient(parameters.dcBlockerCoefficient);
+		}
 	}
 
-	for(uint32_t channel = 0; channel < numChannel; channel++) {
-		delayFilters[channel].processSamples(samples[channel], count);
+	if(parameters.dcBlocker && parameters.delay > 0) {
+		// Delay and DC blocker in one pass
+		for(uint32_t channel = 0; channel < numChannel; channel++) {
+			DelayFilter& delayFilter = delayFilters[channel];
+			DcBlockerFilter& dcBlockerFilter = dcBlockerFilters[channel];
+			float* channelSamples = samples[channel];
+
+			for(size_t i = 0; i < count; i++) {
+				channelSamples[i] = dcBlockerFilter.processOneSample(delayFilter.processOneSample(channelSamples[i]));
+			}
+		}
+	} else if(parameters.dcBlocker) {
+		for(uint32_t channel = 0; channel < numChannel; channel++) {
+			dcBlockerFilters[channel].processSamples(samples[channel], count);
+		}
+	} else {
+		for(uint32_t channel = 0; channel < numChannel; channel++) {
+			delayFilters[channel].processSamples(samples[channel], count);
+		}
 	}
 
+	size_t band = 0;
 	for(auto& filter : eqFilters) {
-		filter->processSamples(samples, count);
+		if(band >= FilterChainParameters::EQ_BANDS)
+			break;
+		filter->processSamples(samples, count, parameters.eqBands[band], parametersChanged);
+		band++;
 	}
 
-	expanderFilter.processSamples(samples, count);
-	compressorFilter.processSamples(samples, count);
+	expanderFilter.processSamples(samples, count, parameters.expander);
+	compressorFilter.processSamples(samples, count, parameters.compressor);
+	saturationFilter.processSamples(samples, count, parameters.saturation);
 
 	//	for(uint32_t channel = 0; channel < numChannel; channel++) {
 	//		reverbFilters.at(channel).processSamples(samples[channel], count);
 	//	}
 
-	for(uint32_t channel = 0; channel < numChannel; channel++) {
-		float volume = this->volume.at(channel).get() * masterVolume;
-		float peak = 0;
-		for(size_t i = 0; i < count; i++) {
-			samples[channel][i] *= volume;
-			peak = fmaxf(peak, fabsf(samples[channel][i]));
-		}
-		peaks[channel] = peak;
+	float* sumSquares = (float*) alloca(sizeof(float) * numChannel);
+	float sumLR = 0;
+
+	if(numChannel == 2 && parameters.midSide.enable) {
+		// M/S, volume and peaks in one pass
+		midSideFilter.processSamples(
+		    samples, parameters.midSide, parametersChanged, parameters.volumes, peaks, sumSquares, &sumLR, count);
+	} else if(peakMeter.isExtendedEnabled()) {
+		applyVolume<true>(samples, numChannel, parameters.volumes, peaks, sumSquares, &sumLR, count);
+	} else {
+		applyVolume<false>(samples, numChannel, parameters.volumes, peaks, sumSquares, &sumLR, count);
 	}
 
 	// for(uint32_t channel = 0; channel < numChannel; channel++) {
 	// 	peakMeter.loudnessMeters[channel].processSamples(samples[channel], count);
 	// }
 	peakMeter.processSamples(peaks, numChannel, count);
+	if(peakMeter.isExtendedEnabled())
+		peakMeter.processExtendedSamples(sumSquares, sumLR, numChannel);
 
-	if(mute) {
+	if(parameters.mute) {
 		for(uint32_t channel = 0; channel < numChannel; channel++) {
 			std::fill_n(samples[channel], count, 0);
 		}
 	}
 }
 
+template<bool extendedMeter>
+void FilterChain::applyVolume(float** samples,
+                              size_t numChannel,
+                              const float* volumes,
+                              float* peaks,
+                              float* sumSquares,
+                              float* sumLR,
+                              size_t count) {
+	if(extendedMeter && numChannel == 2) {
+		// Both channels in the same loop to get L*R for the correlation
+		float* left = samples[0];
+		float* right = samples[1];
+		const float volumeLeft = volumes[0];
+		const float volumeRight = volumes[1];
+		float peakLeft = 0;
+		float peakRight = 0;
+		float lr = 0;
+		float ll = 0;
+		float rr = 0;
+
+		for(size_t i = 0; i < count; i++) {
+			float l = left[i] * volumeLeft;
+			float r = right[i] * volumeRight;
+			left[i] = l;
+			right[i] = r;
+
+			peakLeft = fmaxf(peakLeft, fabsf(l));
+			peakRight = fmaxf(peakRight, fabsf(r));
+			lr += l * r;
+			ll += l * l;
+			rr += r * r;
+		}
+
+		peaks[0] = peakLeft;
+		peaks[1] = peakRight;
+		sumSquares[0] = ll;
+		sumSquares[1] = rr;
+		*sumLR = lr;
+		return;
+	}
+
+	for(uint32_t channel = 0; channel < numChannel; channel++) {
+		float volume = volumes[channel];
+		float peak = 0;
+		float sumSquare = 0;
+		for(size_t i = 0; i < count; i++) {
+			samples[channel][i] *= volume;
+			peak = fmaxf(peak, fabsf(samples[channel][i]));
+			if constexpr(extendedMeter)
+				sumSquare += samples[channel][i] * samples[channel][i];
+		}
+		peaks[channel] = peak;
+		sumSquares[channel] = sumSquare;
+	}
+}
+
 float FilterChain::processSideChannelSample(float input) {
 	return delayFilters.back().processOneSample(input);
 }
@@ -1,16 +1,21 @@
 #pragma once
 
 #include "CompressorFilter.h"
+#include "DcBlockerFilter.h"
 #include "DelayFilter.h"
 #include "DitheringFilter.h"
 #include "EqFilter.h"
 #include "ExpanderFilter.h"
+#include "FilterChainParameters.h"
+#include "MidSideFilter.h"
 #include "PeakMeter.h"
 #include "ReverbFilter.h"
+#include "SaturationFilter.h"
 #include <Osc/OscArray.h>
 #include <Osc/OscContainer.h>
 #include <Osc/OscContainerArray.h>
 #include <Osc/OscVariable.h>
+#include <atomic>
 #include <stddef.h>
 
 class FilterChain : public OscContainer {
@@ -20,25 +25,62 @@ public:
 	            OscReadOnlyVariable<int32_t>* oscSampleRate);
 
 	void reset(float fs);
+	// numChannel must not exceed FilterChainParameters::MAX_CHANNELS
 	void processSamples(float** samples, size_t numChannel, size_t count);
 	float processSideChannelSample(float input);
 
 	void onFastTimer();
 
+	// Compile the parameters changed since the last call in the shadow parameters, outside of the audio processing.
+	// Return false when nothing changed.
+	bool compileParameters();
+	// Make the shadow parameters active, called at the start of an audio block after compileParameters returned true.
+	// Shadow parameters older than the active ones are not swapped.
+	void swapParameters();
+	// Compile the parameters changed since the active ones directly in the active parameters, from the audio
+	// processing between two segments of a block. Doesn't allocate.
+	void compileActiveParameters();
+	// Compile again on the next call, when compiled parameters are discarded
+	void invalidateParameters() { markParametersChanged(); }
+
 protected:
+	void markParametersChanged() { changeSequence.fetch_add(1, std::memory_order_relaxed); }
+	void compileParametersInto(FilterChainParameters& parameters);
 	void updateNumChannels(size_t numChannel);
 
+	// Volume and peak detection pass, with sum of squares and L*R for extended metering
+	template<bool extendedMeter>
+	void applyVolume(float** samples, size_t numChannel, const float* volumes, float* peaks, float* sumSquares,
+	                 float* sumLR, size_t count);
+
 private:
 	std::vector<DelayFilter> delayFilters;
+	std::vector<DcBlockerFilter> dcBlockerFilters;
 	// OscContainerArray<ReverbFilter> reverbFilters;
 	OscContainerArray<EqFilter> eqFilters;
 	CompressorFilter compressorFilter;
 	ExpanderFilter expanderFilter;
+	SaturationFilter saturationFilter;
+	MidSideFilter midSideFilter;
 	PeakMeter peakMeter;
 
 	OscVariable<int32_t> delay;
+	OscVariable<bool> dcBlocker;
+	OscVariable<float> dcBlockerFrequency;
+	float fs = 48000;
 	OscArray<float> volume;
 	OscVariable<float> masterVolume;
 	OscVariable<bool> mute;
 	OscVariable<bool> reverseAudioSignal;
+
+	// Parameters used by processSamples, only the audio processing swaps the pointers
+	FilterChainParameters parameterBlocks[2];
+	FilterChainParameters* activeParameters;
+	FilterChainParameters* shadowParameters;
+	// Incremented on each parameter change, from the main loop or the audio processing
+	std::atomic<uint32_t> changeSequence;
+	// Last sequence compiled by compileParameters or compileActiveParameters
+	std::atomic<uint32_t> compiledSequence;
+	// Set by swapParameters, cleared by the first block using the new parameters
+	bool parametersChanged;
 };
@@ -0,0 +1,95 @@
+#include "HalfBandOversampler.h"
+
+#include <algorithm>
+#include <math.h>
+
+// Zeroth order modified Bessel function of the first kind, for the Kaiser window
+static double besselI0(double x) {
+	double sum = 1;
+	double term = 1;
+	for(int k = 1; k < 32; k++) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+const std::array<float, HalfBandOversampler::TAPS>& HalfBandOversampler::getCoefficients() {
+	static const std::array<float, TAPS> coefs = []() {
+		std::array<float, TAPS> result;
+		const double beta = 7;
+		const double center = 2 * HALF_LENGTH - 1;
+		const double length = 4 * HALF_LENGTH - 1;
+		double sum = 0;
+
+		// Odd offsets from the center: d = 2k - (2 * HALF_LENGTH - 1)
+		for(size_t k = 0; k < TAPS; k++) {
+			double d = 2.0 * k - center;
+			double sinc = sin(M_PI * d / 2) / (M_PI * d);
+			double n = (d + center) / (length - 1);
+			double window = besselI0(beta * sqrt(1 - (2 * n - 1) * (2 * n - 1))) / besselI0(beta);
+			result[k] = sinc * window;
+			sum += result[k];
+		}
+
+		// Normalize for unity DC gain (the center tap is 0.5)
+		for(float& coef : result)
+			coef = coef * 0.5 / sum;
+
+		return result;
+	}();
+
+	return coefs;
+}
+
+HalfBandOversampler::HalfBandOversampler() {
+	reset();
+}
+
+void HalfBandOversampler::reset() {
+	std::fill(std::begin(upsampleState.history), std::end(upsampleState.history), 0);
+	upsampleState.index = 0;
+	std::fill(std::begin(downsampleState.history), std::end(downsampleState.history), 0);
+	downsampleState.index = 0;
+	downsampleDelay.fill(0);
+	downsampleDelayIndex = 0;
+}
+
+float HalfBandOversampler::FirState::put(float input, const std::array<float, TAPS>& coefs) {
+	index = index + 1 < TAPS ? index + 1 : 0;
+	history[index] = input;
+	history[index + TAPS] = input;
+
+	// Coefficients are symmetric, no need to reverse them
+	const float* samples = &history[index + 1];
+	float output = 0;
+	for(size_t k = 0; k < TAPS; k++) {
+		output += coefs[k] * samples[k];
+	}
+
+	return output;
+}
+
+void HalfBandOversampler::upsample(const float* input, float* output, size_t count) {
+	const std::array<float, TAPS>& coefs = getCoefficients();
+
+	for(size_t i = 0; i < count; i++) {
+		// Zero-stuffing loses half the energy, compensate with a gain of 2 (the center tap branch is 2 * 0.5)
+		output[2 * i] = 2 * upsampleState.put(input[i], coefs);
+		output[2 * i + 1] = upsampleState.getDelayed(HALF_LENGTH - 1);
+	}
+}
+
+void HalfBandOversampler::downsample(const float* input, float* output, size_t count) {
+	const std::array<float, TAPS>& coefs = getCoefficients();
+
+	for(size_t i = 0; i < count; i++) {
+		float evenPhase = downsampleState.put(input[2 * i], coefs);
+
+		float delayedOddSample = downsampleDelay[downsampleDelayIndex];
+		downsampleDelay[downsampleDelayIndex] = input[2 * i + 1];
+		downsampleDelayIndex = downsampleDelayIndex + 1 < HALF_LENGTH ? downsampleDelayIndex + 1 : 0;
+
+		output[i] = evenPhase + 0.5f * delayedOddSample;
+	}
+}
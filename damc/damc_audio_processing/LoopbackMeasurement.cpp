@@ -0,0 +1,205 @@
+#include "LoopbackMeasurement.h"
+
+#include <MathUtils.h>
+#include <algorithm>
+#include <complex>
+#include <fastapprox/fastexp.h>
+#include <fastapprox/fastlog.h>
+#include <math.h>
+
+LoopbackMeasurement::LoopbackMeasurement(OscContainer* parent)
+    : OscContainer(parent, "measurement", 8),
+      signalType(this, "type", (int32_t) SignalType::Mls),
+      outputStrip(this, "outputStrip", 0),
+      inputStrip(this, "inputStrip", 2),
+      level(this, "level", -12),
+      oscStart(this, "start"),
+      latency(this, "latency", -1),
+      latencyMs(this, "latencyMs", -1),
+      oscResponse(this, "response"),
+      mls(new uint32_t[(MLS_LENGTH + 31) / 32]()),
+      captureBuffer(new int16_t[MLS_LENGTH]),
+      impulseResponse(new float[IMPULSE_RESPONSE_LENGTH]) {
+	signalType.addCheckCallback([](int32_t value) -> bool {
+		return value == (int32_t) SignalType::Impulse || value == (int32_t) SignalType::Mls;
+	});
+	level.addCheckCallback([](float value) -> bool { return value <= 0; });
+
+	oscStart.setCallback([this](const auto&) { start(); });
+
+	generateMls();
+}
+
+void LoopbackMeasurement::reset(float fs) {
+	this->fs = fs;
+}
+
+void LoopbackMeasurement::start() {
+	if(state != State::Idle)
+		return;
+
+	amplitude = fastpow2(level * LOG10_VALUE_DIV_20);
+	outputIndex = 0;
+	sampleIndex = 0;
+	processedIndex = 0;
+	correlationIndex = 0;
+	correlationSum = 0;
+
+	// The type can be changed while playing, the buffers are sized for the one started
+	isMls = (SignalType) signalType.get() == SignalType::Mls;
+	if(isMls) {
+		playLength = 2 * MLS_LENGTH;
+	} else {
+		playLength = IMPULSE_RESPONSE_LENGTH;
+	}
+
+	state = State::Playing;
+}
+
+void LoopbackMeasurement::generateMls() {
+	// Fibonacci LFSR with the primitive polynomial x^12 + x^11 + x^10 + x^4 + 1
+	uint32_t lfsr = 1;
+	for(size_t i = 0; i < MLS_LENGTH; i++) {
+		uint32_t bit = ((lfsr >> 11) ^ (lfsr >> 10) ^ (lfsr >> 9) ^ (lfsr >> 3)) & 1;
+		if(lfsr & 1)
+			mls[i / 32] |= 1 << (i % 32);
+		lfsr = ((lfsr << 1) | bit) & MLS_LENGTH;
+	}
+}
+
+void LoopbackMeasurement::generateOutput(float** samples, size_t numChannel, size_t count) {
+	for(size_t i = 0; i < count && outputIndex < playLength; i++, outputIndex++) {
+		size_t index = outputIndex;
+		float sample;
+
+		if(isMls)
+			sample = getMlsBit(index % MLS_LENGTH) ? amplitude : -amplitude;
+		else
+			sample = index == 0 ? amplitude : 0;
+
+		for(size_t channel = 0; channel < numChannel; channel++) {
+			samples[channel][i] += sample;
+		}
+	}
+}
+
+void LoopbackMeasurement::captureInput(float** samples, size_t count) {
+	// Only the first channel is recorded
+	const float* input = samples[0];
+
+	for(size_t i = 0; i < count && sampleIndex < playLength; i++, sampleIndex++) {
+		if(isMls) {
+			// The first period fills the system so the second period is a circular convolution
+			if(sampleIndex >= MLS_LENGTH) {
+				float sample = std::clamp(input[i] * 32768.f, -32768.f, 32767.f);
+				captureBuffer[sampleIndex - MLS_LENGTH] = (int16_t) sample;
+			}
+		} else {
+			impulseResponse[sampleIndex] = input[i] / amplitude;
+		}
+	}
+
+	if(sampleIndex >= playLength)
+		state = isMls ? State::Correlating : State::Analyzing;
+}
+
+bool LoopbackMeasurement::processBackgroundSlice() {
+	switch(state) {
+		case State::Correlating:
+			correlateSlice();
+			if(processedIndex >= IMPULSE_RESPONSE_LENGTH) {
+				processedIndex = 0;
+				state = State::Analyzing;
+			}
+			return true;
+
+		case State::Analyzing:
+			if(processedIndex == 0) {
+				findLatency();
+			} else {
+				response[processedIndex - 1] = computeBandResponse(processedIndex - 1);
+			}
+			processedIndex++;
+			if(processedIndex > NUM_BANDS)
+				finish();
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+void LoopbackMeasurement::correlateSlice() {
+	// h[lag] = sum(y[k] * s[k - lag]) / (N + 1), a whole lag takes more than 100 us so it is summed in chunks
+	static constexpr size_t SAMPLES_PER_SLICE = 1024;
+	const float scale = 1.0f / (32768.f * amplitude * (MLS_LENGTH + 1));
+	const size_t lag = processedIndex;
+	size_t endIndex = std::min(correlationIndex + SAMPLES_PER_SLICE, MLS_LENGTH);
+	size_t sequenceIndex = (correlationIndex + MLS_LENGTH - lag) % MLS_LENGTH;
+	int32_t sum = correlationSum;
+
+	for(size_t k = correlationIndex; k < endIndex; k++) {
+		if(sequenceIndex >= MLS_LENGTH)
+			sequenceIndex = 0;
+		int32_t y = captureBuffer[k];
+		sum += getMlsBit(sequenceIndex) ? y : -y;
+		sequenceIndex++;
+	}
+
+	if(endIndex < MLS_LENGTH) {
+		correlationIndex = endIndex;
+		correlationSum = sum;
+	} else {
+		impulseResponse[lag] = sum * scale;
+		processedIndex++;
+		correlationIndex = 0;
+		correlationSum = 0;
+	}
+}
+
+void LoopbackMeasurement::findLatency() {
+	size_t peakIndex = 0;
+	float peak = 0;
+
+	for(size_t i = 0; i < MAX_LATENCY; i++) {
+		float value = fabsf(impulseResponse[i]);
+		if(value > peak) {
+			peak = value;
+			peakIndex = i;
+		}
+	}
+
+	// Nothing came back (below -60 dB)
+	latencyIndex = peak > 0.001f ? (int32_t) peakIndex : -1;
+}
+
+uint8_t LoopbackMeasurement::computeBandResponse(size_t band) {
+	if(latencyIndex < 0)
+		return 0;
+
+	// Single DFT bin of the impulse response starting a few samples before its peak
+	float ratio = powf(fs / 2 / 20, 1.0f / NUM_BANDS);
+	float frequency = 20 * powf(ratio, band + 0.5f);
+	const std::complex<float> step = std::polar(1.0f, -2 * (float) M_PI * frequency / fs);
+	std::complex<float> rotation = 1;
+	std::complex<float> sum = 0;
+	size_t begin = latencyIndex > 16 ? latencyIndex - 16 : 0;
+
+	for(size_t i = begin; i < begin + RESPONSE_LENGTH; i++) {
+		sum += impulseResponse[i] * rotation;
+		rotation *= step;
+	}
+
+	float power = std::norm(sum);
+	// 128 + 2 * 10 * log10(power), rounded
+	float value = power > 0 ? 128.5f + 6.0206f * fastlog2(power) : 0;
+	return (uint8_t) std::clamp(value, 0.0f, 255.0f);
+}
+
+void LoopbackMeasurement::finish() {
+	state = State::Idle;
+
+	latency.set(latencyIndex);
+	latencyMs.set(latencyIndex >= 0 ? latencyIndex * 1000.0f / fs : -1.0f);
+	oscResponse.sendBlobMessage(response, sizeof(response));
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Osc/OscContainer.h>
+#include <Osc/OscEndpoint.h>
+#include <Osc/OscVariable.h>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Round-trip latency and frequency response measurement.
+ * Writing "start" sends a test signal into the input of outputStrip and records the input of inputStrip (for example
+ * codec headphones looped back to the codec mic with a cable).
+ *
+ * Signals:
+ *  - Impulse: a single sample, the recorded signal is directly the impulse response.
+ *  - Mls: maximum length sequence of order 12, played twice. The second period is recorded and circularly
+ *    cross-correlated with the sequence to get the impulse response, which is much more robust to noise.
+ *
+ * Buffers are allocated once at construction, a measurement doesn't allocate. The correlation is computed in background
+ * slices from the main loop, each covering part of one lag so a slice stays short, then the response. Then:
+ *  - "latency" is the position of the impulse response peak in samples (-1 if nothing came back),
+ *  - "latencyMs" is the same in milliseconds,
+ *  - "response" is a blob of NUM_BANDS bytes with the gain at log-spaced frequencies from 20 Hz to fs/2, each byte is
+ *    128 + 2 * gain in dB (0.5 dB steps, 128 = 0 dB).
+ */
+class LoopbackMeasurement : public OscContainer {
+public:
+	enum class SignalType { Impulse, Mls };
+
+	static constexpr size_t MLS_ORDER = 12;
+	static constexpr size_t MLS_LENGTH = (1 << MLS_ORDER) - 1;
+	static constexpr size_t MAX_LATENCY = 1024;
+	static constexpr size_t RESPONSE_LENGTH = 1024;
+	static constexpr size_t IMPULSE_RESPONSE_LENGTH = MAX_LATENCY + RESPONSE_LENGTH;
+	static constexpr size_t NUM_BANDS = 32;
+
+	LoopbackMeasurement(OscContainer* parent);
+
+	void reset(float fs);
+
+	// Return the strip index to inject into or capture from, -1 if none
+	int32_t getOutputStrip() const { return state == State::Playing ? outputStrip.get() : -1; }
+	int32_t getInputStrip() const { return state == State::Playing ? inputStrip.get() : -1; }
+
+	void generateOutput(float** samples, size_t numChannel, size_t count);
+	void captureInput(float** samples, size_t count);
+
+	bool processBackgroundSlice();
+
+protected:
+	enum class State {
+		Idle,
+		Playing,
+		Correlating,
+		Analyzing,
+	};
+
+	void start();
+	void finish();
+
+	void generateMls();
+	bool getMlsBit(size_t index) const { return (mls[index / 32] >> (index % 32)) & 1; }
+
+	void correlateSlice();
+	void findLatency();
+	uint8_t computeBandResponse(size_t band);
+
+private:
+	OscVariable<int32_t> signalType;
+	OscVariable<int32_t> outputStrip;
+	OscVariable<int32_t> inputStrip;
+	OscVariable<float> level;
+	OscEndpoint oscStart;
+	OscReadOnlyVariable<int32_t> latency;
+	OscReadOnlyVariable<float> latencyMs;
+	OscEndpoint oscResponse;
+	float fs = 48000;
+
+	// Written by the audio path while Playing, then by the main loop
+	volatile State state = State::Idle;
+	bool isMls = false;
+	float amplitude = 0;
+	size_t outputIndex = 0;
+	size_t sampleIndex = 0;
+	size_t playLength = 0;
+	size_t processedIndex = 0;
+	// Correlation of the current lag (processedIndex) summed up to correlationIndex
+	size_t correlationIndex = 0;
+	int32_t correlationSum = 0;
+	int32_t latencyIndex = -1;
+
+	std::unique_ptr<uint32_t[]> mls;
+	std::unique_ptr<int16_t[]> captureBuffer;
+	std::unique_ptr<float[]> impulseResponse;
+	uint8_t response[NUM_BANDS];
+};
@@ -0,0 +1,110 @@
+#include "MidSideFilter.h"
+
+#include <MathUtils.h>
+#include <math.h>
+
+MidSideFilter::MidSideFilter(OscContainer* parent)
+    : OscContainer(parent, "midSide", 6),
+      enable(this, "enable", false),
+      midGain(this, "midGain", 1.0f),
+      sideGain(this, "sideGain", 1.0f),
+      width(this, "width", 1.0f),
+      sideEq(this, "sideEq") {
+	midGain.setOscConverters(&LogScaleOscConverter);
+	sideGain.setOscConverters(&LogScaleOscConverter);
+	width.addCheckCallback([](float value) -> bool { return value >= 0 && value <= 2; });
+
+	auto onChangeCallback = [this](auto) {
+		if(parameterChangedHook)
+			parameterChangedHook();
+	};
+	enable.addChangeCallback(onChangeCallback);
+	midGain.addChangeCallback(onChangeCallback);
+	sideGain.addChangeCallback(onChangeCallback);
+	width.addChangeCallback(onChangeCallback);
+
+	// Side signal is mono
+	sideEq.init(1);
+}
+
+void MidSideFilter::reset(float fs) {
+	sideEq.reset(fs);
+}
+
+void MidSideFilter::setOnParameterChanged(std::function<void()> onParameterChanged) {
+	parameterChangedHook = onParameterChanged;
+	sideEq.setOnParameterChanged(std::move(onParameterChanged));
+}
+
+void MidSideFilter::compileParameters(FilterChainParameters::MidSide& midSide) {
+	midSide.enable = enable;
+	midSide.midScale = 0.5f * midGain;
+	midSide.sideScale = 0.5f * sideGain * width;
+	sideEq.compileParameters(midSide.sideEq);
+}
+
+void MidSideFilter::processSamples(float** samples,
+                                   const FilterChainParameters::MidSide& midSide,
+                                   bool changed,
+                                   const float* volumes,
+                                   float* peaks,
+                                   float* sumSquares,
+                                   float* sumLR,
+                                   size_t count) {
+	if(changed)
+		sideEq.getBiquadFilter(0).update(midSide.sideEq.a_coefs, midSide.sideEq.b_coefs);
+
+	if(midSide.sideEq.enabled)
+		processStereo<true>(samples, midSide, volumes, peaks, sumSquares, sumLR, count);
+	else
+		processStereo<false>(samples, midSide, volumes, peaks, sumSquares, sumLR, count);
+}
+
+template<bool useSideEq>
+void MidSideFilter::processStereo(float** samples,
+                                  const FilterChainParameters::MidSide& midSide,
+                                  const float* volumes,
+                                  float* peaks,
+                                  float* sumSquares,
+                                  float* sumLR,
+                                  size_t count) {
+	float* left = samples[0];
+	float* right = samples[1];
+	BiquadFilter& sideBiquad = sideEq.getBiquadFilter(0);
+
+	const float midScale = midSide.midScale;
+	const float sideScale = midSide.sideScale;
+	const float volumeLeft = volumes[0];
+	const float volumeRight = volumes[1];
+
+	float peakLeft = 0;
+	float peakRight = 0;
+	float lr = 0;
+	float ll = 0;
+	float rr = 0;
+
+	for(size_t i = 0; i < count; i++) {
+		float mid = (left[i] + right[i]) * midScale;
+		float side = (left[i] - right[i]) * sideScale;
+
+		if constexpr(useSideEq)
+			side = sideBiquad.put(side);
+
+		float l = (mid + side) * volumeLeft;
+		float r = (mid - side) * volumeRight;
+		left[i] = l;
+		right[i] = r;
+
+		peakLeft = fmaxf(peakLeft, fabsf(l));
+		peakRight = fmaxf(peakRight, fabsf(r));
+		lr += l * r;
+		ll += l * l;
+		rr += r * r;
+	}
+
+	peaks[0] = peakLeft;
+	peaks[1] = peakRight;
+	sumSquares[0] = ll;
+	sumSquares[1] = rr;
+	*sumLR = lr;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "EqFilter.h"
+#include "FilterChainParameters.h"
+#include <Osc/OscContainer.h>
+#include <Osc/OscVariable.h>
+#include <functional>
+#include <stddef.h>
+
+/**
+ * @brief Mid/side stage for stereo strips.
+ * Encode L/R to M/S, apply independent M and S gains, width and an optional EQ band on the side signal, then decode
+ * back to L/R. The channel volume and peak detection are done in the same loop so the whole stage costs a single
+ * pass over the two channel buffers.
+ *
+ * The output energy sums are accumulated in the same pass and handed to the strip PeakMeter, which publishes the
+ * correlation used to check mono compatibility ("meter_correlation" with "meter_enable_extended").
+ */
+class MidSideFilter : public OscContainer {
+public:
+	MidSideFilter(OscContainer* parent);
+
+	void reset(float fs);
+
+	// Compiled parameters, as EqFilter: parameter changes call the hook and the owner compiles them
+	void setOnParameterChanged(std::function<void()> onParameterChanged);
+	void compileParameters(FilterChainParameters::MidSide& midSide);
+
+	// samples must contain 2 channels
+	// sumSquares and sumLR receive the output energy sums used for correlation, for PeakMeter extended metering
+	void processSamples(float** samples,
+	                    const FilterChainParameters::MidSide& midSide,
+	                    bool changed,
+	                    const float* volumes,
+	                    float* peaks,
+	                    float* sumSquares,
+	                    float* sumLR,
+	                    size_t count);
+
+protected:
+	template<bool useSideEq>
+	void processStereo(float** samples,
+	                   const FilterChainParameters::MidSide& midSide,
+	                   const float* volumes,
+	                   float* peaks,
+	                   float* sumSquares,
+	                   float* sumLR,
+	                   size_t count);
+
+private:
+	OscVariable<bool> enable;
+	OscVariable<float> midGain;
+	OscVariable<float> sideGain;
+	OscVariable<float> width;
+	EqFilter sideEq;
+	std::function<void()> parameterChangedHook;
+};
@@ -11,18 +11,21 @@ PeakMeter::PeakMeter(OscContainer* parent,
       oscSampleRate(oscSampleRate),
 	  oscPeakGlobal(parent, "meter"),
 	  oscPeakPerChannel(parent, "meter_per_channel"),
-      samplesInPeaks(0),
-      oscEnablePeakUpdate(parent, "meter_enable_per_channel", false) {
+      oscEnablePeakUpdate(parent, "meter_enable_per_channel", false),
+      oscRms(parent, "meter_rms"),
+      oscCrestFactor(parent, "meter_crest"),
+      oscCorrelation(parent, "meter_correlation"),
+      oscEnableExtended(parent, "meter_enable_extended", false) {
 
 	oscNumChannel->addChangeCallback([this](int32_t newValue) {
 		levelsDb.resize(newValue, -192);
 		oscPeakPerChannelArguments.reserve(levelsDb.size());
 
-		// peakMutex.lock();
-		peaksPerChannel.resize(newValue, 0);
-		peaksPerChannelToSend.resize(newValue, 0);
+		for(Accumulator& accumulator : accumulators) {
+			accumulator.peaksPerChannel.resize(newValue, 0);
+			accumulator.sumSquaresPerChannel.resize(newValue, 0);
+		}
 		// loudnessMeters.resize(newValue);
-		// peakMutex.unlock();
 		//		for(auto& loudnessMeter : loudnessMeters) {
 		//			loudnessMeter.reset(this->oscSampleRate->get());
 		//		}
@@ -38,35 +41,59 @@ PeakMeter::PeakMeter(OscContainer* parent,
 PeakMeter::~PeakMeter() {}
 
 void PeakMeter::processSamples(const float* peaks, size_t numChannels, size_t samplesInPeaks) {
-	// peakMutex.lock();
-	this->samplesInPeaks += samplesInPeaks;
+	// Called once per block before processExtendedSamples, the swap is done here
+	if(swapRequested.load(std::memory_order_acquire)) {
+		audioAccumulator.store(audioAccumulator.load(std::memory_order_relaxed) ^ 1, std::memory_order_relaxed);
+		swapRequested.store(false, std::memory_order_release);
+	}
+
+	Accumulator& accumulator = accumulators[audioAccumulator.load(std::memory_order_relaxed)];
+	accumulator.samplesInPeaks += samplesInPeaks;
 	for(size_t i = 0; i < numChannels; i++) {
-		this->peaksPerChannel[i] = fmaxf(peaks[i], this->peaksPerChannel[i]);
+		accumulator.peaksPerChannel[i] = fmaxf(peaks[i], accumulator.peaksPerChannel[i]);
 	}
-	// peakMutex.unlock();
 }
 
-void PeakMeter::onFastTimer() {
-	int samples;
-	int32_t sampleRate = oscSampleRate->get();
+void PeakMeter::processExtendedSamples(const float* sumSquares, float sumLR, size_t numChannels) {
+	Accumulator& accumulator = accumulators[audioAccumulator.load(std::memory_order_relaxed)];
+	for(size_t i = 0; i < numChannels; i++) {
+		accumulator.sumSquaresPerChannel[i] += sumSquares[i];
+	}
+	accumulator.sumLR += sumLR;
+}
 
-	std::fill(peaksPerChannelToSend.begin(), peaksPerChannelToSend.end(), 0);
+void PeakMeter::releaseAccumulator(Accumulator* accumulator) {
+	accumulator->samplesInPeaks = 0;
+	std::fill(accumulator->peaksPerChannel.begin(), accumulator->peaksPerChannel.end(), 0);
+	std::fill(accumulator->sumSquaresPerChannel.begin(), accumulator->sumSquaresPerChannel.end(), 0);
+	accumulator->sumLR = 0;
 
-	// peakMutex.lock();
-	samples = this->samplesInPeaks;
-	peaksPerChannelToSend.swap(this->peaksPerChannel);
-	this->samplesInPeaks = 0;
-	// peakMutex.unlock();
+	// Give it back to the audio processing at its next block
+	swapRequested.store(true, std::memory_order_release);
+}
 
-	if(sampleRate == 0)
+void PeakMeter::onFastTimer() {
+	// No audio block since the previous swap request, nothing new to read
+	if(swapRequested.load(std::memory_order_acquire))
 		return;
 
+	Accumulator* accumulator = &accumulators[audioAccumulator.load(std::memory_order_relaxed) ^ 1];
+	const std::vector<float>& peaksPerChannel = accumulator->peaksPerChannel;
+	const std::vector<float>& sumSquaresPerChannel = accumulator->sumSquaresPerChannel;
+	int samples = accumulator->samplesInPeaks;
+	int32_t sampleRate = oscSampleRate->get();
+
+	if(sampleRate == 0) {
+		releaseAccumulator(accumulator);
+		return;
+	}
+
 	float deltaT = (float) samples / sampleRate;
 	float maxLevel = 0;
 
-	for(size_t channel = 0; channel < peaksPerChannelToSend.size(); channel++) {
+	for(size_t channel = 0; channel < peaksPerChannel.size(); channel++) {
 		// float peakDb = this->loudnessMeters[channel].getLoudness();
-		float peakDb = peaksPerChannelToSend[channel] != 0 ? 20.0 * log10(peaksPerChannelToSend[channel]) : -INFINITY;
+		float peakDb = peaksPerChannel[channel] != 0 ? 20.0 * log10(peaksPerChannel[channel]) : -INFINITY;
 
 		float decayAmount = 11.76470588235294 * deltaT;  // -20dB / 1.7s
 		// float levelDb = peakDb;
@@ -86,4 +113,31 @@ void PeakMeter::onFastTimer() {
 		oscPeakPerChannelArguments.emplace_back(v);
 	}
 	oscPeakPerChannel.sendMessage(oscPeakPerChannelArguments.data(), oscPeakPerChannelArguments.size());
+
+	if(oscEnableExtended.get() && samples > 0) {
+		// RMS and crest factor over the last timer period, in dB
+		oscPeakPerChannelArguments.clear();
+		for(size_t channel = 0; channel < sumSquaresPerChannel.size(); channel++) {
+			float meanSquare = sumSquaresPerChannel[channel] / samples;
+			oscPeakPerChannelArguments.emplace_back(meanSquare > 0 ? 10.0f * log10f(meanSquare) : -192.0f);
+		}
+		oscRms.sendMessage(oscPeakPerChannelArguments.data(), oscPeakPerChannelArguments.size());
+
+		for(size_t channel = 0; channel < sumSquaresPerChannel.size(); channel++) {
+			float meanSquare = sumSquaresPerChannel[channel] / samples;
+			float peak = peaksPerChannel[channel];
+			oscPeakPerChannelArguments[channel] =
+			    meanSquare > 0 ? 20.0f * log10f(peak) - 10.0f * log10f(meanSquare) : 0.0f;
+		}
+		oscCrestFactor.sendMessage(oscPeakPerChannelArguments.data(), oscPeakPerChannelArguments.size());
+
+		if(sumSquaresPerChannel.size() == 2) {
+			// 1: mono, 0: uncorrelated, -1: out of phase
+			float energy = sumSquaresPerChannel[0] * sumSquaresPerChannel[1];
+			OscArgument correlation = energy > 0 ? accumulator->sumLR / sqrtf(energy) : 0.0f;
+			oscCorrelation.sendMessage(&correlation, 1);
+		}
+	}
+
+	releaseAccumulator(accumulator);
 }
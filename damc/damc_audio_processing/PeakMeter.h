@@ -3,7 +3,8 @@
 #include <LoudnessMeter.h>
 #include <Osc/OscVariable.h>
 #include <Osc/OscDynamicVariable.h>
-// #include <mutex>
+#include <array>
+#include <atomic>
 #include <stdint.h>
 #include <string>
 #include <vector>
@@ -21,6 +22,10 @@ public:
 
 	void processSamples(const float* peaks, size_t numChannels, size_t samplesInPeaks);
 
+	// Extended metering: sum of squares per channel and, for stereo, sum of L*R over the same samples as the peaks
+	bool isExtendedEnabled() const { return oscEnableExtended.get(); }
+	void processExtendedSamples(const float* sumSquares, float sumLR, size_t numChannels);
+
 	void onFastTimer();
 
 	// std::vector<LoudnessMeter> loudnessMeters;
@@ -31,14 +36,30 @@ private:
 	OscDynamicVariable<float> oscPeakGlobal;
 	OscDynamicVariable<float> oscPeakPerChannel;
 
+	// Accumulated by the audio processing between two onFastTimer calls
+	struct Accumulator {
+		int samplesInPeaks = 0;
+		std::vector<float> peaksPerChannel;
+		std::vector<float> sumSquaresPerChannel;
+		float sumLR = 0;
+	};
+
+	void releaseAccumulator(Accumulator* accumulator);
+
 	std::vector<float> levelsDb;
-	// std::mutex peakMutex;
-	int samplesInPeaks;
-	std::vector<float> peaksPerChannel;
-	std::vector<float> peaksPerChannelToSend;
+	// Double buffer: the audio processing accumulates in accumulators[audioAccumulator]. onFastTimer requests a swap,
+	// the audio processing flips the index at its next block, then the next onFastTimer reads the other one.
+	std::array<Accumulator, 2> accumulators;
+	std::atomic<uint32_t> audioAccumulator{0};
+	std::atomic<bool> swapRequested{false};
 	std::string oscPeakGlobalPath;
 	std::string oscPeakPerChannelPath;
 	std::vector<OscArgument> oscPeakPerChannelArguments;
 
 	OscVariable<bool> oscEnablePeakUpdate;
+
+	OscDynamicVariable<float> oscRms;
+	OscDynamicVariable<float> oscCrestFactor;
+	OscDynamicVariable<float> oscCorrelation;
+	OscVariable<bool> oscEnableExtended;
 };
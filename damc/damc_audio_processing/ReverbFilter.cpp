@@ -13,6 +13,8 @@ ReverbFilter::ReverbFilter(OscContainer* parent, const std::string_view& name)
       reverberators(this, "innerReverberators") {
 	reverberators.setFactory(
 	    [](OscContainer* parent, int name) { return new ReverbFilter(parent, Utils::toString(name)); });
+	// Delay line is resized
+	delay.setMainLoopOnly();
 	delay.addChangeCallback([this](int32_t oscValue) { delayFilter.setParameters(oscValue); });
 }
 
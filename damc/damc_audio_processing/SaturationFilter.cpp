@@ -0,0 +1,103 @@
+#include "SaturationFilter.h"
+
+#include <MathUtils.h>
+#include <alloca.h>
+#include <fastapprox/fasthyperbolic.h>
+#include <math.h>
+
+SaturationFilter::SaturationFilter(OscContainer* parent)
+    : OscContainer(parent, "saturation", 6),
+      enable(this, "enable", false),
+      drive(this, "drive", 6),
+      level(this, "level", 0),
+      oversampling(this, "oversampling", true),
+      latency(this, "latency") {
+	drive.addCheckCallback([](float value) -> bool { return value >= 0 && value <= 36; });
+
+	auto onChangeCallback = [this](auto) { onParameterChanged(); };
+	drive.addChangeCallback(onChangeCallback);
+	level.addChangeCallback(onChangeCallback);
+	oversampling.addChangeCallback([this](bool) {
+		updateLatency();
+		onParameterChanged();
+	});
+	enable.addChangeCallback([this](bool) {
+		updateLatency();
+		onParameterChanged();
+	});
+
+	compileParameters(parameters);
+	oversamplingApplied = parameters.oversampling;
+}
+
+void SaturationFilter::setOnParameterChanged(std::function<void()> onParameterChanged) {
+	parameterChangedHook = std::move(onParameterChanged);
+}
+
+void SaturationFilter::onParameterChanged() {
+	if(parameterChangedHook)
+		parameterChangedHook();
+	else
+		compileParameters(parameters);
+}
+
+void SaturationFilter::compileParameters(FilterChainParameters::Saturation& saturation) const {
+	saturation.enable = enable;
+	saturation.oversampling = oversampling;
+	saturation.driveRatio = fastpow2(drive * LOG10_VALUE_DIV_20);
+	saturation.outputRatio = fastpow2(level * LOG10_VALUE_DIV_20) / tanhf(saturation.driveRatio);
+}
+
+void SaturationFilter::init(size_t numChannel) {
+	oversamplers.resize(numChannel);
+}
+
+void SaturationFilter::reset(float) {
+	for(HalfBandOversampler& oversampler : oversamplers)
+		oversampler.reset();
+}
+
+void SaturationFilter::processSamples(float** samples, size_t count) {
+	processSamples(samples, count, parameters);
+}
+
+void SaturationFilter::processSamples(float** samples,
+                                      size_t count,
+                                      const FilterChainParameters::Saturation& saturation) {
+	if(saturation.oversampling != oversamplingApplied) {
+		for(HalfBandOversampler& oversampler : oversamplers)
+			oversampler.reset();
+		oversamplingApplied = saturation.oversampling;
+	}
+
+	if(!saturation.enable)
+		return;
+
+	if(saturation.oversampling) {
+		float* oversampledBuffer = (float*) alloca(sizeof(float) * 2 * count);
+
+		for(size_t channel = 0; channel < oversamplers.size(); channel++) {
+			HalfBandOversampler& oversampler = oversamplers[channel];
+
+			oversampler.upsample(samples[channel], oversampledBuffer, count);
+			applyNonLinearity(oversampledBuffer, 2 * count, saturation.driveRatio, saturation.outputRatio);
+			oversampler.downsample(oversampledBuffer, samples[channel], count);
+		}
+	} else {
+		for(size_t channel = 0; channel < oversamplers.size(); channel++) {
+			applyNonLinearity(samples[channel], count, saturation.driveRatio, saturation.outputRatio);
+		}
+	}
+}
+
+void SaturationFilter::updateLatency() {
+	latency.set(enable && oversampling ? (int32_t) HalfBandOversampler::LATENCY : 0);
+}
+
+void SaturationFilter::applyNonLinearity(float* samples, size_t count, float driveRatio, float outputRatio) {
+	for(size_t i = 0; i < count; i++) {
+		// tanh is already saturated at +/-8, this also keeps fastexp in its valid range
+		float x = fminf(fmaxf(driveRatio * samples[i], -8.0f), 8.0f);
+		samples[i] = outputRatio * fasttanh(x);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "FilterChainParameters.h"
+#include "HalfBandOversampler.h"
+#include <Osc/OscContainer.h>
+#include <Osc/OscVariable.h>
+#include <functional>
+#include <stddef.h>
+#include <vector>
+
+/**
+ * @brief Soft-clip saturation.
+ * Apply y = tanh(drive * x) / tanh(drive) so 0 dBFS stays at 0 dBFS while peaks are smoothly rounded.
+ * The nonlinearity runs at 2x the sample rate (when oversampling is enabled) to reduce aliasing of the generated
+ * harmonics.
+ *
+ * Oversampling delays the signal by HalfBandOversampler::LATENCY samples. It is not compensated (that would delay
+ * every strip), the current delay is published on "latency" so clients can align the strip.
+ */
+class SaturationFilter : public OscContainer {
+public:
+	SaturationFilter(OscContainer* parent);
+
+	void init(size_t numChannel);
+	void reset(float fs);
+	void processSamples(float** samples, size_t count);
+
+	// Compiled parameters, as EqFilter: parameter changes call the hook and the owner compiles them
+	void setOnParameterChanged(std::function<void()> onParameterChanged);
+	void compileParameters(FilterChainParameters::Saturation& saturation) const;
+	void processSamples(float** samples, size_t count, const FilterChainParameters::Saturation& saturation);
+
+protected:
+	void onParameterChanged();
+	void applyNonLinearity(float* samples, size_t count, float driveRatio, float outputRatio);
+	void updateLatency();
+
+private:
+	OscVariable<bool> enable;
+	OscVariable<float> drive;
+	OscVariable<float> level;
+	OscVariable<bool> oversampling;
+	// In samples at the base rate
+	OscReadOnlyVariable<int32_t> latency;
+
+	// Used without a hook
+	FilterChainParameters::Saturation parameters;
+	std::function<void()> parameterChangedHook;
+
+	// The oversamplers are reset when the applied oversampling changes
+	bool oversamplingApplied;
+	std::vector<HalfBandOversampler> oversamplers;
+};
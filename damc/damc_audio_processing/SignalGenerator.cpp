@@ -0,0 +1,121 @@
+#include "SignalGenerator.h"
+
+#include <MathUtils.h>
+#include <fastapprox/fastexp.h>
+#include <math.h>
+
+SignalGenerator::SignalGenerator(OscContainer* parent)
+    : OscContainer(parent, "generator", 10),
+      enable(this, "enable", false),
+      signalType(this, "type", (int32_t) SignalType::Sine),
+      targetStrip(this, "strip", -1),
+      level(this, "level", -20),
+      frequency(this, "frequency", 1000),
+      sweepStart(this, "sweepStart", 20),
+      sweepEnd(this, "sweepEnd", 20000),
+      sweepDuration(this, "sweepDuration", 5),
+      impulsePeriod(this, "impulsePeriod", 1) {
+	signalType.addCheckCallback([](int32_t value) -> bool {
+		return value >= (int32_t) SignalType::Sine && value <= (int32_t) SignalType::Impulse;
+	});
+	level.addCheckCallback([](float value) -> bool { return value <= 0; });
+	auto checkFrequency = [this](float value) -> bool { return value > 0 && value < fs / 2; };
+	frequency.addCheckCallback(checkFrequency);
+	sweepStart.addCheckCallback(checkFrequency);
+	sweepEnd.addCheckCallback(checkFrequency);
+	sweepDuration.addCheckCallback([](float value) -> bool { return value > 0 && value <= 60; });
+	impulsePeriod.addCheckCallback([](float value) -> bool { return value > 0 && value <= 60; });
+
+	auto onChangeCallback = [this](auto) { updateParameters(); };
+	enable.addChangeCallback(onChangeCallback);
+	signalType.addChangeCallback(onChangeCallback);
+	level.addChangeCallback(onChangeCallback);
+	frequency.addChangeCallback(onChangeCallback);
+	sweepStart.addChangeCallback(onChangeCallback);
+	sweepEnd.addChangeCallback(onChangeCallback);
+	sweepDuration.addChangeCallback(onChangeCallback);
+	impulsePeriod.addChangeCallback(onChangeCallback);
+}
+
+void SignalGenerator::reset(float fs) {
+	this->fs = fs;
+	updateParameters();
+}
+
+void SignalGenerator::updateParameters() {
+	amplitude = fastpow2(level * LOG10_VALUE_DIV_20);
+
+	sweepLength = (size_t) (sweepDuration * fs);
+	sweepRatio = expf(logf(sweepEnd / sweepStart) / sweepLength);
+	impulseLength = (size_t) (impulsePeriod * fs);
+
+	// Restart the signal from its beginning
+	sampleIndex = 0;
+	phase = 0;
+	if((SignalType) signalType.get() == SignalType::Sweep)
+		phaseIncrement = 2 * (float) M_PI * sweepStart / fs;
+	else
+		phaseIncrement = 2 * (float) M_PI * frequency / fs;
+}
+
+void SignalGenerator::processSamples(float** samples, size_t numChannel, size_t count) {
+	for(size_t i = 0; i < count; i++) {
+		float sample = generateSample();
+
+		for(size_t channel = 0; channel < numChannel; channel++) {
+			samples[channel][i] += sample;
+		}
+	}
+}
+
+float SignalGenerator::generateSample() {
+	switch((SignalType) signalType.get()) {
+		case SignalType::Sine: {
+			float sample = amplitude * sinf(phase);
+			phase += phaseIncrement;
+			if(phase >= 2 * (float) M_PI)
+				phase -= 2 * (float) M_PI;
+			return sample;
+		}
+
+		case SignalType::Sweep: {
+			float sample = amplitude * sinf(phase);
+			phase += phaseIncrement;
+			if(phase >= 2 * (float) M_PI)
+				phase -= 2 * (float) M_PI;
+
+			phaseIncrement *= sweepRatio;
+			sampleIndex++;
+			if(sampleIndex >= sweepLength) {
+				sampleIndex = 0;
+				phase = 0;
+				phaseIncrement = 2 * (float) M_PI * sweepStart / fs;
+			}
+			return sample;
+		}
+
+		case SignalType::PinkNoise: {
+			// xorshift32 white noise in [-1, 1)
+			noiseState ^= noiseState << 13;
+			noiseState ^= noiseState >> 17;
+			noiseState ^= noiseState << 5;
+			float white = (int32_t) noiseState * (1.0f / 2147483648.0f);
+
+			pinkState[0] = 0.99765f * pinkState[0] + white * 0.0990460f;
+			pinkState[1] = 0.96300f * pinkState[1] + white * 0.2965164f;
+			pinkState[2] = 0.57000f * pinkState[2] + white * 1.0526913f;
+			// The filter has a gain of about 4 at low frequencies
+			return amplitude * 0.25f * (pinkState[0] + pinkState[1] + pinkState[2] + white * 0.1848f);
+		}
+
+		case SignalType::Impulse: {
+			float sample = sampleIndex == 0 ? amplitude : 0;
+			sampleIndex++;
+			if(sampleIndex >= impulseLength)
+				sampleIndex = 0;
+			return sample;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Osc/OscContainer.h>
+#include <Osc/OscVariable.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Test signal generator.
+ * The generated signal is added to all channels of the input of the strip selected by "strip" (-1 to disable).
+ *
+ * Signals:
+ *  - Sine: fixed frequency sine.
+ *  - Sweep: exponential sine sweep from sweepStart to sweepEnd in sweepDuration seconds, then restart.
+ *  - PinkNoise: white noise filtered with a -3 dB/oct filter (Paul Kellet's economy filter).
+ *  - Impulse: one sample at level every impulsePeriod seconds.
+ */
+class SignalGenerator : public OscContainer {
+public:
+	enum class SignalType { Sine, Sweep, PinkNoise, Impulse };
+
+	SignalGenerator(OscContainer* parent);
+
+	void reset(float fs);
+	int32_t getTargetStrip() const { return enable ? targetStrip.get() : -1; }
+	void processSamples(float** samples, size_t numChannel, size_t count);
+
+protected:
+	float generateSample();
+	void updateParameters();
+
+private:
+	OscVariable<bool> enable;
+	OscVariable<int32_t> signalType;
+	OscVariable<int32_t> targetStrip;
+	OscVariable<float> level;
+	OscVariable<float> frequency;
+	OscVariable<float> sweepStart;
+	OscVariable<float> sweepEnd;
+	OscVariable<float> sweepDuration;
+	OscVariable<float> impulsePeriod;
+	float fs = 48000;
+
+	float amplitude = 0;
+	float phase = 0;
+	float phaseIncrement = 0;
+	float sweepRatio = 1;
+	size_t sweepLength = 0;
+	size_t impulseLength = 0;
+	size_t sampleIndex = 0;
+
+	uint32_t noiseState = 0x12345678;
+	float pinkState[3] = {};
+};
@@ -0,0 +1,209 @@
+#include "SpectrumAnalyzer.h"
+
+#include <algorithm>
+#include <fastapprox/fastlog.h>
+#include <math.h>
+
+SpectrumAnalyzer::SpectrumAnalyzer(OscContainer* parent,
+                                   OscReadOnlyVariable<int32_t>* oscNumChannel,
+                                   OscReadOnlyVariable<int32_t>* oscSampleRate)
+    : OscContainer(parent, "spectrum", 3),
+      enable(this, "enable", false),
+      size(this, "size", 1024),
+      oscBands(this, "bands"),
+      oscSampleRate(oscSampleRate) {
+	size.addCheckCallback([](int32_t value) -> bool {
+		return value >= 256 && value <= 2048 && (value & (value - 1)) == 0;
+	});
+
+	// Buffers are reallocated, not while the audio processing or the FFT slice use them
+	enable.setMainLoopOnly();
+	size.setMainLoopOnly();
+	enable.addChangeCallback([this](bool) { allocate(); });
+	size.addChangeCallback([this](int32_t) { allocate(); });
+	oscSampleRate->addChangeCallback([this](int32_t) { updateBandEdges(); });
+}
+
+void SpectrumAnalyzer::allocate() {
+	// Stop the audio path from writing in the buffer being replaced, before it is freed
+	state.store(State::Disabled, std::memory_order_relaxed);
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+
+	if(enable) {
+		captureBuffer.reset(new float[size]);
+		fftBuffer.reset(new std::complex<float>[size / 2]);
+		updateBandEdges();
+		bandPowers.fill(0);
+		bandPowersValid = false;
+		captureIndex = 0;
+		state.store(State::Capturing, std::memory_order_release);
+	} else {
+		captureBuffer.reset();
+		fftBuffer.reset();
+	}
+}
+
+void SpectrumAnalyzer::updateBandEdges() {
+	float fs = oscSampleRate->get();
+	size_t numBins = size / 2;
+
+	if(fs <= 0)
+		return;
+
+	// Bin 0 (DC) is never part of a band
+	float binPerHz = size / fs;
+	float ratio = powf(fs / 2 / MIN_FREQUENCY, 1.0f / NUM_BANDS);
+	float frequency = MIN_FREQUENCY;
+
+	for(size_t band = 0; band <= NUM_BANDS; band++) {
+		size_t bin = (size_t) lrintf(frequency * binPerHz);
+		bandEdges[band] = std::clamp<size_t>(bin, 1, numBins);
+		frequency *= ratio;
+	}
+}
+
+void SpectrumAnalyzer::processSamples(float** samples, size_t numChannel, size_t count) {
+	if(state.load(std::memory_order_acquire) != State::Capturing)
+		return;
+
+	float* buffer = captureBuffer.get();
+	size_t captureSize = size;
+	size_t index = captureIndex;
+	float scale = 1.0f / numChannel;
+
+	for(size_t i = 0; i < count && index < captureSize; i++, index++) {
+		float sample = 0;
+		for(size_t channel = 0; channel < numChannel; channel++)
+			sample += samples[channel][i];
+		buffer[index] = sample * scale;
+	}
+
+	captureIndex = index;
+	if(index >= captureSize)
+		state.store(State::Windowing, std::memory_order_release);
+}
+
+bool SpectrumAnalyzer::processBackgroundSlice() {
+	switch(state.load(std::memory_order_acquire)) {
+		case State::Windowing:
+			applyWindow();
+			fftStageSize = 2;
+			state.store(State::FftStage, std::memory_order_relaxed);
+			return true;
+
+		case State::FftStage:
+			computeFftStage();
+			fftStageSize *= 2;
+			if(fftStageSize > (size_t) size / 2)
+				state.store(State::Bands, std::memory_order_relaxed);
+			return true;
+
+		case State::Bands:
+			computeBands();
+			captureIndex = 0;
+			state.store(State::Capturing, std::memory_order_release);
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+void SpectrumAnalyzer::applyWindow() {
+	const float* input = captureBuffer.get();
+	std::complex<float>* output = fftBuffer.get();
+	size_t n = size;
+	size_t halfN = n / 2;
+	size_t bits = 0;
+
+	while(((size_t) 1 << bits) < halfN)
+		bits++;
+
+	// Hann window, cos(2 pi i / n) computed by rotation
+	const std::complex<float> step = std::polar(1.0f, 2 * (float) M_PI / n);
+	std::complex<float> rotation = 1;
+
+	for(size_t i = 0; i < halfN; i++) {
+		float windowEven = 0.5f - 0.5f * rotation.real();
+		rotation *= step;
+		float windowOdd = 0.5f - 0.5f * rotation.real();
+		rotation *= step;
+
+		// Store at the bit reversed position so the FFT stages are in-place
+		size_t reversed = 0;
+		for(size_t bit = 0; bit < bits; bit++)
+			reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+
+		output[reversed] = std::complex<float>(input[2 * i] * windowEven, input[2 * i + 1] * windowOdd);
+	}
+}
+
+void SpectrumAnalyzer::computeFftStage() {
+	std::complex<float>* data = fftBuffer.get();
+	size_t n = size / 2;
+	size_t halfStage = fftStageSize / 2;
+	const std::complex<float> step = std::polar(1.0f, -2 * (float) M_PI / fftStageSize);
+
+	std::complex<float> twiddle = 1;
+	for(size_t j = 0; j < halfStage; j++) {
+		for(size_t k = j; k < n; k += fftStageSize) {
+			std::complex<float> t = twiddle * data[k + halfStage];
+			data[k + halfStage] = data[k] - t;
+			data[k] += t;
+		}
+		twiddle *= step;
+	}
+}
+
+void SpectrumAnalyzer::computeBands() {
+	const std::complex<float>* z = fftBuffer.get();
+	size_t n = size;
+	size_t halfN = n / 2;
+
+	// A full scale sine gives |X| = n / 4 with the Hann window
+	const float normalization = 16.0f / ((float) n * n);
+	const std::complex<float> step = std::polar(1.0f, -2 * (float) M_PI / n);
+
+	for(size_t band = 0; band < NUM_BANDS; band++) {
+		// A band narrower than one bin uses the bin at its start edge
+		size_t begin = std::min<size_t>(bandEdges[band], halfN - 1);
+		size_t end = std::max<size_t>(bandEdges[band + 1], begin + 1);
+		std::complex<float> twiddle = std::polar(1.0f, -2 * (float) M_PI * begin / n);
+		float power = bandPowers[band];
+
+		for(size_t k = begin; k < end; k++) {
+			// Unpack the real FFT bin from the half size complex FFT
+			std::complex<float> zk = z[k];
+			std::complex<float> zn = std::conj(z[halfN - k]);
+			std::complex<float> even = 0.5f * (zk + zn);
+			std::complex<float> odd = std::complex<float>(0, -0.5f) * (zk - zn);
+			std::complex<float> x = even + twiddle * odd;
+			twiddle *= step;
+
+			power = fmaxf(power, std::norm(x) * normalization);
+		}
+
+		bandPowers[band] = power;
+	}
+
+	bandPowersValid = true;
+}
+
+void SpectrumAnalyzer::onFastTimer() {
+	if(!bandPowersValid)
+		return;
+
+	uint8_t blob[NUM_BANDS];
+
+	for(size_t band = 0; band < NUM_BANDS; band++) {
+		float power = bandPowers[band];
+		// -2 * 10 * log10(power)
+		float level = power > 0 ? -6.0206f * fastlog2(power) : 255;
+		blob[band] = (uint8_t) std::clamp(level, 0.0f, 255.0f);
+	}
+
+	bandPowers.fill(0);
+	bandPowersValid = false;
+
+	oscBands.sendBlobMessage(blob, sizeof(blob));
+}
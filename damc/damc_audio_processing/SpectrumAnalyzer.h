@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Osc/OscContainer.h>
+#include <Osc/OscEndpoint.h>
+#include <Osc/OscVariable.h>
+#include <array>
+#include <atomic>
+#include <complex>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Spectrum analyser tap.
+ * The audio path only copies a mono downmix into a capture buffer. The Hann windowed FFT is computed from the main
+ * loop, one slice at a time (windowing, then one FFT stage per slice, then band extraction) so it never delays audio
+ * processing.
+ *
+ * Band powers are accumulated between two onFastTimer calls and sent as one blob of NUM_BANDS bytes on "bands".
+ * Bands are log spaced from MIN_FREQUENCY to fs/2, each byte is the band peak level as -dBFS * 2 (0 = 0 dBFS, 255 =
+ * -127.5 dBFS).
+ *
+ * Buffers are only allocated while the analyser is enabled.
+ */
+class SpectrumAnalyzer : public OscContainer {
+public:
+	static constexpr size_t NUM_BANDS = 32;
+	static constexpr float MIN_FREQUENCY = 20;
+
+	SpectrumAnalyzer(OscContainer* parent,
+	                 OscReadOnlyVariable<int32_t>* oscNumChannel,
+	                 OscReadOnlyVariable<int32_t>* oscSampleRate);
+
+	void processSamples(float** samples, size_t numChannel, size_t count);
+
+	// Do one step of the FFT computation, return false if there was nothing to do
+	bool processBackgroundSlice();
+
+	void onFastTimer();
+
+protected:
+	enum class State {
+		Disabled,
+		Capturing,
+		Windowing,
+		FftStage,
+		Bands,
+	};
+
+	void allocate();
+	void updateBandEdges();
+
+	void applyWindow();
+	void computeFftStage();
+	void computeBands();
+
+private:
+	OscVariable<bool> enable;
+	OscVariable<int32_t> size;
+	OscEndpoint oscBands;
+	OscReadOnlyVariable<int32_t>* oscSampleRate;
+
+	// Written by the audio path while Capturing, then by the main loop.
+	// Each side stores the state that hands the buffer over with release and loads it with acquire.
+	std::atomic<State> state{State::Disabled};
+	size_t captureIndex = 0;
+	std::unique_ptr<float[]> captureBuffer;
+
+	// FFT of size / 2 complex points with even samples as real part and odd samples as imaginary part
+	std::unique_ptr<std::complex<float>[]> fftBuffer;
+	size_t fftStageSize = 0;
+
+	std::array<uint16_t, NUM_BANDS + 1> bandEdges;
+	std::array<float, NUM_BANDS> bandPowers;
+	bool bandPowersValid = false;
+};
@@ -1,6 +1,20 @@
 #include "MathUtils.h"
+#include <Osc/OscReadOnlyVariable.h>
 
 #include <fastapprox/fastexp.h>
 #include <fastapprox/fastlog.h>
+#include <math.h>
 
 const float LOG10_VALUE_DIV_20 = fastlog2(10) / 20;
+
+float LogScaleFromOsc(float value) {
+	return fastpow2(value * LOG10_VALUE_DIV_20);
+}
+
+float LogScaleToOsc(float value) {
+	float logValue = fastlog2(value) / LOG10_VALUE_DIV_20;
+	logValue = roundf(logValue*100.f)/100.f;
+	return logValue;
+}
+
+const OscConverter<float> LogScaleOscConverter = {&LogScaleToOsc, &LogScaleFromOsc};
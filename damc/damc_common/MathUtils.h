@@ -1,3 +1,10 @@
 #pragma once
 
 extern const float LOG10_VALUE_DIV_20;
+
+template<typename T> struct OscConverter;
+
+// Convert between linear gain and dB for OSC variables
+float LogScaleFromOsc(float value);
+float LogScaleToOsc(float value);
+extern const OscConverter<float> LogScaleOscConverter;
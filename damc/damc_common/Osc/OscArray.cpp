@@ -11,11 +11,8 @@ OscArray<T>::OscArray(OscContainer* parent, std::string_view name, readonly_type
 	});
 }
 
-template<typename T>
-void OscArray<T>::setOscConverters(std::function<readonly_type(readonly_type)> convertToOsc,
-                                   std::function<readonly_type(readonly_type)> convertFromOsc) {
-	this->convertToOsc = convertToOsc;
-	this->convertFromOsc = convertFromOsc;
+template<typename T> void OscArray<T>::setOscConverters(const OscConverter<T>* converter) {
+	this->converter = converter;
 }
 
 template<typename T> void OscArray<T>::addChangeCallback(std::function<void(readonly_type)> onChangeCallbacks) {
@@ -23,8 +20,8 @@ template<typename T> void OscArray<T>::addChangeCallback(std::function<void(read
 }
 
 template<typename T> void OscArray<T>::initializeItem(OscVariable<T>* item) {
-	if(convertToOsc || convertFromOsc) {
-		item->setOscConverters(convertToOsc, convertFromOsc);
+	if(converter) {
+		item->setOscConverters(converter);
 	}
 	for(auto& callback : onChangeCallbacks) {
 		item->addChangeCallback(callback);
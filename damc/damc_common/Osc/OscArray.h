@@ -10,16 +10,14 @@ public:
 
 	OscArray(OscContainer* parent, std::string_view name, readonly_type defaultValue = {});
 
-	void setOscConverters(std::function<readonly_type(readonly_type)> convertToOsc,
-	                      std::function<readonly_type(readonly_type)> convertFromOsc);
+	void setOscConverters(const OscConverter<T>* converter);
 	void addChangeCallback(std::function<void(readonly_type)> onChangeCallbacks);
 
 protected:
 	void initializeItem(OscVariable<T>* item) override;
 
 private:
-	std::function<readonly_type(readonly_type)> convertToOsc;
-	std::function<readonly_type(readonly_type)> convertFromOsc;
+	const OscConverter<T>* converter = nullptr;
 	std::vector<std::function<void(readonly_type)>> onChangeCallbacks;
 };
 
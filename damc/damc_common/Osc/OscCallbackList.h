@@ -0,0 +1,75 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+template<typename Signature> class OscCallbackList;
+
+/**
+ * @brief Singly linked list of callbacks, each one allocated with the size of its callable.
+ * Variables usually have 0 to 2 callbacks: an empty list is a single pointer and each callback costs one allocation of
+ * its captures plus 2 pointers, instead of a vector and std::function storage.
+ */
+template<typename R, typename... Args> class OscCallbackList<R(Args...)> {
+public:
+	class Callback {
+	public:
+		virtual ~Callback() = default;
+		virtual R operator()(Args... args) = 0;
+
+	private:
+		friend class OscCallbackList;
+		Callback* next = nullptr;
+	};
+
+	class iterator {
+	public:
+		iterator(Callback* callback) : callback(callback) {}
+		Callback& operator*() const { return *callback; }
+		iterator& operator++() {
+			callback = callback->next;
+			return *this;
+		}
+		bool operator!=(const iterator& other) const { return callback != other.callback; }
+
+	private:
+		Callback* callback;
+	};
+
+	OscCallbackList() = default;
+	OscCallbackList(const OscCallbackList&) = delete;
+	OscCallbackList& operator=(const OscCallbackList&) = delete;
+	~OscCallbackList() {
+		while(head) {
+			Callback* next = head->next;
+			delete head;
+			head = next;
+		}
+	}
+
+	// Callbacks are called in insertion order
+	template<class F> Callback& add(F&& function) {
+		Callback** last = &head;
+		while(*last)
+			last = &(*last)->next;
+
+		*last = new CallbackImpl<std::decay_t<F>>(std::forward<F>(function));
+		return **last;
+	}
+
+	bool empty() const { return head == nullptr; }
+	iterator begin() const { return iterator(head); }
+	iterator end() const { return iterator(nullptr); }
+
+private:
+	template<class F> class CallbackImpl : public Callback {
+	public:
+		template<class U> CallbackImpl(U&& function) : function(std::forward<U>(function)) {}
+		R operator()(Args... args) override { return function(args...); }
+
+	private:
+		F function;
+	};
+
+	Callback* head = nullptr;
+};
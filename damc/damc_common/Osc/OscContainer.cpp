@@ -1,6 +1,7 @@
 #include "OscContainer.h"
 #include "Utils.h"
 #include <OscRoot.h>
+#include <algorithm>
 #include <spdlog/spdlog.h>
 
 bool OscContainer::osc_node_comparator::operator()(const std::string_view& x, const std::string_view& y) const {
@@ -20,14 +21,25 @@ bool OscContainer::osc_node_comparator::operator()(const std::string_view& x, co
 }
 
 OscContainer::OscContainer(OscContainer* parent, std::string_view name, size_t reserveSize) noexcept
-    : OscNode(parent, name), children(reserveSize), oscDump(this, "dump") {
-	oscDump.setCallback([this](auto) { dump(); });
+    : OscNode(parent, name), children(reserveSize), childIndex(reserveSize), oscDump(this, "dump") {
+	// Without argument, dump all values. With a sequence number, only values changed after it.
+	oscDump.setCallback([this](const std::vector<OscArgument>& arguments) {
+		int32_t sinceSequence = 0;
+		bool onlyChanged = !arguments.empty() && OscNode::getArgumentAs<int32_t>(arguments[0], sinceSequence);
+		getRoot()->requestDump(this, onlyChanged, sinceSequence);
+	});
 }
 
 OscContainer::~OscContainer() {
 	auto childrenToDetach = std::move(children);
+	OscRoot* root = getRoot();
 
 	for(auto& child : childrenToDetach) {
+		// Detached values are no longer part of the state of the root
+		if(root) {
+			for(OscNode* node = child; node; node = node->getNextNode(child))
+				root->replaceStateHash(node->getStateHash(), 0);
+		}
 		child->setOscParent(nullptr);
 	}
 }
@@ -72,11 +84,10 @@ void OscContainer::execute(std::string_view address, const std::vector<OscArgume
 				child->execute(address, arguments);
 			}
 		} else {
-			for(auto& child : children) {
-				if(child->getName() == childAddress) {
-					child->execute(remainingAddress, arguments);
-					return;
-				}
+			OscNode* child = findChild(childAddress);
+			if(child) {
+				child->execute(remainingAddress, arguments);
+				return;
 			}
 
 			SPDLOG_WARN("Address {} not found from {}", childAddressStr, getFullAddress());
@@ -84,6 +95,32 @@ void OscContainer::execute(std::string_view address, const std::vector<OscArgume
 	}
 }
 
+bool OscContainer::isAudioParameter(std::string_view address) const {
+	// The container itself and recursive wildcards are left to the main loop
+	if(address.empty() || address == "/")
+		return false;
+
+	std::string_view childAddress;
+	std::string_view remainingAddress;
+
+	splitAddress(address, &childAddress, &remainingAddress);
+
+	if(childAddress == "**")
+		return false;
+
+	if(childAddress == "*") {
+		for(const auto& child : children) {
+			if(!child->isAudioParameter(remainingAddress))
+				return false;
+		}
+		return true;
+	}
+
+	// Unknown addresses have no effect
+	OscNode* child = findChild(childAddress);
+	return !child || child->isAudioParameter(remainingAddress);
+}
+
 bool OscContainer::visit(const std::function<bool(OscNode*)>* nodeVisitorFunction) {
 	if(!OscNode::visit(nodeVisitorFunction))
 		return false;
@@ -135,7 +172,51 @@ std::string OscContainer::getAsString() const {
 	return result;
 }
 
+OscNode* OscContainer::getChildAfter(const OscNode* child) const {
+	for(size_t i = 0; i + 1 < children.size(); i++) {
+		if(children[i] == child)
+			return children[i + 1];
+	}
+	return nullptr;
+}
+
+void OscContainer::sendDumpEnd(uint32_t sequence) {
+	OscArgument argument = (int32_t) sequence;
+	oscDump.sendMessage(&argument, 1);
+}
+
+bool OscContainer::compareChildIndexEntry(const ChildIndexEntry& entry, uint32_t hash) {
+	return entry.hash < hash;
+}
+
+uint32_t OscContainer::hashName(std::string_view name) {
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	for(char c : name) {
+		hash ^= (uint8_t) c;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+OscNode* OscContainer::findChild(std::string_view name) const {
+	uint32_t hash = hashName(name);
+	auto it = std::lower_bound(childIndex.begin(), childIndex.end(), hash, compareChildIndexEntry);
+
+	// Names are only compared on a hash match
+	for(; it != childIndex.end() && it->hash == hash; ++it) {
+		if(it->node->getName() == name)
+			return it->node;
+	}
+
+	return nullptr;
+}
+
 void OscContainer::addChild(std::string_view name, OscNode* child) {
+	uint32_t hash = hashName(name);
+	auto it = std::lower_bound(childIndex.begin(), childIndex.end(), hash, compareChildIndexEntry);
+
+	childIndex.insert(it, ChildIndexEntry{hash, child});
 	children.push_back(child);
 }
 
@@ -144,8 +225,17 @@ void OscContainer::removeChild(OscNode* node, std::string_view name) {
 	if(root)
 		root->nodeRemoved(node);
 
+	uint32_t hash = hashName(name);
+	auto it = std::lower_bound(childIndex.begin(), childIndex.end(), hash, compareChildIndexEntry);
+	for(; it != childIndex.end() && it->hash == hash; ++it) {
+		if(it->node == node) {
+			childIndex.erase(it);
+			break;
+		}
+	}
+
 	for(size_t i = 0; i < children.size(); i++) {
-		if(children[i]->getName() == name) {
+		if(children[i] == node) {
 			children.erase(children.begin() + i);
 			return;
 		}
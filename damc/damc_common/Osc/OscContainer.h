@@ -26,15 +26,37 @@ public:
 	void addChild(std::string_view name, OscNode* child);
 	void removeChild(OscNode* node, std::string_view name);
 
-	void splitAddress(std::string_view address, std::string_view* childAddress, std::string_view* remainingAddress);
+	static void splitAddress(std::string_view address,
+	                         std::string_view* childAddress,
+	                         std::string_view* remainingAddress);
+	OscNode* findChild(std::string_view name) const;
+	OscNode* getFirstChild() const override { return children.empty() ? nullptr : children.front(); }
+	OscNode* getChildAfter(const OscNode* child) const;
+
+	// Reply to a dump request once all nodes are sent, with the change sequence number at the start of the dump
+	void sendDumpEnd(uint32_t sequence);
 
 	using OscNode::execute;
 	void execute(std::string_view address, const std::vector<OscArgument>& arguments) override;
+	bool isAudioParameter(std::string_view address) const override;
 	bool visit(const std::function<bool(OscNode*)>* nodeVisitorFunction) override;
 
 	std::string getAsString() const override;
 
+protected:
+	static uint32_t hashName(std::string_view name);
+
 private:
+	// Children in insertion order, for wildcards, visit and dump
 	PreallocatedVector<OscNode*> children;
+
+	// Children sorted by name hash for direct address lookup
+	struct ChildIndexEntry {
+		uint32_t hash;
+		OscNode* node;
+	};
+	PreallocatedVector<ChildIndexEntry> childIndex;
+	static bool compareChildIndexEntry(const ChildIndexEntry& entry, uint32_t hash);
+
 	OscEndpoint oscDump;
 };
@@ -14,6 +14,7 @@ public:
 	void dump() override { notifyOsc(); }
 
 	std::string getAsString() const override;
+	bool isTelemetry() const override { return true; }
 
 	void setReadCallback(std::function<std::vector<T>()> onReadCallback);
 
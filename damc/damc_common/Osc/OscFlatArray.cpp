@@ -9,6 +9,14 @@ EXPLICIT_INSTANCIATE_OSC_VARIABLE(template, OscFlatArray);
 template<typename T>
 OscFlatArray<T>::OscFlatArray(OscContainer* parent, std::string_view name) noexcept : OscContainer(parent, name) {
 	this->getRoot()->addPendingConfigNode(this);
+	refreshStateHash();
+}
+
+template<typename T> OscFlatArray<T>::~OscFlatArray() {
+	// Children of a removed container are detached from the root before being destroyed
+	OscRoot* root = getRoot();
+	if(root)
+		root->replaceStateHash(stateHash, 0);
 }
 
 template<typename T>
@@ -93,10 +101,23 @@ template<typename T> void OscFlatArray<T>::notifyOsc() {
 	sendMessage(&valueToSend[0], size);
 }
 
+template<typename T> void OscFlatArray<T>::refreshStateHash() {
+	size_t size = values.size();
+	OscArgument valueToHash[size];
+
+	for(size_t i = 0; i < size; i++) {
+		valueToHash[i] = values[i];
+	}
+	stateHash = updateStateHash(stateHash, &valueToHash[0], size);
+}
+
 template<typename T> bool OscFlatArray<T>::checkData(const std::vector<T>& savedValues, bool fromOsc) {
 	if(values != savedValues) {
 		bool isDataValid = callCheckCallbacks(values);
 		if(isDataValid) {
+			changeSequence = getRoot()->nextChangeSequence();
+			refreshStateHash();
+
 			for(auto& callback : onChangeCallbacks) {
 				callback(savedValues, values);
 			}
@@ -5,6 +5,7 @@
 template<typename T> class OscFlatArray : protected OscContainer {
 public:
 	OscFlatArray(OscContainer* parent, std::string_view name) noexcept;
+	~OscFlatArray() override;
 
 	void reserve(size_t reserveSize);
 	template<class U> bool updateData(const U& lambda, bool fromOsc = false);
@@ -13,6 +14,8 @@ public:
 	bool setData(std::vector<T>&& newData);
 
 	void dump() override { notifyOsc(); }
+	uint32_t getChangeSequence() const override { return changeSequence; }
+	uint32_t getStateHash() const override { return stateHash; }
 
 	std::string getAsString() const override;
 
@@ -26,11 +29,14 @@ public:
 protected:
 	void notifyOsc();
 	bool checkData(const std::vector<T>& savedValues, bool fromOsc);
+	void refreshStateHash();
 
 private:
 	std::vector<T> values;
 	std::vector<std::function<void(const std::vector<T>&, const std::vector<T>&)>> onChangeCallbacks;
 	std::vector<std::function<bool(const std::vector<T>&)>> checkCallbacks;
+	uint32_t changeSequence = 0;
+	uint32_t stateHash = 0;
 };
 
 EXPLICIT_INSTANCIATE_OSC_VARIABLE(extern template, OscFlatArray);
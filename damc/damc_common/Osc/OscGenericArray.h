@@ -40,6 +40,7 @@ public:
 	const auto& back() const { return value.crbegin()->second; }
 
 	void execute(std::string_view address, const std::vector<OscArgument>& arguments) override;
+	bool isAudioParameter(std::string_view address) const override;
 
 protected:
 	virtual void initializeItem(T*) {}
@@ -102,12 +103,8 @@ template<typename T> bool OscGenericArray<T>::contains(size_t index) const {
 }
 
 template<typename T> bool OscGenericArray<T>::containsStr(std::string_view indexStr) const {
-	for(const auto& item : value) {
-		if(item->getName() == indexStr) {
-			return true;
-		}
-	}
-	return false;
+	// Items are the only children with a numeric name
+	return this->findChild(indexStr) != nullptr;
 }
 
 template<typename T> int32_t OscGenericArray<T>::getNextKey() {
@@ -165,6 +162,18 @@ void OscGenericArray<T>::execute(std::string_view address, const std::vector<Osc
 	OscContainer::execute(address, arguments);
 }
 
+template<typename T> bool OscGenericArray<T>::isAudioParameter(std::string_view address) const {
+	std::string_view childAddress;
+
+	splitAddress(address, &childAddress, nullptr);
+
+	// A missing item is created by direct access
+	if(!childAddress.empty() && Utils::isNumber(childAddress) && !containsStr(childAddress))
+		return false;
+
+	return OscContainer::isAudioParameter(address);
+}
+
 template<typename T> void OscGenericArray<T>::updateNextKeyToMaxKey() {
 	int32_t maxKey = 0;
 	for(const auto& item : value) {
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <limits>
+#include <stddef.h>
+#include <stdint.h>
+#include <string_view>
+
+// How the processing applies a new value, for clients sending continuous changes (sliders)
+enum class OscSmoothing : uint8_t {
+	None,  // Applied as is at the next audio block, large steps can be audible
+	Smoothed,  // The processing ramps to the new value
+};
+
+/**
+ * @brief Optional description of a value for host tools, exported by "/schema".
+ * Instances are constexpr (in flash) and shared by all values of the same kind. The range is in the OSC representation
+ * of the value (after converters) and values set outside of it are clamped.
+ */
+struct OscMetadata {
+	float minValue;
+	float maxValue;
+	std::string_view unit;
+	// Comma separated labels of the values minValue, minValue + 1, ... of an enum
+	std::string_view enumLabels;
+	OscSmoothing smoothing;
+};
+
+// Unbounded side of a range
+constexpr float OSC_NO_LIMIT = std::numeric_limits<float>::max();
+
+constexpr OscMetadata oscRange(float minValue,
+                               float maxValue,
+                               std::string_view unit = {},
+                               OscSmoothing smoothing = OscSmoothing::None) {
+	return OscMetadata{minValue, maxValue, unit, {}, smoothing};
+}
+
+constexpr OscMetadata oscUnit(std::string_view unit, OscSmoothing smoothing = OscSmoothing::None) {
+	return OscMetadata{-OSC_NO_LIMIT, OSC_NO_LIMIT, unit, {}, smoothing};
+}
+
+// Enum values from 0 to the number of labels - 1
+constexpr OscMetadata oscEnum(std::string_view labels) {
+	float maxValue = 0;
+	for(char c : labels) {
+		if(c == ',')
+			maxValue++;
+	}
+	return OscMetadata{0, maxValue, {}, labels, OscSmoothing::None};
+}
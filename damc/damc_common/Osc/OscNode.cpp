@@ -2,12 +2,14 @@
 #include "OscContainer.h"
 #include "OscRoot.h"
 #include <spdlog/spdlog.h>
+#include <string.h>
 #include <string_view>
 
 template bool OscNode::getArgumentAs<bool>(const OscArgument& argument, bool& v);
 template bool OscNode::getArgumentAs<int32_t>(const OscArgument& argument, int32_t& v);
 template bool OscNode::getArgumentAs<float>(const OscArgument& argument, float& v);
 template bool OscNode::getArgumentAs<std::string_view>(const OscArgument& argument, std::string_view& v);
+template bool OscNode::getArgumentAs<std::string>(const OscArgument& argument, std::string& v);
 
 OscNode::OscNode(OscContainer* parent, std::string_view name) noexcept : name(name), parent(nullptr) {
 	setOscParent(parent);
@@ -26,7 +28,11 @@ template<typename T> bool OscNode::getArgumentAs(const OscArgument& argument, T&
 		    if constexpr(std::is_same_v<U, T>) {
 			    v = arg;
 			    ret = true;
-		    } else if constexpr(!std::is_same_v<U, std::string_view> && !std::is_same_v<T, std::string_view>) {
+		    } else if constexpr(std::is_same_v<U, std::string_view> && std::is_same_v<T, std::string>) {
+			    v = arg;
+			    ret = true;
+		    } else if constexpr(!std::is_same_v<U, std::string_view> && !std::is_same_v<T, std::string_view> &&
+		                        !std::is_same_v<T, std::string>) {
 			    v = (T) arg;
 			    ret = true;
 		    }
@@ -56,6 +62,13 @@ void OscNode::setOscParent(OscContainer* parent) {
 		parent->addChild(name, this);
 	}
 	this->parent = parent;
+
+	// The address of this node and all its children changed
+	std::function<bool(OscNode*)> invalidateFunction = [](OscNode* node) {
+		node->invalidateMessageHeader();
+		return true;
+	};
+	visit(&invalidateFunction);
 }
 
 size_t OscNode::constructFullName(std::string* outputString) const {
@@ -83,6 +96,59 @@ void OscNode::getFullAddress(std::string* output) const {
 	constructFullName(output);
 }
 
+uint32_t OscNode::getAddressHash() const {
+	using namespace std::literals;
+
+	uint32_t hash = parent ? parent->getAddressHash() : ADDRESS_HASH_INIT;
+
+	if(!name.empty())
+		hash = hashAddress(name, hashAddress("/"sv, hash));
+
+	return hash;
+}
+
+std::string_view OscNode::getMessageHeader(const char* format, std::string* addressBuffer) {
+	size_t formatLength = strlen(format);
+	size_t formatSize = (formatLength + 4) & ~0x3;
+
+	// Same padded size, so the cached format has room for the terminating NUL compared here (format has no padding)
+	if(messageHeaderSize && messageHeaderSize == messageHeaderAddressSize + formatSize &&
+	   memcmp(&messageHeader[messageHeaderAddressSize], format, formatLength + 1) == 0) {
+		return std::string_view(messageHeader, messageHeaderSize);
+	}
+
+	getFullAddress(addressBuffer);
+	size_t addressSize = (addressBuffer->size() + 4) & ~0x3;
+	size_t headerSize = addressSize + formatSize;
+
+	// A header with more type tags reuses the storage of the previous one when it fits
+	if(headerSize > messageHeaderCapacity) {
+		char* storage = getRoot()->allocateMessageHeader(headerSize);
+		if(!storage) {
+			invalidateMessageHeader();
+			return {};
+		}
+		messageHeader = storage;
+		messageHeaderCapacity = headerSize;
+	}
+
+	memset(messageHeader, 0, headerSize);
+	memcpy(&messageHeader[0], addressBuffer->data(), addressBuffer->size());
+	memcpy(&messageHeader[addressSize], format, formatLength);
+	messageHeaderAddressSize = addressSize;
+	messageHeaderSize = headerSize;
+
+	return std::string_view(messageHeader, messageHeaderSize);
+}
+
+void OscNode::invalidateMessageHeader() {
+	// The storage is not reused: after a move the node may not be in the root it was allocated from anymore
+	messageHeader = nullptr;
+	messageHeaderCapacity = 0;
+	messageHeaderAddressSize = 0;
+	messageHeaderSize = 0;
+}
+
 bool OscNode::visit(const std::function<bool(OscNode*)>* nodeVisitorFunction) {
 	if(nodeVisitorFunction) {
 		SPDLOG_DEBUG("Executing address {}", getFullAddress());
@@ -93,16 +159,83 @@ bool OscNode::visit(const std::function<bool(OscNode*)>* nodeVisitorFunction) {
 	return true;
 }
 
+OscNode* OscNode::getNextNode(const OscNode* root) const {
+	OscNode* child = getFirstChild();
+	if(child)
+		return child;
+
+	// Next sibling of this node or of its nearest ancestor having one
+	const OscNode* node = this;
+	while(node != root && node->parent) {
+		OscNode* sibling = node->parent->getChildAfter(node);
+		if(sibling)
+			return sibling;
+		node = node->parent;
+	}
+
+	return nullptr;
+}
+
+bool OscNode::isInSubtreeOf(const OscNode* node) const {
+	for(const OscNode* ancestor = this; ancestor; ancestor = ancestor->parent) {
+		if(ancestor == node)
+			return true;
+	}
+	return false;
+}
+
 void OscNode::sendMessage(const OscArgument* arguments, size_t number) {
 	getRoot()->sendMessage(this, arguments, number);
 }
 
+void OscNode::sendMessage(std::string_view subAddress, const OscArgument* arguments, size_t number) {
+	getRoot()->sendMessage(this, arguments, number, subAddress);
+}
+
+void OscNode::sendBlobMessage(const uint8_t* data, size_t size) {
+	getRoot()->sendBlobMessage(this, data, size);
+}
+
 void OscNode::execute(std::string_view address, const std::vector<OscArgument>& arguments) {
 	if(address.empty() || address == "/") {
 		execute(arguments);
 	}
 }
 
+uint32_t OscNode::hashState(uint32_t addressHash, const OscArgument* arguments, size_t number) {
+	uint32_t hash = addressHash;
+
+	for(size_t i = 0; i < number; i++) {
+		std::visit(
+		    [&hash](auto&& arg) -> void {
+			    using U = std::decay_t<decltype(arg)>;
+			    if constexpr(std::is_same_v<U, bool>) {
+				    hash = hashAddress(arg ? "T" : "F", hash);
+			    } else if constexpr(std::is_same_v<U, int32_t> || std::is_same_v<U, float>) {
+				    uint8_t bytes[sizeof(arg)];
+				    memcpy(bytes, &arg, sizeof(arg));
+				    hash = hashAddress(std::is_same_v<U, int32_t> ? "i" : "f", hash);
+				    hash = hashAddress(std::string_view((const char*) bytes, sizeof(bytes)), hash);
+			    } else if constexpr(std::is_same_v<U, std::string_view>) {
+				    hash = hashAddress("s", hash);
+				    hash = hashAddress(arg, hash);
+				    hash = hashAddress(std::string_view("", 1), hash);
+			    } else {
+				    static_assert(always_false_v<U>, "Unhandled type");
+			    }
+		    },
+		    arguments[i]);
+	}
+
+	return hash;
+}
+
+uint32_t OscNode::updateStateHash(uint32_t previousHash, const OscArgument* arguments, size_t number) {
+	uint32_t hash = hashState(getAddressHash(), arguments, number);
+	getRoot()->replaceStateHash(previousHash, hash);
+	return hash;
+}
+
 OscRoot* OscNode::getRoot() {
 	if(parent)
 		return parent->getRoot();
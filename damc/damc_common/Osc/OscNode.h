@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <type_traits>
@@ -77,33 +78,104 @@ public:
 
 	void setOscParent(OscContainer* parent);
 	void getFullAddress(std::string* output) const;
+	// Hash of the full address, computed without building it
+	uint32_t getAddressHash() const;
 	const std::string_view& getName() const { return name; }
 	virtual void dump() {}
+	// Send the value at subAddress (empty for the value of this node), for changes made by the audio processing and
+	// sent by the main loop
+	virtual void notifyValue(std::string_view subAddress) { dump(); }
+	// Send the metadata of the values of this node with OscRoot::sendSchema, if they have some
+	virtual void dumpSchema() {}
 
 	virtual bool visit(const std::function<bool(OscNode*)>* nodeVisitorFunction);
+
+	// Resumable depth first traversal of the subtree of root, without recursion. Return nullptr at the end.
+	OscNode* getNextNode(const OscNode* root) const;
+	virtual OscNode* getFirstChild() const { return nullptr; }
+	// True if node is this node or one of its ancestors
+	bool isInSubtreeOf(const OscNode* node) const;
+
+	// Sequence number of the last value change (OscRoot::nextChangeSequence), to dump only changed values
+	virtual uint32_t getChangeSequence() const { return 0; }
+	// Contribution of this node to the state checksum (OscRoot::getStateChecksum), 0 for non value nodes
+	virtual uint32_t getStateHash() const { return 0; }
 	virtual void execute(std::string_view address, const std::vector<OscArgument>& arguments);
+	// True if executing address only sets parameter values (no allocation, no node added or removed, no request), so
+	// the audio processing can execute it between blocks. Sub-addresses without effect are parameters.
+	virtual bool isAudioParameter(std::string_view address) const { return !address.empty() && address != "/"; }
 
 	virtual OscRoot* getRoot();
 
 	virtual std::string getAsString() const = 0;
 
+	// Telemetry messages (meters, ...) only keep their latest value until sent and are dropped when a client can't keep
+	// up
+	virtual bool isTelemetry() const { return false; }
+
+	// Persistent configuration, implemented by configurable variables (one value) and schema containers (one value per
+	// schema entry, with the address hash of the entry).
+	// getConfigValue returns false when the value is the default one.
+	virtual bool isConfigNode() const { return false; }
+	virtual size_t getConfigValueNumber() const { return isConfigNode() ? 1 : 0; }
+	virtual uint32_t getConfigAddressHash(size_t index) const { return getAddressHash(); }
+	virtual bool getConfigValue(size_t index, OscArgument* value) const { return false; }
+	virtual void setConfigValue(size_t index, const OscArgument& value) {}
+
 	// Called from derived types when their value is changed
 	void sendMessage(const OscArgument* arguments, size_t number);
+	// Send a message to a sub-address of this node, for values without their own node
+	void sendMessage(std::string_view subAddress, const OscArgument* arguments, size_t number);
+	// Send a single blob argument (for compact binary telemetry)
+	void sendBlobMessage(const uint8_t* data, size_t size);
 
 protected:
 	friend class OscRoot;  // OscRoot calls execute on loadConfig
 
 	size_t constructFullName(std::string* outputString) const;
 
+	// OSC padded address followed by the padded type tags, cached for telemetry nodes which send the same header
+	// repeatedly. The cache is rebuilt when the type tags change and dropped when the node address changes.
+	// Its storage comes from OscRoot::allocateMessageHeader, an empty header is returned when there is no room left.
+	// addressBuffer is used to build the address.
+	std::string_view getMessageHeader(const char* format, std::string* addressBuffer);
+	void invalidateMessageHeader();
+
+	// Replace the contribution of this value node to the state checksum of the root, return the new state hash
+	uint32_t updateStateHash(uint32_t previousHash, const OscArgument* arguments, size_t number);
+
 	// Called by the public execute to really execute the action on this node (rather than descending through the tree
 	// of nodes)
 	virtual void execute(const std::vector<OscArgument>&) {}
 
 	static constexpr const char* KEYS_NODE = "keys";
 
+public:
+	// FNV-1a, can be computed at compile time for full addresses or incrementally for each part of an address
+	static constexpr uint32_t ADDRESS_HASH_INIT = 2166136261u;
+	static constexpr uint32_t hashAddress(std::string_view address, uint32_t hash = ADDRESS_HASH_INIT) {
+		for(char c : address) {
+			hash ^= (uint8_t) c;
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	// Hash of a state value, continuing the FNV-1a of its address (getAddressHash): for each argument, its OSC type tag
+	// then its value (int32 and float: 4 bytes little endian, bool: nothing, string: bytes with the null terminator)
+	static uint32_t hashState(uint32_t addressHash, const OscArgument* arguments, size_t number);
+
 private:
 	std::string_view name;
 	OscContainer* parent;
+
+	char* messageHeader = nullptr;
+	uint16_t messageHeaderCapacity = 0;
+	uint16_t messageHeaderAddressSize = 0;
+	uint16_t messageHeaderSize = 0;
+
+	// Intrusive list of nodes waiting for their configuration value, managed by OscRoot. nullptr when not in the list.
+	OscNode* nextPendingConfig = nullptr;
 };
 
 extern template bool OscNode::getArgumentAs<bool>(const OscArgument& argument, bool& v);
@@ -1,25 +1,45 @@
 #include "OscReadOnlyVariable.h"
 #include "OscRoot.h"
+#include <algorithm>
+#include <math.h>
 #include <spdlog/spdlog.h>
 
 EXPLICIT_INSTANCIATE_OSC_VARIABLE(template, OscReadOnlyVariable)
 
 template<typename T>
 OscReadOnlyVariable<T>::OscReadOnlyVariable(OscContainer* parent, std::string_view name, readonly_type initialValue)
-    : OscContainer(parent, name), value(initialValue), isDefaultValue(true) {
+    : OscNode(parent, name), value(initialValue), isDefaultValue(true) {
+	refreshStateHash();
 	if(getRoot()->isOscValueAuthority())
 		notifyOsc();
 }
 
+template<typename T> OscReadOnlyVariable<T>::~OscReadOnlyVariable() {
+	// Children of a removed container are detached from the root before being destroyed
+	OscRoot* root = getRoot();
+	if(root)
+		root->replaceStateHash(stateHash, 0);
+}
+
 template<typename T> void OscReadOnlyVariable<T>::set(readonly_type v, bool fromOsc) {
 	if(value != v || isDefaultValue) {
+		readonly_type requestedValue = v;
 		bool isDataValid = callCheckCallbacks(v);
-		if(isDataValid) {
+		bool isClamped = v != requestedValue;
+		if(isDataValid && (value != v || isDefaultValue)) {
 			SPDLOG_INFO("{}: set to {}", getFullAddress(), v);
 			isDefaultValue = false;
 			value = v;
+			changeSequence = getRoot()->nextChangeSequence();
+			refreshStateHash();
+			if(isConfigNode())
+				getRoot()->notifyValueChanged();
 			callChangeCallbacks(v);
-			if(!fromOsc || getRoot()->isOscValueAuthority())
+			if(!fromOsc || isClamped || getRoot()->isOscValueAuthority())
+				notifyOsc();
+		} else if(isDataValid) {
+			// Clamped to the current value
+			if(fromOsc)
 				notifyOsc();
 		} else {
 			SPDLOG_WARN("{}: refused invalid value {}", getFullAddress(), v);
@@ -56,23 +76,9 @@ template<typename T> OscReadOnlyVariable<T>& OscReadOnlyVariable<T>::operator=(c
 	return *this;
 }
 
-template<typename T>
-void OscReadOnlyVariable<T>::setOscConverters(std::function<readonly_type(readonly_type)> convertToOsc,
-                                              std::function<readonly_type(readonly_type)> convertFromOsc) {
-	this->convertToOsc = convertToOsc;
-	this->convertFromOsc = convertFromOsc;
-}
-
-template<typename T> void OscReadOnlyVariable<T>::addCheckCallback(std::function<bool(readonly_type)> checkCallback) {
-	this->checkCallbacks.push_back(checkCallback);
-	checkCallback(this->get());
-}
-
-template<typename T> void OscReadOnlyVariable<T>::addChangeCallback(std::function<void(readonly_type)> onChange) {
-	if(this->onChangeCallbacks.empty())
-		this->onChangeCallbacks.reserve(2);
-	this->onChangeCallbacks.push_back(onChange);
-	onChange(this->get());
+template<typename T> void OscReadOnlyVariable<T>::setOscConverters(const OscConverter<T>* converter) {
+	this->converter = converter;
+	refreshStateHash();
 }
 
 template<typename T> void OscReadOnlyVariable<T>::callChangeCallbacks(readonly_type v) {
@@ -81,7 +87,27 @@ template<typename T> void OscReadOnlyVariable<T>::callChangeCallbacks(readonly_t
 	}
 }
 
-template<typename T> bool OscReadOnlyVariable<T>::callCheckCallbacks(readonly_type v) {
+template<typename T> bool OscReadOnlyVariable<T>::callCheckCallbacks(readonly_type& v) {
+	if constexpr(std::is_same_v<T, float> || std::is_same_v<T, int32_t>) {
+		if(metadata) {
+			if constexpr(std::is_same_v<T, float>) {
+				if(isnan(v))
+					return false;
+			}
+
+			// The range is in the OSC representation, converters are increasing functions.
+			// Unbounded sides are skipped, converters may not handle the largest values.
+			if(metadata->minValue != -OSC_NO_LIMIT) {
+				T minValue = toRangeBound(metadata->minValue);
+				v = std::max(v, converter ? converter->fromOsc(minValue) : minValue);
+			}
+			if(metadata->maxValue != OSC_NO_LIMIT) {
+				T maxValue = toRangeBound(metadata->maxValue);
+				v = std::min(v, converter ? converter->fromOsc(maxValue) : maxValue);
+			}
+		}
+	}
+
 	bool isDataValid = true;
 	for(auto& callback : checkCallbacks) {
 		isDataValid = isDataValid && callback(v);
@@ -89,21 +115,88 @@ template<typename T> bool OscReadOnlyVariable<T>::callCheckCallbacks(readonly_ty
 	return isDataValid;
 }
 
+template<typename T>
+void OscReadOnlyVariable<T>::execute(std::string_view address, const std::vector<OscArgument>& arguments) {
+	if(address.empty() || address == "/") {
+		OscNode::execute(address, arguments);
+	} else if(!executeSubEndpoint(address, arguments)) {
+		SPDLOG_WARN("Address {} not found from {}", address, getFullAddress());
+	}
+}
+
+template<typename T>
+bool OscReadOnlyVariable<T>::executeSubEndpoint(std::string_view name, const std::vector<OscArgument>& arguments) {
+	if(name == "dump") {
+		dump();
+		return true;
+	}
+
+	return false;
+}
+
+template<typename T> void OscReadOnlyVariable<T>::dumpSchema() {
+	if(!metadata)
+		return;
+
+	char type;
+	if constexpr(std::is_same_v<T, bool>)
+		type = 'T';
+	else if constexpr(std::is_same_v<T, int32_t>)
+		type = 'i';
+	else if constexpr(std::is_same_v<T, float>)
+		type = 'f';
+	else
+		type = 's';
+
+	getRoot()->sendSchema(this, {}, type, *metadata);
+}
+
+template<typename T> T OscReadOnlyVariable<T>::toRangeBound(float bound) {
+	if constexpr(std::is_same_v<T, int32_t>) {
+		// Saturate unbounded sides instead of overflowing
+		if(bound <= (float) INT32_MIN)
+			return INT32_MIN;
+		if(bound >= (float) INT32_MAX)
+			return INT32_MAX;
+		return (int32_t) bound;
+	} else if constexpr(std::is_same_v<T, float>) {
+		return bound;
+	} else {
+		return T{};
+	}
+}
+
+template<typename T> std::string OscReadOnlyVariable<T>::getAsString() const {
+	if(isDefault())
+		return {};
+
+	if constexpr(std::is_same_v<T, std::string>) {
+		return "\"" + std::string(getToOsc()) + "\"";
+	} else {
+		return std::to_string(getToOsc());
+	}
+}
+
 template<typename T> void OscReadOnlyVariable<T>::notifyOsc() {
 	OscArgument valueToSend = getToOsc();
 	sendMessage(&valueToSend, 1);
 }
 
+template<typename T> void OscReadOnlyVariable<T>::refreshStateHash() {
+	OscArgument valueToSend = getToOsc();
+	stateHash = updateStateHash(stateHash, &valueToSend, 1);
+}
+
 template<typename T> typename OscReadOnlyVariable<T>::readonly_type OscReadOnlyVariable<T>::getToOsc() const {
-	if(!convertToOsc)
+	if(!converter)
 		return get();
 	else
-		return convertToOsc(get());
+		return converter->toOsc(get());
 }
 
 template<typename T> void OscReadOnlyVariable<T>::setFromOsc(readonly_type value) {
-	if(!convertFromOsc)
+	if(!converter)
 		set(value, true);
 	else
-		set(convertFromOsc(value), true);
+		set(converter->fromOsc(value), true);
 }
@@ -1,21 +1,37 @@
 #pragma once
 
+#include "OscCallbackList.h"
 #include "OscContainer.h"
-#include <functional>
+#include "OscMetadata.h"
 #include <stdint.h>
 #include <string>
 #include <vector>
 
-template<typename T> class OscReadOnlyVariable : protected OscContainer {
+// Conversion between a stored value and its OSC representation. Tables are static and shared by all variables using
+// the same conversion.
+template<typename T> struct OscConverter {
+	using readonly_type = typename OscReadOnlyType<T>::type;
+
+	readonly_type (*toOsc)(readonly_type);
+	readonly_type (*fromOsc)(readonly_type);
+};
+
+/**
+ * @brief Value node, a leaf of the tree.
+ * Sub-addresses ("dump" here, "increment", ... in OscVariable) are handled by executeSubEndpoint instead of child
+ * nodes, so a variable only costs its own object and the allocations of its callbacks.
+ */
+template<typename T> class OscReadOnlyVariable : protected OscNode {
 public:
 	using underlying_type = T;
 	using readonly_type = typename OscReadOnlyType<T>::type;
 
-	using OscContainer::getFullAddress;
-	using OscContainer::getName;
+	using OscNode::getFullAddress;
+	using OscNode::getName;
 
 	OscReadOnlyVariable(OscContainer* parent, std::string_view name, readonly_type initialValue = {});
 	OscReadOnlyVariable(const OscReadOnlyVariable&) = delete;
+	~OscReadOnlyVariable() override;
 
 	void set(readonly_type v, bool fromOsc = false);
 	void setDefault(readonly_type v);
@@ -29,8 +45,10 @@ public:
 
 	operator T() const { return value; }
 	void dump() override { notifyOsc(); }
+	void dumpSchema() override;
+	uint32_t getChangeSequence() const override { return changeSequence; }
+	uint32_t getStateHash() const override { return stateHash; }
 
-	using OscContainer::operator=;
 	OscReadOnlyVariable& operator=(readonly_type v);
 	OscReadOnlyVariable& operator=(const OscReadOnlyVariable<T>& v);
 
@@ -39,33 +57,61 @@ public:
 	bool operator==(const OscReadOnlyVariable<T>& other) { return value == other.value; }
 	bool operator!=(const OscReadOnlyVariable<T>& other) { return !(*this == other); }
 
-	void setOscConverters(std::function<readonly_type(readonly_type)> convertToOsc,
-	                      std::function<readonly_type(readonly_type)> convertFromOsc);
+	// converter must stay valid as long as the variable, nullptr to send the raw value
+	void setOscConverters(const OscConverter<T>* converter);
+	// metadata must stay valid as long as the variable (constexpr). Numbers are then clamped to its range.
+	void setMetadata(const OscMetadata* metadata) { this->metadata = metadata; }
+	const OscMetadata* getMetadata() const { return metadata; }
 
-	void addCheckCallback(std::function<bool(readonly_type)> onChange);
-	void addChangeCallback(std::function<void(readonly_type)> onChange);
+	// Callbacks are called once when added
+	template<class F> void addCheckCallback(F&& checkCallback);
+	template<class F> void addChangeCallback(F&& onChange);
 
 	void callChangeCallbacks(readonly_type v);
-	bool callCheckCallbacks(readonly_type v);
+	// Clamp v to the range of the metadata, then return false if a check callback refuses it
+	bool callCheckCallbacks(readonly_type& v);
+
+	using OscNode::execute;
+	void execute(std::string_view address, const std::vector<OscArgument>& arguments) override;
+	// Only "dump" has an effect on a read-only value
+	bool isAudioParameter(std::string_view address) const override { return address != "dump"; }
+
+	// Empty when the value is the default one
+	std::string getAsString() const override;
 
 protected:
+	// Return false if name is not a sub-endpoint of this variable
+	virtual bool executeSubEndpoint(std::string_view name, const std::vector<OscArgument>& arguments);
+
 	void notifyOsc();
+	static T toRangeBound(float bound);
 
 	readonly_type getToOsc() const;
 	void setFromOsc(readonly_type value);
+	void refreshStateHash();
 
 private:
 	T value{};
 
-	std::function<readonly_type(readonly_type)> convertToOsc;
-	std::function<readonly_type(readonly_type)> convertFromOsc;
-	std::vector<std::function<bool(readonly_type)>> checkCallbacks;
-	std::vector<std::function<void(readonly_type)>> onChangeCallbacks;
+	const OscConverter<T>* converter = nullptr;
+	const OscMetadata* metadata = nullptr;
+	OscCallbackList<bool(readonly_type)> checkCallbacks;
+	OscCallbackList<void(readonly_type)> onChangeCallbacks;
 	bool isDefaultValue;
+	uint32_t changeSequence = 0;
+	uint32_t stateHash = 0;
 };
 
 EXPLICIT_INSTANCIATE_OSC_VARIABLE(extern template, OscReadOnlyVariable)
 
+template<typename T> template<class F> void OscReadOnlyVariable<T>::addCheckCallback(F&& checkCallback) {
+	checkCallbacks.add(std::forward<F>(checkCallback))(this->get());
+}
+
+template<typename T> template<class F> void OscReadOnlyVariable<T>::addChangeCallback(F&& onChange) {
+	onChangeCallbacks.add(std::forward<F>(onChange))(this->get());
+}
+
 template<typename T>
 template<typename U>
 std::enable_if_t<std::is_same_v<U, std::string>, OscReadOnlyVariable<T>&> OscReadOnlyVariable<T>::operator=(
@@ -0,0 +1,329 @@
+#include "OscSchemaNode.h"
+#include "OscRoot.h"
+#include <algorithm>
+#include <math.h>
+#include <spdlog/spdlog.h>
+
+OscSchemaNode::OscSchemaNode(
+    OscContainer* parent, std::string_view name, const OscSchemaEntry* entries, size_t count, void* values)
+    : OscNode(parent, name), entries(entries), values((uint8_t*) values), count((uint8_t) count) {}
+
+OscSchemaNode::~OscSchemaNode() {
+	// Children of a removed container are detached from the root before being destroyed
+	OscRoot* root = getRoot();
+	if(root)
+		root->replaceStateHash(stateHash, 0);
+}
+
+void OscSchemaNode::initValues() {
+	OscRoot* root = getRoot();
+
+	for(size_t i = 0; i < count; i++) {
+		const OscSchemaEntry& entry = entries[i];
+		switch(entry.type) {
+			case OscSchemaType::Bool:
+				storeValue(entry, entry.defaultValue.boolValue);
+				break;
+			case OscSchemaType::Int32:
+				storeValue(entry, entry.defaultValue.int32Value);
+				break;
+			case OscSchemaType::Float:
+				storeValue(entry, entry.defaultValue.floatValue);
+				break;
+		}
+
+		uint32_t hash = getEntryStateHash(i);
+		stateHash ^= hash;
+		root->replaceStateHash(0, hash);
+
+		onValueChanged(i);
+	}
+
+	root->addPendingConfigNode(this);
+
+	if(root->isOscValueAuthority())
+		dump();
+}
+
+size_t OscSchemaNode::findEntry(std::string_view name) const {
+	uint32_t nameHash = hashAddress(name);
+
+	for(size_t i = 0; i < count; i++) {
+		if(entries[i].nameHash == nameHash && entries[i].name == name)
+			return i;
+	}
+
+	return count;
+}
+
+void OscSchemaNode::storeValue(const OscSchemaEntry& entry, const OscArgument& value) {
+	uint8_t* storage = values + entry.offset;
+
+	switch(entry.type) {
+		case OscSchemaType::Bool:
+			*(bool*) storage = std::get<bool>(value);
+			break;
+		case OscSchemaType::Int32:
+			*(int32_t*) storage = std::get<int32_t>(value);
+			break;
+		case OscSchemaType::Float:
+			*(float*) storage = std::get<float>(value);
+			break;
+	}
+}
+
+OscArgument OscSchemaNode::getValue(size_t index) const {
+	const OscSchemaEntry& entry = entries[index];
+	const uint8_t* value = values + entry.offset;
+
+	switch(entry.type) {
+		case OscSchemaType::Bool:
+			return *(const bool*) value;
+		case OscSchemaType::Int32:
+			return *(const int32_t*) value;
+		case OscSchemaType::Float:
+		default:
+			return *(const float*) value;
+	}
+}
+
+void OscSchemaNode::setValue(size_t index, const OscArgument& value, bool fromOsc) {
+	const OscSchemaEntry& entry = entries[index];
+	OscArgument newValue;
+	bool clamped = false;
+
+	switch(entry.type) {
+		case OscSchemaType::Bool: {
+			bool v;
+			if(!getArgumentAs<bool>(value, v))
+				return;
+			newValue = v;
+			break;
+		}
+		case OscSchemaType::Int32: {
+			int32_t v;
+			if(!getArgumentAs<int32_t>(value, v))
+				return;
+			int32_t clampedValue = std::clamp(v, entry.minValue.int32Value, entry.maxValue.int32Value);
+			clamped = clampedValue != v;
+			newValue = clampedValue;
+			break;
+		}
+		case OscSchemaType::Float: {
+			float v;
+			if(!getArgumentAs<float>(value, v))
+				return;
+			if(isnan(v)) {
+				SPDLOG_WARN("{}/{}: refused invalid value {}", getFullAddress(), entry.name, v);
+				if(fromOsc)
+					notifyOsc(index);
+				return;
+			}
+			float clampedValue = std::clamp(v, entry.minValue.floatValue, entry.maxValue.floatValue);
+			clamped = clampedValue != v;
+			newValue = clampedValue;
+			break;
+		}
+	}
+
+	uint32_t modifiedBit = 1 << index;
+	if(newValue == getValue(index) && (modifiedMask & modifiedBit)) {
+		// The client that set this must know the value it sent was not applied
+		if(fromOsc && clamped)
+			notifyOsc(index);
+		return;
+	}
+
+	SPDLOG_INFO("{}/{}: set to {}", getFullAddress(), entry.name, OscRoot::getArgumentVectorAsString(&newValue, 1));
+
+	uint32_t previousHash = getEntryStateHash(index);
+	storeValue(entry, newValue);
+	modifiedMask |= modifiedBit;
+
+	OscRoot* root = getRoot();
+	changeSequence = root->nextChangeSequence();
+	uint32_t hash = getEntryStateHash(index);
+	stateHash ^= previousHash ^ hash;
+	root->replaceStateHash(previousHash, hash);
+	root->notifyValueChanged();
+
+	onValueChanged(index);
+
+	if(!fromOsc || clamped || root->isOscValueAuthority())
+		notifyOsc(index);
+}
+
+void OscSchemaNode::execute(std::string_view address, const std::vector<OscArgument>& arguments) {
+	if(address.empty() || address == "/") {
+		OscNode::execute(address, arguments);
+		return;
+	}
+
+	std::string_view name = address;
+	std::string_view subAddress;
+	size_t nextSlash = address.find('/');
+	if(nextSlash != std::string_view::npos) {
+		name = address.substr(0, nextSlash);
+		subAddress = address.substr(nextSlash + 1);
+	}
+
+	if(name == "dump" && subAddress.empty()) {
+		dump();
+	} else if(name == "*") {
+		for(size_t i = 0; i < count; i++) {
+			executeEntry(i, subAddress, arguments);
+		}
+	} else if(name == "**") {
+		// Values are leaves, the remaining address is relative to this node
+		execute(subAddress, arguments);
+	} else {
+		size_t index = findEntry(name);
+		if(index < count) {
+			executeEntry(index, subAddress, arguments);
+		} else {
+			SPDLOG_WARN("Address {} not found from {}", address, getFullAddress());
+		}
+	}
+}
+
+bool OscSchemaNode::isAudioParameter(std::string_view address) const {
+	std::string_view name = address;
+	std::string_view subAddress;
+	size_t nextSlash = address.find('/');
+	if(nextSlash != std::string_view::npos) {
+		name = address.substr(0, nextSlash);
+		subAddress = address.substr(nextSlash + 1);
+	}
+
+	if(name == "**")
+		return isAudioParameter(subAddress);
+
+	// Everything else sets values or has no effect
+	return name != "dump" && subAddress != "dump";
+}
+
+void OscSchemaNode::executeEntry(size_t index, std::string_view subAddress, const std::vector<OscArgument>& arguments) {
+	const OscSchemaEntry& entry = entries[index];
+
+	if(subAddress.empty()) {
+		if(!arguments.empty())
+			setValue(index, arguments[0], true);
+	} else if(subAddress == "dump") {
+		notifyOsc(index);
+	} else if(entry.type == OscSchemaType::Bool && subAddress == "toggle") {
+		SPDLOG_INFO("{}/{}: Toggling", getFullAddress(), entry.name);
+		setValue(index, !std::get<bool>(getValue(index)), true);
+	} else if(entry.type != OscSchemaType::Bool && (subAddress == "increment" || subAddress == "decrement")) {
+		float sign = subAddress == "increment" ? 1 : -1;
+
+		if(entry.type == OscSchemaType::Int32) {
+			int32_t amount = 1;
+			if(!arguments.empty())
+				getArgumentAs<int32_t>(arguments[0], amount);
+			setValue(index, std::get<int32_t>(getValue(index)) + (int32_t) sign * amount, true);
+		} else {
+			float amount = 1;
+			if(!arguments.empty())
+				getArgumentAs<float>(arguments[0], amount);
+			setValue(index, std::get<float>(getValue(index)) + sign * amount, true);
+		}
+	} else {
+		SPDLOG_WARN("Address {} not found from {}/{}", subAddress, getFullAddress(), entry.name);
+	}
+}
+
+void OscSchemaNode::dump() {
+	for(size_t i = 0; i < count; i++) {
+		notifyOsc(i);
+	}
+}
+
+void OscSchemaNode::notifyValue(std::string_view subAddress) {
+	size_t index = findEntry(subAddress);
+	if(index < count)
+		notifyOsc(index);
+}
+
+void OscSchemaNode::dumpSchema() {
+	OscRoot* root = getRoot();
+
+	for(size_t i = 0; i < count; i++) {
+		const OscSchemaEntry& entry = entries[i];
+		OscMetadata metadata = oscUnit(entry.unit);
+
+		switch(entry.type) {
+			case OscSchemaType::Bool:
+				metadata.minValue = 0;
+				metadata.maxValue = 1;
+				root->sendSchema(this, entry.name, 'T', metadata);
+				break;
+			case OscSchemaType::Int32:
+				metadata.minValue = (float) entry.minValue.int32Value;
+				metadata.maxValue = (float) entry.maxValue.int32Value;
+				root->sendSchema(this, entry.name, 'i', metadata);
+				break;
+			case OscSchemaType::Float:
+				metadata.minValue = entry.minValue.floatValue;
+				metadata.maxValue = entry.maxValue.floatValue;
+				root->sendSchema(this, entry.name, 'f', metadata);
+				break;
+		}
+	}
+}
+
+void OscSchemaNode::notifyOsc(size_t index) {
+	OscArgument valueToSend = getValue(index);
+	sendMessage(entries[index].name, &valueToSend, 1);
+}
+
+uint32_t OscSchemaNode::getEntryStateHash(size_t index) const {
+	OscArgument value = getValue(index);
+	return hashState(getConfigAddressHash(index), &value, 1);
+}
+
+uint32_t OscSchemaNode::getConfigAddressHash(size_t index) const {
+	using namespace std::literals;
+
+	// Same as the address hash of a variable named like the entry
+	return hashAddress(entries[index].name, hashAddress("/"sv, getAddressHash()));
+}
+
+bool OscSchemaNode::getConfigValue(size_t index, OscArgument* value) const {
+	if(!(modifiedMask & (1 << index)))
+		return false;
+
+	*value = getValue(index);
+	return true;
+}
+
+void OscSchemaNode::setConfigValue(size_t index, const OscArgument& value) {
+	setValue(index, value);
+}
+
+std::string OscSchemaNode::getAsString() const {
+	std::string result;
+
+	for(size_t i = 0; i < count; i++) {
+		if(!(modifiedMask & (1 << i)))
+			continue;
+
+		result += result.empty() ? "{\n" : ",\n";
+		result += "\t\"" + std::string(entries[i].name) + "\": ";
+		switch(entries[i].type) {
+			case OscSchemaType::Bool:
+				result += std::to_string(std::get<bool>(getValue(i)));
+				break;
+			case OscSchemaType::Int32:
+				result += std::to_string(std::get<int32_t>(getValue(i)));
+				break;
+			case OscSchemaType::Float:
+				result += std::to_string(std::get<float>(getValue(i)));
+				break;
+		}
+	}
+
+	if(!result.empty())
+		result += "\n}";
+
+	return result;
+}
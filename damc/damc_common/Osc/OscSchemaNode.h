@@ -0,0 +1,152 @@
+#pragma once
+
+#include "OscMetadata.h"
+#include "OscNode.h"
+#include <limits>
+#include <stddef.h>
+#include <stdint.h>
+#include <string_view>
+
+enum class OscSchemaType : uint8_t { Bool, Int32, Float };
+
+// Value of a schema entry, the member used is given by the entry type
+union OscSchemaValue {
+	bool boolValue;
+	int32_t int32Value;
+	float floatValue;
+
+	constexpr OscSchemaValue(bool v) : boolValue(v) {}
+	constexpr OscSchemaValue(int32_t v) : int32Value(v) {}
+	constexpr OscSchemaValue(float v) : floatValue(v) {}
+};
+
+template<typename T> struct osc_schema_type {};
+template<> struct osc_schema_type<bool> {
+	static constexpr OscSchemaType value = OscSchemaType::Bool;
+};
+template<> struct osc_schema_type<int32_t> {
+	static constexpr OscSchemaType value = OscSchemaType::Int32;
+};
+template<> struct osc_schema_type<float> {
+	static constexpr OscSchemaType value = OscSchemaType::Float;
+};
+
+// Compile time description of a value: stored in flash, the value itself is a member of a plain struct at offset
+struct OscSchemaEntry {
+	std::string_view name;
+	uint32_t nameHash;
+	uint16_t offset;
+	OscSchemaType type;
+	OscSchemaValue defaultValue;
+	OscSchemaValue minValue;
+	OscSchemaValue maxValue;
+	std::string_view unit;
+};
+
+template<typename T>
+constexpr OscSchemaEntry oscSchemaEntry(std::string_view name,
+                                        size_t offset,
+                                        T defaultValue,
+                                        T minValue = std::numeric_limits<T>::lowest(),
+                                        T maxValue = std::numeric_limits<T>::max(),
+                                        std::string_view unit = {}) {
+	return OscSchemaEntry{name,
+	                      OscNode::hashAddress(name),
+	                      (uint16_t) offset,
+	                      osc_schema_type<T>::value,
+	                      OscSchemaValue(defaultValue),
+	                      OscSchemaValue(minValue),
+	                      OscSchemaValue(maxValue),
+	                      unit};
+}
+
+// Entry for the member member_ of the values struct struct_, named like the member, followed by the default value and
+// optionally the range and the unit
+#define OSC_SCHEMA_ENTRY(struct_, member_, ...) \
+	oscSchemaEntry<decltype(struct_::member_)>(#member_, offsetof(struct_, member_), __VA_ARGS__)
+
+// Check at compile time that names are unique (they are resolved by hash) and defaults are in range
+template<size_t N> constexpr bool oscSchemaIsValid(const OscSchemaEntry (&entries)[N]) {
+	if(N > 32)
+		return false;
+
+	for(size_t i = 0; i < N; i++) {
+		const OscSchemaEntry& entry = entries[i];
+		for(size_t j = 0; j < i; j++) {
+			if(entries[j].nameHash == entry.nameHash)
+				return false;
+		}
+
+		if(entry.type == OscSchemaType::Int32 && (entry.defaultValue.int32Value < entry.minValue.int32Value ||
+		                                          entry.defaultValue.int32Value > entry.maxValue.int32Value))
+			return false;
+		if(entry.type == OscSchemaType::Float && (entry.defaultValue.floatValue < entry.minValue.floatValue ||
+		                                          entry.defaultValue.floatValue > entry.maxValue.floatValue))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Leaf node holding the fixed parameters of an object, described by a constexpr schema.
+ * Names, types, ranges and defaults are in flash, the values are members of a plain struct of the owner. Unlike a
+ * container of OscVariable, there is no node, callback or allocation per value: the node costs its own object only.
+ * Each value keeps the address and behavior of a variable: "<node>/<name>" sets it (clamped to its range),
+ * "<node>/<name>/increment", "decrement" and "toggle" change it, it is sent, dumped, persisted and loaded at its own
+ * address. Types, ranges and units are exported by "/schema".
+ *
+ * The owner calls initValues() at the end of its constructor, then onValueChanged is called for each value.
+ * Writes are applied by the audio processing between blocks, onValueChanged must not allocate.
+ */
+class OscSchemaNode : public OscNode {
+public:
+	OscSchemaNode(OscContainer* parent, std::string_view name, const OscSchemaEntry* entries, size_t count, void* values);
+	~OscSchemaNode() override;
+
+	using OscNode::execute;
+	void execute(std::string_view address, const std::vector<OscArgument>& arguments) override;
+
+	bool isAudioParameter(std::string_view address) const override;
+
+	void dump() override;
+	void notifyValue(std::string_view subAddress) override;
+	void dumpSchema() override;
+	uint32_t getChangeSequence() const override { return changeSequence; }
+	uint32_t getStateHash() const override { return stateHash; }
+
+	std::string getAsString() const override;
+
+	bool isConfigNode() const override { return true; }
+	size_t getConfigValueNumber() const override { return count; }
+	uint32_t getConfigAddressHash(size_t index) const override;
+	bool getConfigValue(size_t index, OscArgument* value) const override;
+	void setConfigValue(size_t index, const OscArgument& value) override;
+
+	// Return count if name is not in the schema
+	size_t findEntry(std::string_view name) const;
+	OscArgument getValue(size_t index) const;
+	void setValue(size_t index, const OscArgument& value, bool fromOsc = false);
+
+protected:
+	// Set all values to their default
+	void initValues();
+	// Called when a value is changed, from the main loop or the audio processing like variable callbacks
+	virtual void onValueChanged(size_t index) {}
+
+	void executeEntry(size_t index, std::string_view subAddress, const std::vector<OscArgument>& arguments);
+	void notifyOsc(size_t index);
+	uint32_t getEntryStateHash(size_t index) const;
+	// value must have the type of the entry
+	void storeValue(const OscSchemaEntry& entry, const OscArgument& value);
+
+private:
+	const OscSchemaEntry* entries;
+	uint8_t* values;
+	uint8_t count;
+	// Values set at least once, persisted by the configuration
+	uint32_t modifiedMask = 0;
+	uint32_t changeSequence = 0;
+	// XOR of the state hash of each value
+	uint32_t stateHash = 0;
+};
@@ -15,41 +15,8 @@ OscVariable<T>::OscVariable(OscContainer* parent,
 
 	this->getRoot()->addPendingConfigNode(this);
 
-	this->addChangeCallback([this](readonly_type) { this->getRoot()->notifyValueChanged(); });
-
-	if constexpr(std::is_same_v<T, bool>) {
-		subEndpoint.emplace_back(new OscEndpoint(this, "toggle"))->setCallback([this](auto) {
-			SPDLOG_INFO("{}: Toggling", this->getFullAddress());
-			this->setFromOsc(!this->getToOsc());
-		});
-	} else if constexpr(std::is_same_v<T, std::string>) {
-		// No toggle/increment/decrement
-	} else {
+	if constexpr(!std::is_same_v<T, bool> && !std::is_same_v<T, std::string>)
 		incrementAmount = (T) 1;
-		subEndpoint.reserve(2);
-		subEndpoint.emplace_back(new OscEndpoint(this, "increment"))
-		    ->setCallback([this](const std::vector<OscArgument>& arguments) {
-			    T amount = incrementAmount;
-
-			    if(!arguments.empty()) {
-				    OscNode::getArgumentAs<T>(arguments[0], amount);
-			    }
-
-			    SPDLOG_INFO("{}: Incrementing by {}", this->getFullAddress(), amount);
-			    this->setFromOsc(this->getToOsc() + amount);
-		    });
-		subEndpoint.emplace_back(new OscEndpoint(this, "decrement"))
-		    ->setCallback([this](const std::vector<OscArgument>& arguments) {
-			    T amount = incrementAmount;
-
-			    if(!arguments.empty()) {
-				    OscNode::getArgumentAs<T>(arguments[0], amount);
-			    }
-
-			    SPDLOG_INFO("{}: Decrementing by {}", this->getFullAddress(), amount);
-			    this->setFromOsc(this->getToOsc() - amount);
-		    });
-	}
 }
 
 template<typename T> OscVariable<T>& OscVariable<T>::operator=(const OscVariable<T>& v) {
@@ -71,13 +38,60 @@ template<typename T> void OscVariable<T>::execute(const std::vector<OscArgument>
 	}
 }
 
-template<typename T> std::string OscVariable<T>::getAsString() const {
-	if(this->isDefault())
-		return {};
+template<typename T>
+bool OscVariable<T>::executeSubEndpoint(std::string_view name, const std::vector<OscArgument>& arguments) {
+	if(fixedSize)
+		return OscReadOnlyVariable<T>::executeSubEndpoint(name, arguments);
 
-	if constexpr(std::is_same_v<T, std::string>) {
-		return "\"" + std::string(this->getToOsc()) + "\"";
+	if constexpr(std::is_same_v<T, bool>) {
+		if(name == "toggle") {
+			SPDLOG_INFO("{}: Toggling", this->getFullAddress());
+			this->setFromOsc(!this->getToOsc());
+			return true;
+		}
+	} else if constexpr(std::is_same_v<T, std::string>) {
+		// No toggle/increment/decrement
 	} else {
-		return std::to_string(this->getToOsc());
+		if(name == "increment" || name == "decrement") {
+			T amount = incrementAmount;
+
+			if(!arguments.empty()) {
+				OscNode::getArgumentAs<T>(arguments[0], amount);
+			}
+
+			if(name == "increment") {
+				SPDLOG_INFO("{}: Incrementing by {}", this->getFullAddress(), amount);
+				this->setFromOsc(this->getToOsc() + amount);
+			} else {
+				SPDLOG_INFO("{}: Decrementing by {}", this->getFullAddress(), amount);
+				this->setFromOsc(this->getToOsc() - amount);
+			}
+			return true;
+		}
 	}
+
+	return OscReadOnlyVariable<T>::executeSubEndpoint(name, arguments);
+}
+
+template<typename T> bool OscVariable<T>::isAudioParameter(std::string_view address) const {
+	// Strings are stored in allocated memory
+	if(std::is_same_v<T, std::string> || mainLoopOnly)
+		return false;
+
+	return OscReadOnlyVariable<T>::isAudioParameter(address);
+}
+
+template<typename T> bool OscVariable<T>::getConfigValue(size_t index, OscArgument* value) const {
+	if(fixedSize || this->isDefault())
+		return false;
+
+	// Raw value, without OSC converters, so restoring it gives the exact same value
+	*value = readonly_type(this->get());
+	return true;
+}
+
+template<typename T> void OscVariable<T>::setConfigValue(size_t index, const OscArgument& value) {
+	readonly_type v;
+	if(OscNode::getArgumentAs<readonly_type>(value, v))
+		this->set(v);
 }
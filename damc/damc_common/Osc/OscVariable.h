@@ -1,7 +1,6 @@
 #pragma once
 
 #include "OscReadOnlyVariable.h"
-#include <memory>
 
 template<typename T> class OscVariable : public OscReadOnlyVariable<T> {
 public:
@@ -17,13 +16,23 @@ public:
 	void execute(const std::vector<OscArgument>& arguments) override;
 
 	void setIncrementAmount(T amount) { incrementAmount = amount; }
+	// For variables whose change callbacks allocate or reconfigure the processing: OSC writes are then executed by
+	// the main loop instead of the audio processing
+	void setMainLoopOnly() { mainLoopOnly = true; }
+	bool isAudioParameter(std::string_view address) const override;
 
-	std::string getAsString() const override;
+	bool isConfigNode() const override { return !fixedSize; }
+	bool getConfigValue(size_t index, OscArgument* value) const override;
+	void setConfigValue(size_t index, const OscArgument& value) override;
+
+protected:
+	// "toggle" for bool, "increment" and "decrement" with an optional amount for numbers
+	bool executeSubEndpoint(std::string_view name, const std::vector<OscArgument>& arguments) override;
 
 private:
 	T incrementAmount;
-	std::vector<std::unique_ptr<OscEndpoint>> subEndpoint;
 	bool fixedSize;
+	bool mainLoopOnly = false;
 };
 
 EXPLICIT_INSTANCIATE_OSC_VARIABLE(extern template, OscVariable)
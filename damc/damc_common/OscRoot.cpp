@@ -1,13 +1,30 @@
 #include "OscRoot.h"
 #include "tinyosc.h"
+#include <algorithm>
 #include <math.h>
 #include <spdlog/spdlog.h>
 #include <string.h>
 #include <string_view>
 
-OscRoot::OscRoot(bool notifyAtInit) : OscContainer(nullptr, ""), doNotifyOscAtInit(notifyAtInit) {
-	oscOutputMaxSize = 128;
+OscRoot::OscRoot(bool notifyAtInit)
+    : OscContainer(nullptr, ""), doNotifyOscAtInit(notifyAtInit), oscSync(this, "sync"), oscSchema(this, "schema") {
+	// Enough for schema messages with enum labels
+	oscOutputMaxSize = 256;
 	oscOutputMessage.reset(new uint8_t[oscOutputMaxSize]);
+	nodeFullAddress.reserve(oscOutputMaxSize);
+	messageHeaderStorage.reset(new char[MESSAGE_HEADER_STORAGE_SIZE]);
+	receivedArguments.reserve(MAX_ARGUMENTS);
+	audioArguments.reserve(MAX_ARGUMENTS);
+	stateBundle.size = 0;
+	telemetryBundle.size = 0;
+	nextPendingConfig = this;
+
+	oscSync.setCallback([this](const std::vector<OscArgument>& arguments) {
+		int32_t sinceSequence = 0;
+		bool onlyChanged = !arguments.empty() && OscNode::getArgumentAs<int32_t>(arguments[0], sinceSequence);
+		requestDump(this, onlyChanged, sinceSequence, DumpType::Sync);
+	});
+	oscSchema.setCallback([this](const std::vector<OscArgument>&) { requestDump(this, false, 0, DumpType::Schema); });
 }
 
 OscRoot::~OscRoot() {}
@@ -16,13 +33,45 @@ void OscRoot::printAllNodes() {
 	SPDLOG_INFO("Nodes:\n{}", getAsString().c_str());
 }
 
-void OscRoot::sendMessage(const OscNode* node, const OscArgument* arguments, size_t number) {
+bool OscRoot::writeMessageHeader(tosc_message* osc, OscNode* node, const char* format, std::string_view subAddress) {
+	if(!node->isTelemetry() || !subAddress.empty()) {
+		node->getFullAddress(&nodeFullAddress);
+		if(!subAddress.empty()) {
+			nodeFullAddress += '/';
+			nodeFullAddress += subAddress;
+		}
+		return tosc_writeMessageHeader(osc, nodeFullAddress.c_str(), format, (char*) oscOutputMessage.get(), oscOutputMaxSize) ==
+		       0;
+	}
+
+	// Telemetry nodes send the same header repeatedly, copy their cached header
+	std::string_view header = node->getMessageHeader(format, &nodeFullAddress);
+	if(header.empty()) {
+		return tosc_writeMessageHeader(osc, nodeFullAddress.c_str(), format, (char*) oscOutputMessage.get(), oscOutputMaxSize) ==
+		       0;
+	}
+	if(header.size() > oscOutputMaxSize)
+		return false;
+
+	memcpy(oscOutputMessage.get(), header.data(), header.size());
+	osc->buffer = (char*) oscOutputMessage.get();
+	osc->buffer_end = osc->buffer + oscOutputMaxSize;
+	osc->marker = osc->buffer + header.size();
+
+	return true;
+}
+
+void OscRoot::sendMessage(OscNode* node, const OscArgument* arguments, size_t number, std::string_view subAddress) {
+	if(isAudioExecution) {
+		deferNotification(node, subAddress);
+		return;
+	}
+
+	BusyGuard busyGuard(this);
 	tosc_message osc;
 	char format[256] = ",";
 	char* formatPtr = format + 1;
 
-	node->getFullAddress(&nodeFullAddress);
-
 	if(number > sizeof(format) - 2) {
 		SPDLOG_ERROR("Too many arguments, can't send OSC message: {}", number);
 		return;
@@ -49,7 +98,7 @@ void OscRoot::sendMessage(const OscNode* node, const OscArgument* arguments, siz
 	}
 	*formatPtr++ = '\0';
 
-	if(tosc_writeMessageHeader(&osc, nodeFullAddress.c_str(), format, (char*) oscOutputMessage.get(), oscOutputMaxSize) != 0) {
+	if(!writeMessageHeader(&osc, node, format, subAddress)) {
 		SPDLOG_ERROR("failed to write OSC message");
 		return;
 	}
@@ -80,29 +129,218 @@ void OscRoot::sendMessage(const OscNode* node, const OscArgument* arguments, siz
 		}
 	}
 
-	SPDLOG_TRACE("Sending OSC message {} {}", nodeFullAddress, getArgumentVectorAsString(arguments, number));
-	for(OscConnector* connector : connectors) {
-		connector->sendOscMessage(oscOutputMessage.get(), tosc_getMessageLength(&osc));
+	SPDLOG_TRACE("Sending OSC message {} {}",
+	             (const char*) oscOutputMessage.get(),
+	             getArgumentVectorAsString(arguments, number));
+	queueMessage(node, oscOutputMessage.get(), tosc_getMessageLength(&osc), node->isTelemetry());
+}
+
+char* OscRoot::allocateMessageHeader(size_t size) {
+	if(messageHeaderStorageUsed + size > MESSAGE_HEADER_STORAGE_SIZE) {
+		if(!messageHeaderStorageFull) {
+			SPDLOG_WARN("No room left to cache OSC message headers, {} bytes used", messageHeaderStorageUsed);
+			messageHeaderStorageFull = true;
+		}
+		return nullptr;
 	}
+
+	char* header = &messageHeaderStorage[messageHeaderStorageUsed];
+	messageHeaderStorageUsed += size;
+	return header;
 }
 
-void OscRoot::loadNodeConfig(const std::map<std::string_view, std::vector<OscArgument>>& configValues) {
-	SPDLOG_DEBUG("Traversing OscNode to assign configuration values");
+void OscRoot::sendBlobMessage(OscNode* node, const uint8_t* data, size_t size) {
+	if(isAudioExecution) {
+		deferNotification(node, {});
+		return;
+	}
+
+	BusyGuard busyGuard(this);
+	tosc_message osc;
 
-	std::string nodeAddress;
+	if(!writeMessageHeader(&osc, node, ",b") || tosc_writeNextBlob(&osc, (const char*) data, size) != 0) {
+		SPDLOG_ERROR("failed to write OSC blob message of {} bytes", size);
+		return;
+	}
 
-	while(!nodesPendingConfig.empty()) {
-		auto nextNodeIt = nodesPendingConfig.begin();
-		OscNode* node = *nextNodeIt;
-		nodesPendingConfig.erase(nextNodeIt);
+	SPDLOG_TRACE("Sending OSC blob message {} of {} bytes", (const char*) oscOutputMessage.get(), size);
+	queueMessage(node, oscOutputMessage.get(), tosc_getMessageLength(&osc), true);
+}
 
-		node->getFullAddress(&nodeAddress);
+void OscRoot::queueMessage(const OscNode* node, const uint8_t* data, size_t size, bool isTelemetry) {
+	OutputBundle& bundle = isTelemetry ? telemetryBundle : stateBundle;
 
-		auto it = configValues.find(nodeAddress);
-		if(it != configValues.end()) {
-			node->execute(it->second);
+	if(size + 4 + BUNDLE_HEADER_SIZE > OutputBundle::MAX_SIZE) {
+		// Too big for a bundle, send it alone
+		sendToConnectors(data, size, isTelemetry);
+		return;
+	}
+
+	if(isTelemetry) {
+		// Replace the stale value if it has the same size (always the case for meters)
+		for(size_t i = 0; i < queuedTelemetryCount; i++) {
+			if(queuedTelemetry[i].node == node && queuedTelemetry[i].size == size) {
+				memcpy(&bundle.data[queuedTelemetry[i].offset], data, size);
+				return;
+			}
 		}
+
+		if(queuedTelemetryCount >= MAX_QUEUED_TELEMETRY)
+			flushBundle(bundle, isTelemetry);
+	}
+
+	if(bundle.size + 4 + size > OutputBundle::MAX_SIZE)
+		flushBundle(bundle, isTelemetry);
+
+	if(bundle.size == 0) {
+		// Bundle header with the "immediately" timetag
+		static constexpr uint8_t header[BUNDLE_HEADER_SIZE] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', 0, 0, 0, 0, 0, 0, 0, 0, 1};
+		memcpy(bundle.data, header, sizeof(header));
+		bundle.size = sizeof(header);
+	}
+
+	uint8_t* element = &bundle.data[bundle.size];
+	element[0] = (size >> 24) & 0xFF;
+	element[1] = (size >> 16) & 0xFF;
+	element[2] = (size >> 8) & 0xFF;
+	element[3] = size & 0xFF;
+	memcpy(element + 4, data, size);
+
+	if(isTelemetry) {
+		queuedTelemetry[queuedTelemetryCount].node = node;
+		queuedTelemetry[queuedTelemetryCount].offset = bundle.size + 4;
+		queuedTelemetry[queuedTelemetryCount].size = size;
+		queuedTelemetryCount++;
 	}
+
+	bundle.size += 4 + size;
+}
+
+void OscRoot::flushMessages() {
+	BusyGuard busyGuard(this);
+	// Messages sent until the next flush are for values changed after the previous flush
+	previousFlushSequence = flushSequence;
+	flushSequence = changeSequence.load(std::memory_order_relaxed);
+	sendDeferredNotifications();
+	flushBundle(stateBundle, false);
+	flushBundle(telemetryBundle, true);
+}
+
+void OscRoot::beginAudioExecution() {
+	isAudioExecution = true;
+	audioExecutionSequence = changeSequence.load(std::memory_order_relaxed);
+}
+
+void OscRoot::endAudioExecution() {
+	isAudioExecution = false;
+}
+
+void OscRoot::deferNotification(OscNode* node, std::string_view subAddress) {
+	if(deferredNotifications.full()) {
+		if(!notificationsLost.load(std::memory_order_relaxed)) {
+			// Values changed by this execution have a later sequence number
+			lostNotificationSequence = audioExecutionSequence;
+			notificationsLost.store(true, std::memory_order_release);
+		}
+		return;
+	}
+
+	DeferredNotification& notification = deferredNotifications.getWriteSlot();
+	notification.node = node;
+	notification.subAddress = subAddress;
+	deferredNotifications.push();
+}
+
+void OscRoot::sendDeferredNotifications(const OscNode* skippedNode) {
+	while(!deferredNotifications.empty()) {
+		DeferredNotification notification = deferredNotifications.front();
+		deferredNotifications.pop();
+
+		if(!skippedNode || !notification.node->isInSubtreeOf(skippedNode))
+			notification.node->notifyValue(notification.subAddress);
+	}
+
+	if(notificationsLost.load(std::memory_order_acquire)) {
+		requestDump(this, true, lostNotificationSequence);
+		notificationsLost.store(false, std::memory_order_relaxed);
+	}
+
+	if(valueChangedPending.exchange(false, std::memory_order_relaxed) && onOscValueChanged)
+		onOscValueChanged();
+}
+
+void OscRoot::flushBundle(OutputBundle& bundle, bool isTelemetry) {
+	if(bundle.size == 0)
+		return;
+
+	sendToConnectors(bundle.data, bundle.size, isTelemetry);
+
+	bundle.size = 0;
+	if(isTelemetry)
+		queuedTelemetryCount = 0;
+}
+
+void OscRoot::sendToConnectors(const uint8_t* data, size_t size, bool isTelemetry) {
+	bool isDropped = false;
+
+	for(OscConnector* connector : connectors) {
+		if(!isTelemetry || connector->canSendTelemetry(size))
+			isDropped |= !connector->sendOscMessage(data, size);
+	}
+
+	// Telemetry is replaced by newer values, lost state is sent again by dumping the values changed since then once
+	// the connectors have room
+	if(isDropped && !isTelemetry) {
+		droppedStateMessageCount++;
+		requestDump(this, true, previousFlushSequence);
+	}
+}
+
+void OscRoot::loadNodeConfig(ConfigValue* values, size_t count) {
+	BusyGuard busyGuard(this);
+	SPDLOG_DEBUG("Assigning configuration values to pending nodes");
+
+	std::sort(values, values + count, [](const ConfigValue& a, const ConfigValue& b) {
+		return a.addressHash < b.addressHash;
+	});
+
+	// Nodes created or removed while executing values are added to or removed from the list
+	while(nextPendingConfig != this) {
+		OscNode* node = nextPendingConfig;
+		nextPendingConfig = node->nextPendingConfig;
+		node->nextPendingConfig = nullptr;
+
+		uint32_t addressHash = node->getAddressHash();
+		size_t valueNumber = node->getConfigValueNumber();
+		if(valueNumber == 0 || node->getConfigAddressHash(0) == addressHash) {
+			const ConfigValue* value = findConfigValue(values, count, addressHash);
+			if(value) {
+				// The argument vector is reserved, no allocation
+				receivedArguments.clear();
+				receivedArguments.push_back(value->value);
+				node->execute(receivedArguments);
+			}
+		} else {
+			// Values without their own node (schema entries)
+			for(size_t i = 0; i < valueNumber; i++) {
+				const ConfigValue* value = findConfigValue(values, count, node->getConfigAddressHash(i));
+				if(value)
+					node->setConfigValue(i, value->value);
+			}
+		}
+	}
+}
+
+const OscRoot::ConfigValue* OscRoot::findConfigValue(const ConfigValue* values, size_t count, uint32_t addressHash) {
+	const ConfigValue* it = std::lower_bound(
+	    values, values + count, addressHash, [](const ConfigValue& value, uint32_t addressHash) {
+		    return value.addressHash < addressHash;
+	    });
+
+	if(it != values + count && it->addressHash == addressHash)
+		return it;
+
+	return nullptr;
 }
 
 std::string OscRoot::getArgumentVectorAsString(const OscArgument* arguments, size_t number) {
@@ -130,28 +368,115 @@ std::string OscRoot::getArgumentVectorAsString(const OscArgument* arguments, siz
 	return result + " ]";
 }
 
-void OscRoot::onOscPacketReceived(const uint8_t* data, size_t size) {
+bool OscRoot::onOscPacketReceived(const uint8_t* data, size_t size) {
+	BusyGuard busyGuard(this);
+
 	if(tosc_isBundle((const char*) data)) {
 		tosc_bundle_const bundle;
 		tosc_parseBundle(&bundle, (const char*) data, size);
+		uint64_t timetag = tosc_getTimetag(&bundle);
 
 		tosc_message_const osc;
+		size_t index = 0;
 		while(tosc_getNextMessage(&bundle, &osc)) {
-			executeMessage(&osc);
+			if(index < receivedPacketProgress) {
+				index++;
+				continue;
+			}
+
+			bool isDone = true;
+			if(timetag == TINYOSC_TIMETAG_IMMEDIATELY) {
+				isDone = executeOrQueueMessage(&osc);
+			} else if(!isAudioParameter(tosc_getAddress(&osc) + 1) || osc.len > SCHEDULED_MESSAGE_MAX_SIZE) {
+				// Executed by the audio processing, which must not allocate nor send
+				SPDLOG_ERROR("Only parameters can be scheduled, ignoring {}", tosc_getAddress(&osc));
+			} else {
+				// When full, wait for the audio processing to reach the first timetags
+				isDone = scheduleMessage(timetag, &osc);
+			}
+
+			if(!isDone) {
+				receivedPacketProgress = index;
+				return false;
+			}
+			index++;
 		}
 	} else {
 		tosc_message_const osc;
 		int result = tosc_parseMessage(&osc, (const char*) data, size);
-		if(result == 0) {
-			executeMessage(&osc);
-		}
+		if(result == 0 && !executeOrQueueMessage(&osc))
+			return false;
 	}
+
+	receivedPacketProgress = 0;
+	return true;
 }
 
-void OscRoot::executeMessage(tosc_message_const* osc) {
-	std::vector<OscArgument> arguments;
+bool OscRoot::executeOrQueueMessage(tosc_message_const* osc) {
+	if(!receivedMessageQueueEnabled) {
+		executeMessage(osc, receivedArguments);
+		return true;
+	}
+
+	if(osc->len <= RECEIVED_MESSAGE_MAX_SIZE && isAudioParameter(tosc_getAddress(osc) + 1)) {
+		if(receivedMessageQueue.full())
+			return false;
+
+		ReceivedMessage& message = receivedMessageQueue.getWriteSlot();
+		message.size = osc->len;
+		memcpy(message.data, osc->buffer, osc->len);
+		receivedMessageQueue.push();
+		return true;
+	}
+
+	if(!canExecuteInMainLoop())
+		return false;
+
+	holdAudioProcessing(true);
+	executeMessage(osc, receivedArguments);
+	holdAudioProcessing(false);
+
+	return true;
+}
+
+void OscRoot::holdAudioProcessing(bool hold) {
+	if(receivedMessageQueueEnabled && holdAudioProcessingFunction)
+		holdAudioProcessingFunction(hold);
+}
+
+void OscRoot::setHoldAudioProcessing(std::function<void(bool)> holdAudioProcessing) {
+	holdAudioProcessingFunction = std::move(holdAudioProcessing);
+}
+
+void OscRoot::executeReceivedMessages() {
+	if(isBusy())
+		return;
+
+	beginAudioExecution();
+
+	while(!receivedMessageQueue.empty()) {
+		ReceivedMessage& message = receivedMessageQueue.front();
+		tosc_message_const osc;
+
+		if(tosc_parseMessage(&osc, message.data, message.size) == 0)
+			executeMessage(&osc, audioArguments);
+
+		receivedMessageQueue.pop();
+	}
+
+	endAudioExecution();
+}
+
+void OscRoot::executeMessage(tosc_message_const* osc, std::vector<OscArgument>& arguments) {
 	const char* address = tosc_getAddress(osc);
 
+	if(strlen(osc->format) > MAX_ARGUMENTS) {
+		SPDLOG_ERROR("Too many arguments in message {}: {}", address, osc->format);
+		return;
+	}
+
+	arguments.clear();
+
 	for(int i = 0; osc->format[i] != '\0'; i++) {
 		OscArgument argument;
 
@@ -211,6 +536,7 @@ void OscRoot::executeMessage(tosc_message_const* osc) {
 		arguments.push_back(std::move(argument));
 	}
 
+#if defined(SPDLOG_ACTIVE_LEVEL) && SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
 	if(strstr(address, "meter") == nullptr) {
 		tosc_reset(osc);
 		SPDLOG_DEBUG("OSC message received: {} {} {}",
@@ -218,7 +544,64 @@ void OscRoot::executeMessage(tosc_message_const* osc) {
 		             osc->format,
 		             getArgumentVectorAsString(&arguments[0], arguments.size()));
 	}
-	execute(address + 1, std::move(arguments));
+#endif
+	execute(address + 1, arguments);
+}
+
+bool OscRoot::scheduleMessage(uint64_t timetag, const tosc_message_const* osc) {
+	if(scheduledMessageCount >= SCHEDULED_MESSAGE_NUMBER)
+		return false;
+
+	uint8_t slot = __builtin_ctz(~scheduledMessageUsedSlots);
+	ScheduledMessage& message = scheduledMessages[slot];
+	message.timetag = timetag;
+	message.size = osc->len;
+	memcpy(message.data, osc->buffer, osc->len);
+	scheduledMessageUsedSlots |= 1 << slot;
+
+	// Insert after all messages with a lower or equal timetag
+	size_t position = scheduledMessageCount;
+	while(position > 0 && scheduledMessages[scheduledMessageOrder[position - 1]].timetag > timetag) {
+		scheduledMessageOrder[position] = scheduledMessageOrder[position - 1];
+		position--;
+	}
+	scheduledMessageOrder[position] = slot;
+	scheduledMessageCount++;
+
+	return true;
+}
+
+uint64_t OscRoot::getNextScheduledTimetag() const {
+	// While the main loop is using the OscRoot, scheduled messages are delayed to the next audio block
+	if(scheduledMessageCount == 0 || isBusy())
+		return NO_SCHEDULED_MESSAGE;
+	return scheduledMessages[scheduledMessageOrder[0]].timetag;
+}
+
+void OscRoot::executeScheduledMessages(uint64_t timetag) {
+	size_t executedCount = 0;
+
+	beginAudioExecution();
+
+	while(executedCount < scheduledMessageCount &&
+	      scheduledMessages[scheduledMessageOrder[executedCount]].timetag <= timetag) {
+		uint8_t slot = scheduledMessageOrder[executedCount];
+		ScheduledMessage& message = scheduledMessages[slot];
+		tosc_message_const osc;
+
+		if(tosc_parseMessage(&osc, message.data, message.size) == 0)
+			executeMessage(&osc, audioArguments);
+
+		scheduledMessageUsedSlots &= ~(1 << slot);
+		executedCount++;
+	}
+
+	endAudioExecution();
+
+	if(executedCount > 0) {
+		scheduledMessageCount -= executedCount;
+		memmove(&scheduledMessageOrder[0], &scheduledMessageOrder[executedCount], scheduledMessageCount);
+	}
 }
 
 OscRoot* OscRoot::getRoot() {
@@ -230,21 +613,159 @@ bool OscRoot::isOscValueAuthority() {
 }
 
 void OscRoot::notifyValueChanged() {
+	if(isAudioExecution) {
+		valueChangedPending.store(true, std::memory_order_relaxed);
+		return;
+	}
+
 	if(onOscValueChanged)
 		onOscValueChanged();
 }
 
 void OscRoot::addPendingConfigNode(OscNode* node) {
 	SPDLOG_DEBUG("Adding node {} as pending configuration", node->getFullAddress());
-	nodesPendingConfig.insert(node);
+	if(!node->nextPendingConfig) {
+		node->nextPendingConfig = nextPendingConfig;
+		nextPendingConfig = node;
+	}
+	configNodesGeneration++;
 }
 
 void OscRoot::nodeRemoved(OscNode* node) {
-	nodesPendingConfig.erase(node);
+	// Nodes are removed by the main loop, the audio processing doesn't queue notifications meanwhile
+	sendDeferredNotifications(node);
+
+	for(size_t i = 0; i < dumpRequestCount;) {
+		if(dumpRequests[i].container == node)
+			removeDumpRequest(i);
+		else
+			i++;
+	}
+
+	// Restart the active dump when its cursor is removed
+	if(dumpCursor && dumpCursor->isInSubtreeOf(node))
+		dumpCursor = nullptr;
+
+	if(node->nextPendingConfig) {
+		OscNode* previous = this;
+		while(previous->nextPendingConfig != node)
+			previous = previous->nextPendingConfig;
+		previous->nextPendingConfig = node->nextPendingConfig;
+		node->nextPendingConfig = nullptr;
+	}
+	configNodesGeneration++;
+}
+
+void OscRoot::requestDump(OscContainer* container, bool onlyChanged, uint32_t sinceSequence, DumpType type) {
+	for(size_t i = 0; i < dumpRequestCount; i++) {
+		if(dumpRequests[i].container == container && dumpRequests[i].type == type) {
+			// Already requested: keep it, dump everything needed by both requests
+			if(i != 0 || !dumpCursor) {
+				dumpRequests[i].onlyChanged = dumpRequests[i].onlyChanged && onlyChanged;
+				dumpRequests[i].sinceSequence = std::min(dumpRequests[i].sinceSequence, sinceSequence);
+				return;
+			}
+		}
+	}
+
+	if(dumpRequestCount >= DUMP_REQUEST_NUMBER) {
+		SPDLOG_WARN("Too many dump requests, ignoring dump of {}", container->getFullAddress());
+		return;
+	}
+
+	dumpRequests[dumpRequestCount++] = DumpRequest{container, onlyChanged, type, sinceSequence};
+}
+
+void OscRoot::removeDumpRequest(size_t index) {
+	if(index == 0)
+		dumpCursor = nullptr;
+
+	for(size_t i = index; i + 1 < dumpRequestCount; i++)
+		dumpRequests[i] = dumpRequests[i + 1];
+	dumpRequestCount--;
+}
+
+bool OscRoot::dumpSlice() {
+	if(dumpRequestCount == 0)
+		return false;
+
+	// Let the previous dumped values go out before adding more
+	for(OscConnector* connector : connectors) {
+		if(!connector->canSendTelemetry(OutputBundle::MAX_SIZE))
+			return false;
+	}
+
+	BusyGuard busyGuard(this);
+	const DumpRequest& request = dumpRequests[0];
+
+	if(!dumpCursor) {
+		dumpCursor = request.container;
+		dumpStartSequence = changeSequence.load(std::memory_order_relaxed);
+		schemaValueCount = 0;
+	}
+
+	for(size_t i = 0; i < DUMP_SLICE_NODES && dumpCursor; i++) {
+		if(request.type == DumpType::Schema) {
+			dumpCursor->dumpSchema();
+		} else {
+			bool isChanged = !request.onlyChanged ||
+			                 (int32_t) (dumpCursor->getChangeSequence() - request.sinceSequence) > 0;
+			if(isChanged && !(request.type == DumpType::Sync && dumpCursor->isTelemetry()))
+				dumpCursor->dump();
+		}
+
+		dumpCursor = dumpCursor->getNextNode(request.container);
+	}
+
+	if(!dumpCursor) {
+		if(request.type == DumpType::Sync) {
+			// Values changed during the sync were already sent, the checksum includes them
+			OscArgument arguments[] = {(int32_t) dumpStartSequence, (int32_t) getStateChecksum()};
+			oscSync.sendMessage(arguments, 2);
+		} else if(request.type == DumpType::Schema) {
+			OscArgument argument = (int32_t) schemaValueCount;
+			oscSchema.sendMessage(&argument, 1);
+		} else {
+			request.container->sendDumpEnd(dumpStartSequence);
+		}
+		removeDumpRequest(0);
+	}
+
+	return true;
+}
+
+void OscRoot::sendSchema(OscNode* node, std::string_view subAddress, char type, const OscMetadata& metadata) {
+	// Reused string, no allocation once the longest address was sent
+	node->getFullAddress(&schemaAddress);
+	if(!subAddress.empty()) {
+		schemaAddress += '/';
+		schemaAddress += subAddress;
+	}
+
+	OscArgument arguments[] = {
+	    std::string_view(schemaAddress),
+	    std::string_view(&type, 1),
+	    metadata.minValue,
+	    metadata.maxValue,
+	    metadata.unit,
+	    (int32_t) metadata.smoothing,
+	    metadata.enumLabels,
+	};
+	oscSchema.sendMessage(arguments, metadata.enumLabels.empty() ? 6 : 7);
+	schemaValueCount++;
 }
 
-void OscRoot::triggerAddress(const std::string_view& address) {
+bool OscRoot::triggerAddress(const std::string_view& address) {
+	BusyGuard busyGuard(this);
+
+	if(!canExecuteInMainLoop())
+		return false;
+
+	holdAudioProcessing(true);
 	execute(std::string_view{address.data() + 1, address.size() - 1}, std::vector<OscArgument>{});
+	holdAudioProcessing(false);
+
+	return true;
 }
 
 void OscRoot::addConnector(OscConnector* connector) {
@@ -259,17 +780,15 @@ void OscRoot::setOnOscValueChanged(std::function<void()> onOscValueChanged) {
 	this->onOscValueChanged = onOscValueChanged;
 }
 
-static constexpr uint8_t SLIP_END = 0xC0;
-static constexpr uint8_t SLIP_ESC = 0xDB;
-static constexpr uint8_t SLIP_ESC_END = 0xDC;
-static constexpr uint8_t SLIP_ESC_ESC = 0xDD;
-
 OscConnector::OscConnector(OscRoot* oscRoot, bool useSlipProtocol)
-    : oscRoot(oscRoot), useSlipProtocol(useSlipProtocol), oscIsEscaping(false), discardNextMessage(false) {
+    : oscRoot(oscRoot),
+      useSlipProtocol(useSlipProtocol),
+      oscIsEscaping(false),
+      oscInputSize(0),
+      discardNextMessage(false) {
 	if(oscRoot)
 		oscRoot->addConnector(this);
 
-	oscInputBuffer.reserve(128);
 	oscOutputBuffer.reserve(128);
 }
 
@@ -278,39 +797,27 @@ OscConnector::~OscConnector() {
 		oscRoot->removeConnector(this);
 }
 
-void OscConnector::sendOscMessage(const uint8_t* data, size_t size) {
-	if(useSlipProtocol) {
-		oscOutputBuffer.clear();
-		oscOutputBuffer.reserve(size + 2 + 10);
+bool OscConnector::sendOscMessage(const uint8_t* data, size_t size) {
+	if(useSlipProtocol)
+		return sendSlipFrame(data, size);
 
-		// Encode SLIP frame with double-END variant (one at the start, one at the end)
-		oscOutputBuffer.push_back(SLIP_END);
+	sendOscData(data, size);
+	return true;
+}
 
-		for(size_t i = 0; i < size; i++) {
-			const uint8_t c = data[i];
-
-			if(c == SLIP_END) {
-				oscOutputBuffer.push_back(SLIP_ESC);
-				oscOutputBuffer.push_back(SLIP_ESC_END);
-			} else if(c == SLIP_ESC) {
-				oscOutputBuffer.push_back(SLIP_ESC);
-				oscOutputBuffer.push_back(SLIP_ESC_ESC);
-			} else {
-				oscOutputBuffer.push_back(c);
-			}
-		}
+bool OscConnector::sendSlipFrame(const uint8_t* data, size_t size) {
+	oscOutputBuffer.clear();
+	oscOutputBuffer.reserve(size + 2 + 10);
 
-		oscOutputBuffer.push_back(SLIP_END);
+	encodeSlip(data, size, [this](uint8_t c) { oscOutputBuffer.push_back(c); });
 
-		sendOscData(oscOutputBuffer.data(), oscOutputBuffer.size());
-	} else {
-		sendOscData(data, size);
-	}
+	sendOscData(oscOutputBuffer.data(), oscOutputBuffer.size());
+	return true;
 }
 
-void OscConnector::onOscDataReceived(const uint8_t* data, size_t size) {
+size_t OscConnector::onOscDataReceived(const uint8_t* data, size_t size) {
 	if(oscRoot == nullptr)
-		return;
+		return size;
 
 	if(useSlipProtocol) {
 		// Decode SLIP frame
@@ -322,10 +829,11 @@ void OscConnector::onOscDataReceived(const uint8_t* data, size_t size) {
 					oscIsEscaping = true;
 					continue;
 				} else if(c == SLIP_END) {
-					if(!oscInputBuffer.empty()) {
-						if(!discardNextMessage)
-							oscRoot->onOscPacketReceived(oscInputBuffer.data(), oscInputBuffer.size());
-						oscInputBuffer.clear();
+					if(oscInputSize > 0) {
+						// Keep the frame and its end, it is executed again once the OscRoot can take it
+						if(!discardNextMessage && !oscRoot->onOscPacketReceived(oscInputBuffer, oscInputSize))
+							return i;
+						oscInputSize = 0;
 						discardNextMessage = false;
 					}
 					continue;
@@ -340,12 +848,14 @@ void OscConnector::onOscDataReceived(const uint8_t* data, size_t size) {
 				// else this is an error, escaped character doesn't need to be escaped
 			}
 			oscIsEscaping = false;
-			if(oscInputBuffer.size() < 128)
-				oscInputBuffer.push_back(c);
+			if(oscInputSize < MAX_FRAME_SIZE)
+				oscInputBuffer[oscInputSize++] = c;
 			else
 				discardNextMessage = true;
 		}
-	} else {
-		oscRoot->onOscPacketReceived(data, size);
+	} else if(!oscRoot->onOscPacketReceived(data, size)) {
+		return 0;
 	}
+
+	return size;
 }
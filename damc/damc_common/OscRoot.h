@@ -1,8 +1,10 @@
 #pragma once
 
+#include "SpscQueue.h"
 #include <Osc/OscContainer.h>
+#include <Osc/OscMetadata.h>
+#include <atomic>
 #include <list>
-#include <map>
 #include <memory>
 #include <set>
 #include <stdint.h>
@@ -10,6 +12,7 @@
 #include <variant>
 
 struct tosc_message_const;
+struct tosc_message;
 
 class OscConnector;
 class OscNode;
@@ -19,39 +22,261 @@ public:
 	OscRoot(bool notifyAtInit);
 	~OscRoot();
 
-	void onOscPacketReceived(const uint8_t* data, size_t size);
+	// Return false when the packet can't be fully executed yet (queues full or queued messages to execute before it):
+	// call again later with the same packet, messages already executed are skipped
+	bool onOscPacketReceived(const uint8_t* data, size_t size);
 
 	void printAllNodes();
-	void triggerAddress(const std::string_view& address);
+	// Execute address without argument, return false when queued messages must be executed first (call again later)
+	bool triggerAddress(const std::string_view& address);
 
 	void addConnector(OscConnector* connector);
 	void removeConnector(OscConnector* connector);
 	void setOnOscValueChanged(std::function<void()> onOscValueChanged);
 
 	// Called by nodes
-	void sendMessage(const OscNode* node, const OscArgument* argument, size_t number);
+	// subAddress: appended to the node address, for values without their own node
+	// From the audio processing, only the node and subAddress are queued and the main loop sends the value then
+	// (flushMessages), subAddress must stay valid.
+	void sendMessage(OscNode* node, const OscArgument* argument, size_t number, std::string_view subAddress = {});
+	void sendBlobMessage(OscNode* node, const uint8_t* data, size_t size);
+
+	// Sent messages are accumulated in bundles, this sends them to connectors (once per main loop iteration) after the
+	// values changed by the audio processing
+	void flushMessages();
+	// State messages a connector couldn't take, their values are dumped again
+	uint32_t getDroppedStateMessageCount() const { return droppedStateMessageCount; }
 	bool isOscValueAuthority();
 	void notifyValueChanged();
 
 	void addPendingConfigNode(OscNode* node);
 	void nodeRemoved(OscNode* node);
-	void loadNodeConfig(const std::map<std::string_view, std::vector<OscArgument>>& configValues);
+
+	// Configuration value of the node with the given address hash (OscNode::hashAddress of the full address)
+	struct ConfigValue {
+		uint32_t addressHash;
+		OscArgument value;
+	};
+	// Execute the configuration values on nodes waiting for their configuration. values are sorted in place.
+	void loadNodeConfig(ConfigValue* values, size_t count);
 
 	static std::string getArgumentVectorAsString(const OscArgument* arguments, size_t number);
 
+	// Messages of bundles with a timetag are queued until the audio processing reaches their time. Only parameter
+	// messages (isAudioParameter) can be scheduled, others are refused.
+	static constexpr size_t SCHEDULED_MESSAGE_NUMBER = 16;
+	static constexpr size_t SCHEDULED_MESSAGE_MAX_SIZE = 112;
+	static constexpr uint64_t NO_SCHEDULED_MESSAGE = UINT64_MAX;
+
+	// Maximum number of arguments of a received message, the argument vector is reused without reallocation
+	static constexpr size_t MAX_ARGUMENTS = 16;
+
+	uint64_t getNextScheduledTimetag() const;
+	// Execute all queued messages with a timetag lower or equal to the given one, called by the audio processing
+	void executeScheduledMessages(uint64_t timetag);
+
+	// Value changes notified by the audio processing, sent by the main loop
+	static constexpr size_t DEFERRED_NOTIFICATION_NUMBER = 32;
+
+	// When audio processing runs in an interrupt, parameter messages (isAudioParameter) are queued and executed at the
+	// start of the next audio block so parameters are never changed while a block is processed.
+	// Other messages (requests, allocations, reconfigurations) are executed by the main loop once the messages
+	// received before them are executed, with the audio processing held off. A packet that can't be queued or executed
+	// yet is received again later, received messages are never executed out of order.
+	static constexpr size_t RECEIVED_MESSAGE_NUMBER = 16;
+	static constexpr size_t RECEIVED_MESSAGE_MAX_SIZE = 128;
+
+	void enableReceivedMessageQueue() { receivedMessageQueueEnabled = true; }
+	// Called by the main loop with true before using nodes that the audio processing may use, then with false
+	void setHoldAudioProcessing(std::function<void(bool)> holdAudioProcessing);
+	// Called from the audio interrupt, does nothing while the main loop uses the OscRoot
+	void executeReceivedMessages();
+
+	// True while the main loop uses the OscRoot (sending, receiving), the audio interrupt must not use it then.
+	// Scheduled messages are not reported as due while busy.
+	bool isBusy() const { return busyCount.load(std::memory_order_relaxed) != 0; }
+
+	// Hold while using nodes from the main loop outside of the OscRoot entry points
+	class BusyGuard {
+	public:
+		BusyGuard(OscRoot* root) : root(root) { root->busyCount++; }
+		~BusyGuard() { root->busyCount--; }
+
+	private:
+		OscRoot* root;
+	};
+
+	// Changed when configurable nodes are added or removed
+	uint32_t getConfigNodesGeneration() const { return configNodesGeneration; }
+
+	// Called by value nodes when their value changes, from the main loop or the audio interrupt
+	uint32_t nextChangeSequence() { return changeSequence.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+	// Rolling checksum of the state: XOR of the state hash of all value nodes (OscNode::hashState), updated by value
+	// nodes when their value changes so a client can check its copy of the state without a full transfer.
+	void replaceStateHash(uint32_t oldHash, uint32_t newHash) {
+		stateChecksum.fetch_xor(oldHash ^ newHash, std::memory_order_relaxed);
+	}
+	uint32_t getStateChecksum() const { return stateChecksum.load(std::memory_order_relaxed); }
+
+	// Dumps are done by a cursor in the tree, a few nodes per call to dumpSlice. Once done, the dumped container
+	// replies with the change sequence number at the start of the dump (OscContainer::sendDumpEnd).
+	// onlyChanged: only dump values changed after sinceSequence
+	// Sync: skip telemetry nodes and reply on /sync with the sequence number and the state checksum
+	// Schema: send the metadata of values instead of values (OscNode::dumpSchema), reply on /schema
+	enum class DumpType : uint8_t { Values, Sync, Schema };
+	static constexpr size_t DUMP_REQUEST_NUMBER = 4;
+	static constexpr size_t DUMP_SLICE_NODES = 32;
+	void requestDump(OscContainer* container,
+	                 bool onlyChanged,
+	                 uint32_t sinceSequence,
+	                 DumpType type = DumpType::Values);
+	// Main loop task, return false when there is nothing to dump or connectors are congested
+	bool dumpSlice();
+
+	// Storage of the message headers cached by telemetry nodes (OscNode::getMessageHeader), allocated with the root so
+	// sending telemetry doesn't allocate once the heap is frozen. Return nullptr when full, the node then sends its
+	// messages without a cached header.
+	static constexpr size_t MESSAGE_HEADER_STORAGE_SIZE = 2048;
+	char* allocateMessageHeader(size_t size);
+
+	// Called by value nodes from dumpSchema: "/schema <address> <type> <min> <max> <unit> <smoothing> [<enum labels>]"
+	// type is the OSC type tag of the value ("T" for booleans).
+	void sendSchema(OscNode* node, std::string_view subAddress, char type, const OscMetadata& metadata);
 protected:
-	void executeMessage(tosc_message_const* osc);
+	// arguments: storage reserved for the calling context (main loop or audio processing)
+	void executeMessage(tosc_message_const* osc, std::vector<OscArgument>& arguments);
+	// Return false when the message can't be queued or executed yet
+	bool executeOrQueueMessage(tosc_message_const* osc);
+	// True when the messages received before are executed, the audio processing is then held off by
+	// holdAudioProcessing to execute a message in the main loop
+	bool canExecuteInMainLoop() const { return !receivedMessageQueueEnabled || receivedMessageQueue.empty(); }
+	void holdAudioProcessing(bool hold);
+	bool writeMessageHeader(tosc_message* osc, OscNode* node, const char* format, std::string_view subAddress = {});
+	void queueMessage(const OscNode* node, const uint8_t* data, size_t size, bool isTelemetry);
+	bool scheduleMessage(uint64_t timetag, const tosc_message_const* osc);
+	// Nodes executed by the audio processing don't send messages, their value is sent by the main loop
+	void beginAudioExecution();
+	void endAudioExecution();
+	void deferNotification(OscNode* node, std::string_view subAddress);
+	// skippedNode: node being removed, notifications of its subtree are dropped
+	void sendDeferredNotifications(const OscNode* skippedNode = nullptr);
 	OscRoot* getRoot() override;
+	// values must be sorted by address hash
+	static const ConfigValue* findConfigValue(const ConfigValue* values, size_t count, uint32_t addressHash);
 
 private:
 	std::set<OscConnector*> connectors;
+	// Reserved once, addresses are built in it
 	std::string nodeFullAddress;
 	std::unique_ptr<uint8_t[]> oscOutputMessage;
 	size_t oscOutputMaxSize;
+	std::unique_ptr<char[]> messageHeaderStorage;
+	size_t messageHeaderStorageUsed = 0;
+	bool messageHeaderStorageFull = false;
 	std::function<void()> onOscValueChanged;
 	bool doNotifyOscAtInit;
 
-	std::set<OscNode*> nodesPendingConfig;
+	// nextPendingConfig of the root is the head of the list of nodes waiting for their configuration, the last node
+	// points back to the root
+
+	// Arguments of executed messages, reserved once. The audio processing has its own as it can preempt the main loop
+	// while it executes a message.
+	std::vector<OscArgument> receivedArguments;
+	std::vector<OscArgument> audioArguments;
+
+	// "#bundle\0" followed by the timetag
+	static constexpr size_t BUNDLE_HEADER_SIZE = 16;
+	struct OutputBundle {
+		static constexpr size_t MAX_SIZE = 512;
+		uint8_t data[MAX_SIZE] __attribute__((aligned(4)));
+		size_t size;  // 0 when empty
+	};
+	void flushBundle(OutputBundle& bundle, bool isTelemetry);
+	void sendToConnectors(const uint8_t* data, size_t size, bool isTelemetry);
+
+	// Value changes, always sent
+	OutputBundle stateBundle;
+	// Telemetry, a new value of a node replaces the queued one
+	OutputBundle telemetryBundle;
+	struct QueuedTelemetry {
+		const OscNode* node;
+		uint16_t offset;
+		uint16_t size;
+	};
+	static constexpr size_t MAX_QUEUED_TELEMETRY = 32;
+	QueuedTelemetry queuedTelemetry[MAX_QUEUED_TELEMETRY];
+	size_t queuedTelemetryCount = 0;
+
+	// Change sequence at the last two flushes, values in the state messages sent since the last flush changed after
+	// previousFlushSequence
+	uint32_t flushSequence = 0;
+	uint32_t previousFlushSequence = 0;
+	uint32_t droppedStateMessageCount = 0;
+
+	std::atomic<uint32_t> busyCount{0};
+	uint32_t configNodesGeneration = 0;
+
+	std::atomic<uint32_t> changeSequence{0};
+	std::atomic<uint32_t> stateChecksum{0};
+
+	// The first request is the active one
+	struct DumpRequest {
+		OscContainer* container;
+		bool onlyChanged;
+		DumpType type;
+		uint32_t sinceSequence;
+	};
+	DumpRequest dumpRequests[DUMP_REQUEST_NUMBER];
+	size_t dumpRequestCount = 0;
+	// Next node to dump, nullptr when the active dump is not started yet
+	OscNode* dumpCursor = nullptr;
+	uint32_t dumpStartSequence = 0;
+	void removeDumpRequest(size_t index);
+
+	// "/sync [sequence]": without argument, send all state values. With a sequence number, only values changed after
+	// it. Replies "/sync <sequence> <checksum>" once done, the sequence number to use for the next sync.
+	OscEndpoint oscSync;
+
+	// "/schema": send the metadata of all described values, then "/schema <number of values>"
+	OscEndpoint oscSchema;
+	std::string schemaAddress;
+	uint32_t schemaValueCount = 0;
+
+	struct ReceivedMessage {
+		uint32_t size;
+		char data[RECEIVED_MESSAGE_MAX_SIZE] __attribute__((aligned(4)));
+	};
+	SpscQueue<ReceivedMessage, RECEIVED_MESSAGE_NUMBER> receivedMessageQueue;
+	bool receivedMessageQueueEnabled = false;
+	std::function<void(bool)> holdAudioProcessingFunction;
+	// Messages of the packet being received executed or queued by previous calls, skipped when it is received again
+	size_t receivedPacketProgress = 0;
+
+	struct ScheduledMessage {
+		uint64_t timetag;
+		uint32_t size;
+		char data[SCHEDULED_MESSAGE_MAX_SIZE] __attribute__((aligned(4)));
+	};
+	ScheduledMessage scheduledMessages[SCHEDULED_MESSAGE_NUMBER];
+	// Slot indexes sorted by timetag, messages with the same timetag keep their reception order
+	uint8_t scheduledMessageOrder[SCHEDULED_MESSAGE_NUMBER];
+	size_t scheduledMessageCount = 0;
+	uint32_t scheduledMessageUsedSlots = 0;
+
+	// True while the audio processing executes messages, only read from that context
+	bool isAudioExecution = false;
+	uint32_t audioExecutionSequence = 0;
+	struct DeferredNotification {
+		OscNode* node;
+		std::string_view subAddress;
+	};
+	SpscQueue<DeferredNotification, DEFERRED_NOTIFICATION_NUMBER> deferredNotifications;
+	// When the queue is full, values changed after lostNotificationSequence are dumped instead (only changed values,
+	// a refused value set by a client is not sent back then)
+	std::atomic<bool> notificationsLost{false};
+	uint32_t lostNotificationSequence = 0;
+	std::atomic<bool> valueChangedPending{false};
 };
 
 class OscConnector {
@@ -59,11 +284,30 @@ public:
 	OscConnector(OscRoot* oscRoot, bool useSlipProtocol);
 	virtual ~OscConnector();
 
-	void sendOscMessage(const uint8_t* data, size_t size);
+	// Return false when the connector couldn't take the message
+	bool sendOscMessage(const uint8_t* data, size_t size);
+
+	// Rate limiting of telemetry bundles: return false to drop them (they will be replaced by newer values)
+	virtual bool canSendTelemetry(size_t size) { return true; }
+
+	// Received SLIP frames are decoded in place in a fixed buffer, bigger frames are discarded
+	static constexpr size_t MAX_FRAME_SIZE = 128;
 
 protected:
-	void onOscDataReceived(const uint8_t* data, size_t size);
+	// Return the number of bytes processed, less than size when the OscRoot can't queue more messages
+	size_t onOscDataReceived(const uint8_t* data, size_t size);
 	virtual void sendOscData(const uint8_t* data, size_t size) = 0;
+	// Default implementation encodes the frame in a temporary buffer then calls sendOscData.
+	// Return false when the frame is dropped because the output is congested.
+	virtual bool sendSlipFrame(const uint8_t* data, size_t size);
+
+	static constexpr uint8_t SLIP_END = 0xC0;
+	static constexpr uint8_t SLIP_ESC = 0xDB;
+	static constexpr uint8_t SLIP_ESC_END = 0xDC;
+	static constexpr uint8_t SLIP_ESC_ESC = 0xDD;
+
+	// Encode a SLIP frame with double-END variant (one at the start, one at the end), calling put for each byte
+	template<class PutFunction> static void encodeSlip(const uint8_t* data, size_t size, PutFunction put);
 
 	OscRoot* getOscRoot() { return oscRoot; }
 
@@ -71,7 +315,28 @@ private:
 	OscRoot* oscRoot;
 	bool useSlipProtocol;
 	bool oscIsEscaping;
-	std::vector<uint8_t> oscInputBuffer;
+	uint8_t oscInputBuffer[MAX_FRAME_SIZE] __attribute__((aligned(4)));
+	size_t oscInputSize;
 	std::vector<uint8_t> oscOutputBuffer;
 	bool discardNextMessage;
 };
+
+template<class PutFunction> void OscConnector::encodeSlip(const uint8_t* data, size_t size, PutFunction put) {
+	put(SLIP_END);
+
+	for(size_t i = 0; i < size; i++) {
+		const uint8_t c = data[i];
+
+		if(c == SLIP_END) {
+			put(SLIP_ESC);
+			put(SLIP_ESC_END);
+		} else if(c == SLIP_ESC) {
+			put(SLIP_ESC);
+			put(SLIP_ESC_ESC);
+		} else {
+			put(c);
+		}
+	}
+
+	put(SLIP_END);
+}
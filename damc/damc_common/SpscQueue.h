@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Lock-free single producer, single consumer queue of fixed slots.
+ * Items are written in place: the producer fills the slot returned by getWriteSlot() then calls push(), the consumer
+ * reads the slot returned by front() then calls pop().
+ * The producer and the consumer can preempt each other (main loop and interrupt).
+ */
+template<typename T, size_t N> class SpscQueue {
+public:
+	static_assert((N & (N - 1)) == 0, "N must be a power of two");
+
+	bool full() const { return writeIndex.load(std::memory_order_relaxed) - readIndex.load(std::memory_order_acquire) >= N; }
+	bool empty() const { return readIndex.load(std::memory_order_relaxed) == writeIndex.load(std::memory_order_acquire); }
+
+	// Producer side, only valid when not full
+	T& getWriteSlot() { return items[writeIndex.load(std::memory_order_relaxed) % N]; }
+	void push() { writeIndex.store(writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+	// Consumer side, only valid when not empty
+	T& front() { return items[readIndex.load(std::memory_order_relaxed) % N]; }
+	void pop() { readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+private:
+	T items[N];
+	std::atomic<uint32_t> writeIndex{0};
+	std::atomic<uint32_t> readIndex{0};
+};
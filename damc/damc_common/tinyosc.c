@@ -279,7 +279,7 @@ uint32_t tosc_writeNextStringView(tosc_message* o, const char* value, int size)
 }
 
 uint32_t tosc_writeNextBlob(tosc_message* o, const char* buffer, int len) {
-	int padded_len = (4 + len) & ~0x3;
+	int padded_len = (len + 3) & ~0x3;  // unlike strings, blobs have no null terminator
 
 	if(o->marker + padded_len + 4 > o->buffer_end)
 		return -3;
@@ -2,9 +2,11 @@
 #include "AudioProcessor.h"
 #include "TimeMeasure.h"
 #include "CodecAudio.h"
+#include "MemoryArena.h"
 
 void DAMC_init() {
 	// This will allocate instance
+	MemoryArena::setSubsystem(MemoryArena::Subsystem::Osc);
 	AudioProcessor::getInstance();
 	TimeMeasure::updateClockPerUs();
 }
@@ -12,6 +14,9 @@ void DAMC_init() {
 void DAMC_start() {
 	AudioProcessor::getInstance()->init();
 	CodecAudio::instance.start();
+
+	// Everything is allocated, later allocations are counted
+	MemoryArena::freeze();
 }
 
 void DAMC_processAudioInterleaved(const int16_t** input_endpoints, size_t input_endpoints_number, int16_t** output_endpoints, size_t output_endpoints_number, size_t nframes) {
@@ -20,7 +25,6 @@ void DAMC_processAudioInterleaved(const int16_t** input_endpoints, size_t input_
 
 void DAMC_mainLoop() {
 	AudioProcessor::getInstance()->mainLoop();
-	CodecAudio::instance.onFastTimer();
 }
 
 void DAMC_usbInterruptBeginMeasure() {
@@ -6,7 +6,7 @@
 #include "TimeMeasure.h"
 #include <CodecAudio.h>
 #include <vector>
-#include <map>
+#include <iterator>
 
 #include <spdlog/spdlog.h>
 
@@ -17,8 +17,12 @@
 volatile AudioProcessor* audio_processor;
 
 MultiChannelAudioBuffer::MultiChannelAudioBuffer() {
+	setSegment(0);
+}
+
+void MultiChannelAudioBuffer::setSegment(size_t offset) {
 	for(size_t i = 0; i < CHANNEL_NUMBER; i++) {
-		dataPointers[i] = data[i];
+		dataPointers[i] = data[i] + offset;
 	}
 }
 
@@ -33,6 +37,10 @@ AudioProcessor::AudioProcessor(uint32_t numChannels, uint32_t sampleRate, size_t
 	  oscRoot(true),
 	  serialClient(&oscRoot),
 	  strips(&oscRoot, "strip"),
+	  crossfeed(&oscRoot),
+	  generator(&oscRoot),
+	  measurement(&oscRoot),
+	  clock(&oscRoot, "clock"),
 	  timeMeasureUsbInterrupt(&oscRoot, "timeUsbInterrupt"),
 	  timeMeasureAudioProcessing(&oscRoot, "timeAudioProc"),
 	  timeMeasureFastTimer(&oscRoot, "timeFastTimer"),
@@ -41,12 +49,27 @@ AudioProcessor::AudioProcessor(uint32_t numChannels, uint32_t sampleRate, size_t
 	  timeMeasureMaxPerLoopAudioProcessing(&oscRoot, "timePerLoopAudioProc"),
 	  timeMeasureMaxPerLoopFastTimer(&oscRoot, "timePerLoopFastTimer"),
 	  timeMeasureMaxPerLoopOscInput(&oscRoot, "timePerLoopOscInput"),
+	  timeToFirstAudioBlock(&oscRoot, "timeToFirstAudioBlock"),
+	  firstAudioBlockTime(0),
+	  oscDroppedStateMessages(&oscRoot, "oscDroppedStateMessages"),
 	  memoryAvailable(&oscRoot, "memoryAvailable"),
 	  memoryUsed(&oscRoot, "memoryUsed"),
-	  fastTimerPreviousTick(0),
+	  memoryArenaStatistics(&oscRoot),
+	  scheduler(&oscRoot),
+	  configStorage(&oscRoot),
 	  nextTimerStripIndex(0),
-	  slowTimerPreviousTick(0),
-	  slowTimerIndex(0)
+	  slowTimerIndex(0),
+	  nextBackgroundStripIndex(0),
+	  oscScene(&oscRoot, "scene"),
+	  oscSceneBegin(&oscScene, "begin"),
+	  oscSceneCommit(&oscScene, "commit"),
+	  sceneOpen(false),
+	  sceneBeginTime(0),
+	  pendingStripMask(0),
+	  publishedParametersGeneration(0),
+	  appliedParametersGeneration(0),
+	  sampleRate(sampleRate),
+	  sampleClock(0)
 {
 	strips.setFactory([this, numChannels, sampleRate, maxNframes](OscContainer* parent, int index) {
 		using namespace std::literals;
@@ -75,28 +98,100 @@ AudioProcessor::AudioProcessor(uint32_t numChannels, uint32_t sampleRate, size_t
 		return new ChannelStrip(parent, index, name, numChannels, sampleRate, maxNframes);
 	});
 
+	MemoryArena::setSubsystem(MemoryArena::Subsystem::Strips);
 	strips.resize(5);
 
+	MemoryArena::setSubsystem(MemoryArena::Subsystem::Effects);
+	crossfeed.reset(sampleRate);
+	generator.reset(sampleRate);
+	measurement.reset(sampleRate);
+	MemoryArena::setSubsystem(MemoryArena::Subsystem::Osc);
+
+	// Device time for timetagged bundles: seconds and fraction (as int32) of the NTP timetag
+	clock.setReadCallback([this]() -> std::vector<int32_t> {
+		uint64_t timetag = samplesToTimetag(sampleClock);
+		return {(int32_t) (timetag >> 32), (int32_t) (timetag & 0xFFFFFFFF)};
+	});
+
+	// Scene endpoints are executed by the main loop after the parameters received before them, so scenes are
+	// delimited in the same order
+	oscSceneBegin.setCallback([this](const auto&) {
+		sceneBeginTime = TimeMeasure::getCurrent();
+		sceneOpen = true;
+	});
+	oscSceneCommit.setCallback([this](const auto&) { sceneOpen = false; });
+
 	serialClient.init();
+
+	// Can erase flash, which stalls the CPU, so done before USB and audio are started
+	MemoryArena::setSubsystem(MemoryArena::Subsystem::Config);
+	configStorage.prepare();
+	MemoryArena::setSubsystem(MemoryArena::Subsystem::Osc);
+
+	// Main loop tasks, in priority order. Meters of one strip are updated per run to update all strips every 100ms.
+	scheduler.addTask("codec", 0, 0, 20, []() { return CodecAudio::instance.onFastTimer(); });
+	scheduler.addTask("oscInput", 1, 0, 150, [this]() { return serialClient.mainLoop(); });
+	scheduler.addTask("parameters", 1, 0, 100, [this]() { return compileParameters(); });
+	scheduler.addTask("meters", 2, 100000 / strips.size(), 100, [this]() { return onFastTimer(); });
+	scheduler.addTask("stats", 3, 1000000 / SLOW_TIMER_STEPS, 50, [this]() { return onSlowTimer(); });
+	scheduler.addTask("oscDump", 3, 0, 100, [this]() { return oscRoot.dumpSlice(); });
+	scheduler.addTask("oscFlush", 4, 0, 100, [this]() {
+		oscRoot.flushMessages();
+		return false;
+	});
+	scheduler.addTask("background", 5, 0, 100, [this]() { return processBackgroundSlice(); });
+	scheduler.addTask("config", 6, 0, 100, [this]() { return configStorage.persistSlice(); });
 }
 
 AudioProcessor::~AudioProcessor() {}
 
 void AudioProcessor::init() {
 	using namespace std::literals;
-	const std::map<std::string_view, std::vector<OscArgument>> default_config = {
-		{"/strip/1/filterChain/compressorFilter/makeUpGain", {float{-1.f}}},
-		{"/strip/0/display_name", {"master"sv}},
-		{"/strip/1/display_name", {"comp"sv}},
-		{"/strip/2/display_name", {"mic"sv}},
-		{"/strip/3/display_name", {"out-record"sv}},
-		{"/strip/4/display_name", {"mic-feedback"sv}},
-		{"/strip/1/filterChain/compressorFilter/enable", {true}},
-		{"/strip/3/filterChain/mute", {true}},
-		{"/strip/4/filterChain/mute", {true}},
+	// Nodes are matched by address hash, no address string is built when loading
+	OscRoot::ConfigValue default_config[] = {
+		{OscNode::hashAddress("/strip/1/filterChain/compressorFilter/makeUpGain"), float{-1.f}},
+		{OscNode::hashAddress("/strip/0/display_name"), "master"sv},
+		{OscNode::hashAddress("/strip/1/display_name"), "comp"sv},
+		{OscNode::hashAddress("/strip/2/display_name"), "mic"sv},
+		{OscNode::hashAddress("/strip/3/display_name"), "out-record"sv},
+		{OscNode::hashAddress("/strip/4/display_name"), "mic-feedback"sv},
+		{OscNode::hashAddress("/strip/1/filterChain/compressorFilter/enable"), true},
+		{OscNode::hashAddress("/strip/3/filterChain/mute"), true},
+		{OscNode::hashAddress("/strip/4/filterChain/mute"), true},
+
+		// Remove the digital mic DC offset before it reaches the dynamics and the peak meter
+		{OscNode::hashAddress("/strip/2/filterChain/dcBlocker"), true},
+
+		// De-esser on mic: dynamic peak band on sibilance frequencies
+		{OscNode::hashAddress("/strip/2/filterChain/eqFilters/5/type"), (int32_t) FilterType::Peak},
+		{OscNode::hashAddress("/strip/2/filterChain/eqFilters/5/f0"), 6500.f},
+		{OscNode::hashAddress("/strip/2/filterChain/eqFilters/5/Q"), 2.f},
+		{OscNode::hashAddress("/strip/2/filterChain/eqFilters/5/gain"), 0.f},
+		{OscNode::hashAddress("/strip/2/filterChain/eqFilters/5/dynamic"), true},
+		{OscNode::hashAddress("/strip/2/filterChain/eqFilters/5/threshold"), -30.f},
+		{OscNode::hashAddress("/strip/2/filterChain/eqFilters/5/ratio"), 4.f},
+		{OscNode::hashAddress("/strip/2/filterChain/eqFilters/5/attackTime"), 0.001f},
+		{OscNode::hashAddress("/strip/2/filterChain/eqFilters/5/releaseTime"), 0.05f},
+		{OscNode::hashAddress("/strip/2/filterChain/eqFilters/5/enable"), true},
 	};
 
-	oscRoot.loadNodeConfig(default_config);
+	MemoryArena::setSubsystem(MemoryArena::Subsystem::Config);
+	oscRoot.loadNodeConfig(default_config, std::size(default_config));
+	// Persisted values override the defaults
+	configStorage.restore();
+	MemoryArena::setSubsystem(MemoryArena::Subsystem::Strips);
+
+	// Audio processing is not started yet, use the initial parameters directly
+	for(auto& strip : strips) {
+		if(strip->compileParameters())
+			strip->swapParameters();
+	}
+
+	// Audio processing preempts the main loop from now on: received parameters are applied between audio blocks,
+	// other messages are executed by the main loop with the audio interrupt masked.
+	// PendSV has the lowest priority, so BASEPRI only masks it, USB and codec interrupts still run.
+	oscRoot.setHoldAudioProcessing([](bool hold) { __set_BASEPRI(hold ? 15 << (8 - __NVIC_PRIO_BITS) : 0); });
+	oscRoot.enableReceivedMessageQueue();
 }
 
 void AudioProcessor::interleavedToFloat(const int16_t* data_input, MultiChannelAudioBuffer* data_float, size_t nframes) {
@@ -119,18 +214,94 @@ void AudioProcessor::floatToInterleaved(MultiChannelAudioBuffer* data_float, int
 void AudioProcessor::mixAudio(MultiChannelAudioBuffer* mixed_data, MultiChannelAudioBuffer* data_to_add, size_t nframes) {
 	for(uint32_t channel = 0; channel < numChannels; channel++) {
 		for(uint32_t frame = 0; frame < nframes; frame++) {
-			mixed_data->data[channel][frame] += data_to_add->data[channel][frame];
+			mixed_data->dataPointers[channel][frame] += data_to_add->dataPointers[channel][frame];
 		}
 	}
 }
 
+void AudioProcessor::processStrip(size_t index, MultiChannelAudioBuffer* data, size_t nframes) {
+	if(generator.getTargetStrip() == (int32_t) index)
+		generator.processSamples(data->dataPointers, numChannels, nframes);
+
+	if(measurement.getOutputStrip() == (int32_t) index)
+		measurement.generateOutput(data->dataPointers, numChannels, nframes);
+	if(measurement.getInputStrip() == (int32_t) index)
+		measurement.captureInput(data->dataPointers, nframes);
+
+	strips.at(index).processSamples(data->dataPointers, numChannels, nframes);
+}
+
+void AudioProcessor::processSegment(size_t offset, size_t nframes) {
+	for(MultiChannelAudioBuffer& data : buffer) {
+		data.setSegment(offset);
+	}
+
+	// Process comp
+	processStrip(1, &buffer[0], nframes);
+
+	// Mix OUT 0 with compressed (by strip 1) OUT 1
+	mixAudio(&buffer[1], &buffer[0], nframes);
+
+	// Process master
+	processStrip(0, &buffer[1], nframes);
+
+	// Copy output as it has multiple destination
+	for(uint32_t channel = 0; channel < numChannels; channel++) {
+		memcpy(buffer[2].dataPointers[channel], buffer[1].dataPointers[channel], nframes * sizeof(float));
+	}
+
+	// Process out-record for IN 0
+	processStrip(3, &buffer[1], nframes);
+
+	// Process mic
+	processStrip(2, &buffer[3], nframes);
+
+	// Mic mic and out-record into IN 0
+	mixAudio(&buffer[1], &buffer[3], nframes);
+
+	// Process mic-feedback
+	processStrip(4, &buffer[4], nframes);
+
+	// Mix mic-feedback with master
+	mixAudio(&buffer[2], &buffer[4], nframes);
+
+	// Headphones crossfeed
+	crossfeed.processSamples(buffer[2].dataPointers, nframes);
+}
+
+uint64_t AudioProcessor::samplesToTimetag(uint64_t samples) {
+	// NTP format: 32 bits of seconds, 32 bits of fraction
+	uint64_t seconds = samples / sampleRate;
+	uint64_t fraction = ((samples % sampleRate) << 32) / sampleRate;
+	return (seconds << 32) | fraction;
+}
+
+uint64_t AudioProcessor::timetagToSamples(uint64_t timetag) {
+	if(timetag == OscRoot::NO_SCHEDULED_MESSAGE)
+		return UINT64_MAX;
+
+	// Round up so a timetag from samplesToTimetag gives back the same sample
+	uint64_t fractionSamples = ((timetag & 0xFFFFFFFF) * sampleRate + 0xFFFFFFFF) >> 32;
+	return (timetag >> 32) * sampleRate + fractionSamples;
+}
+
 void AudioProcessor::processAudioInterleaved(
 		const int16_t** input_endpoints,
 		size_t input_endpoints_number,
 		int16_t** output_endpoints,
 		size_t output_endpoints_number,
 		size_t nframes) {
+	scheduler.onAudioBlock();
 	TimeMeasure::timeMeasureAudioProcessing.beginMeasure();
+
+	if(firstAudioBlockTime.load(std::memory_order_relaxed) == 0) {
+		// Keep it non zero, 1 tick doesn't matter
+		firstAudioBlockTime.store(TimeMeasure::getCurrent() | 1, std::memory_order_relaxed);
+	}
+
+	// Apply parameter changes received since the previous block
+	oscRoot.executeReceivedMessages();
+	applyCompiledParameters();
 	/**
 	 * Legend:
 	 *  - OUT/IN: USB endpoints (OUT = from PC to codec, IN = from codec to PC)
@@ -155,33 +326,16 @@ void AudioProcessor::processAudioInterleaved(
 	 * Intermediate variables:
 	 *  - #0: OUT 1 processing
 	 *  - #1: OUT 0 processing then mix of OUT 0 + OUT 1 then out-record processing then IN 0
-	 *  - #2: Codec Headphones mix
+	 *  - #2: Codec Headphones mix (then crossfeed)
 	 *  - #3: Codec MIC input then MIC processing (then added into buffer #1)
 	 *  - #4: Copy of codec MIC input then mic-feedback processing (then added into buffer #2)
 	 *
 	 */
 
-	// Import endpoint OUT 1 (compressed audio) into float
+	// Import all inputs into float
 	interleavedToFloat(input_endpoints[1], &buffer[0], nframes);
-
-	// Process comp
-	strips.at(1).processSamples(buffer[0].dataPointers, numChannels, nframes);
-
-	// Import endpoint OUT 0 into float
 	interleavedToFloat(input_endpoints[0], &buffer[1], nframes);
 
-	// Mix OUT 0 with compressed (by strip 1) OUT 1
-	mixAudio(&buffer[1], &buffer[0], nframes);
-
-	// Process master
-	strips.at(0).processSamples(buffer[1].dataPointers, numChannels, nframes);
-
-	// Copy output as it has multiple destination
-	memcpy(&buffer[2].data, &buffer[1].data, sizeof(buffer[1].data));
-
-	// Process out-record for IN 0
-	strips.at(3).processSamples(buffer[1].dataPointers, numChannels, nframes);
-
 	// Get codec MIC data
 	CodecAudio::instance.processAudioInterleavedInput(codecBuffer, nframes);
 	interleavedToFloat(codecBuffer, &buffer[3], nframes);
@@ -189,22 +343,30 @@ void AudioProcessor::processAudioInterleaved(
 	// Copy codec MIC audio as it has multiple destination
 	memcpy(&buffer[4].data, &buffer[3].data, sizeof(buffer[3].data));
 
+	// Split the block at each timetagged OSC message so it applies at its exact sample
+	size_t offset = 0;
+	while(offset < nframes) {
+		uint64_t nextMessageTime = timetagToSamples(oscRoot.getNextScheduledTimetag());
+		uint64_t currentTime = sampleClock + offset;
 
-	// Process mic
-	strips.at(2).processSamples(buffer[3].dataPointers, numChannels, nframes);
+		if(nextMessageTime <= currentTime) {
+			oscRoot.executeScheduledMessages(samplesToTimetag(currentTime));
+			applyScheduledParameters();
+			continue;
+		}
 
-	// Mic mic and out-record into IN 0
-	mixAudio(&buffer[1], &buffer[3], nframes);
+		size_t count = nframes - offset;
+		if(nextMessageTime < currentTime + count)
+			count = nextMessageTime - currentTime;
+
+		processSegment(offset, count);
+		offset += count;
+	}
+	sampleClock += nframes;
 
 	// Output float data to USB endpoint IN 0
 	floatToInterleaved(&buffer[1], output_endpoints[0], nframes);
 
-	// Process mic-feedback
-	strips.at(4).processSamples(buffer[4].dataPointers, numChannels, nframes);
-
-	// Mix mic-feedback with master
-	mixAudio(&buffer[2], &buffer[4], nframes);
-
 	// Output float data to codec headphones
 	floatToInterleaved(&buffer[2], codecBuffer, nframes);
 
@@ -219,58 +381,145 @@ extern "C" uint8_t _end; // end of static data in RAM (start of heap)
 extern "C" uint8_t _estack; // start of RAM (end of RAM as stack grows backward)
 extern "C" uint8_t _Min_Stack_Size; // minimal stack size
 void AudioProcessor::mainLoop() {
-	// Do at most one thing to avoid taking too much time here
-	if(serialClient.mainLoop())
-		return;
+	scheduler.runOnce();
+
+	TimeMeasure::timeMeasureUsbInterrupt.endAudioLoop();
+	TimeMeasure::timeMeasureAudioProcessing.endAudioLoop();
+	TimeMeasure::timeMeasureFastTimer.endAudioLoop();
+	TimeMeasure::timeMeasureOscInput.endAudioLoop();
+}
 
-	uint32_t currentTick = HAL_GetTick();
-	// Do onFastTimer every 100ms
-	// Process one strip at a time to avoid taking too much time
-	if(currentTick >= fastTimerPreviousTick + (100/strips.size())) {
-		TimeMeasure::timeMeasureFastTimer.beginMeasure();
+bool AudioProcessor::onFastTimer() {
+	TimeMeasure::timeMeasureFastTimer.beginMeasure();
 
-		fastTimerPreviousTick = currentTick;
-		strips.at(nextTimerStripIndex).onFastTimer();
-		nextTimerStripIndex++;
-		if(nextTimerStripIndex >= strips.size())
-			nextTimerStripIndex = 0;
+	strips.at(nextTimerStripIndex).onFastTimer();
+	nextTimerStripIndex++;
+	if(nextTimerStripIndex >= strips.size())
+		nextTimerStripIndex = 0;
 
-		TimeMeasure::timeMeasureFastTimer.endMeasure();
-	} else if(currentTick >= slowTimerPreviousTick + 1000/3) {
-		TimeMeasure::timeMeasureFastTimer.beginMeasure();
+	TimeMeasure::timeMeasureFastTimer.endMeasure();
 
-		slowTimerPreviousTick = currentTick;
+	return true;
+}
 
-		switch(slowTimerIndex) {
-		case 0:
-			timeMeasureUsbInterrupt.set(TimeMeasure::timeMeasureUsbInterrupt.getCumulatedTimeUsAndReset());
-			timeMeasureAudioProcessing.set(TimeMeasure::timeMeasureAudioProcessing.getCumulatedTimeUsAndReset());
-			timeMeasureFastTimer.set(TimeMeasure::timeMeasureFastTimer.getCumulatedTimeUsAndReset());
-			timeMeasureOscInput.set(TimeMeasure::timeMeasureOscInput.getCumulatedTimeUsAndReset());
-			break;
-		case 1:
-			timeMeasureMaxPerLoopUsbInterrupt.set(TimeMeasure::timeMeasureUsbInterrupt.getMaxTimeUsAndReset());
-			timeMeasureMaxPerLoopAudioProcessing.set(TimeMeasure::timeMeasureAudioProcessing.getMaxTimeUsAndReset());
-			timeMeasureMaxPerLoopFastTimer.set(TimeMeasure::timeMeasureFastTimer.getMaxTimeUsAndReset());
-			timeMeasureMaxPerLoopOscInput.set(TimeMeasure::timeMeasureOscInput.getMaxTimeUsAndReset());
-			break;
-		case 2:
-			OscArgument used_memory = static_cast<int32_t>((uint32_t)__sbrk_heap_end - (uint32_t)&_end);
-			memoryUsed.sendMessage(&used_memory, 1);
+bool AudioProcessor::onSlowTimer() {
+	TimeMeasure::timeMeasureFastTimer.beginMeasure();
+
+	switch(slowTimerIndex) {
+	case 0:
+		timeMeasureUsbInterrupt.set(TimeMeasure::timeMeasureUsbInterrupt.getCumulatedTimeUsAndReset());
+		timeMeasureAudioProcessing.set(TimeMeasure::timeMeasureAudioProcessing.getCumulatedTimeUsAndReset());
+		timeMeasureFastTimer.set(TimeMeasure::timeMeasureFastTimer.getCumulatedTimeUsAndReset());
+		timeMeasureOscInput.set(TimeMeasure::timeMeasureOscInput.getCumulatedTimeUsAndReset());
+		break;
+	case 1:
+		timeMeasureMaxPerLoopUsbInterrupt.set(TimeMeasure::timeMeasureUsbInterrupt.getMaxTimeUsAndReset());
+		timeMeasureMaxPerLoopAudioProcessing.set(TimeMeasure::timeMeasureAudioProcessing.getMaxTimeUsAndReset());
+		timeMeasureMaxPerLoopFastTimer.set(TimeMeasure::timeMeasureFastTimer.getMaxTimeUsAndReset());
+		timeMeasureMaxPerLoopOscInput.set(TimeMeasure::timeMeasureOscInput.getMaxTimeUsAndReset());
+		break;
+	case 2: {
+		OscArgument used_memory = static_cast<int32_t>((uint32_t)__sbrk_heap_end - (uint32_t)&_end);
+		memoryUsed.sendMessage(&used_memory, 1);
+
+		OscArgument available_memory = static_cast<int32_t>((uint32_t)&_estack - (uint32_t)&_Min_Stack_Size - (uint32_t)__sbrk_heap_end);
+		memoryAvailable.sendMessage(&available_memory, 1);
+
+		memoryArenaStatistics.update();
+		break;
+	}
+	case 3:
+		scheduler.updateStatistics();
+		oscDroppedStateMessages.set(oscRoot.getDroppedStateMessageCount());
+		// Only sent when it changes, so once
+		if(firstAudioBlockTime.load(std::memory_order_relaxed) != 0)
+			timeToFirstAudioBlock.set(TimeMeasure::ticksToUs(firstAudioBlockTime.load(std::memory_order_relaxed)));
+		break;
+	}
+	slowTimerIndex++;
+	if(slowTimerIndex >= SLOW_TIMER_STEPS)
+		slowTimerIndex = 0;
 
-			OscArgument available_memory = static_cast<int32_t>((uint32_t)&_estack - (uint32_t)&_Min_Stack_Size - (uint32_t)__sbrk_heap_end);
-			memoryAvailable.sendMessage(&available_memory, 1);
-			break;
+	TimeMeasure::timeMeasureFastTimer.endMeasure();
+
+	return true;
+}
+
+bool AudioProcessor::processBackgroundSlice() {
+	if(measurement.processBackgroundSlice())
+		return true;
+
+	// Background processing (spectrum FFT), one slice of one strip per loop
+	for(size_t i = 0; i < strips.size(); i++) {
+		ChannelStrip& strip = strips.at(nextBackgroundStripIndex);
+
+		nextBackgroundStripIndex++;
+		if(nextBackgroundStripIndex >= strips.size())
+			nextBackgroundStripIndex = 0;
+
+		if(strip.processBackgroundSlice())
+			return true;
+	}
+
+	return false;
+}
+
+bool AudioProcessor::compileParameters() {
+	// The previous generation is not used yet by the audio processing
+	if(publishedParametersGeneration.load(std::memory_order_relaxed) !=
+	   appliedParametersGeneration.load(std::memory_order_acquire))
+		return false;
+
+	if(sceneOpen) {
+		if((int32_t) (TimeMeasure::getCurrent() - sceneBeginTime) < (int32_t) TimeMeasure::usToTicks(SCENE_TIMEOUT_US))
+			return false;
+		sceneOpen = false;
+	}
+
+	uint32_t stripMask = 0;
+	for(size_t i = 0; i < strips.size(); i++) {
+		if(strips.at(i).compileParameters())
+			stripMask |= 1 << i;
+	}
+
+	if(stripMask == 0)
+		return false;
+
+	if(sceneOpen) {
+		// A scene started while compiling, compile again with the whole scene once committed
+		for(size_t i = 0; i < strips.size(); i++) {
+			if(stripMask & (1 << i))
+				strips.at(i).invalidateParameters();
 		}
-		slowTimerIndex++;
-		if(slowTimerIndex > 2)
-			slowTimerIndex = 0;
+		return true;
+	}
+
+	pendingStripMask = stripMask;
+	publishedParametersGeneration.store(publishedParametersGeneration.load(std::memory_order_relaxed) + 1,
+	                                    std::memory_order_release);
+
+	return true;
+}
 
-		TimeMeasure::timeMeasureFastTimer.endMeasure();
+void AudioProcessor::applyCompiledParameters() {
+	uint32_t generation = publishedParametersGeneration.load(std::memory_order_acquire);
+	if(generation == appliedParametersGeneration.load(std::memory_order_relaxed))
+		return;
+
+	for(size_t i = 0; i < strips.size(); i++) {
+		if(pendingStripMask & (1 << i))
+			strips.at(i).swapParameters();
 	}
 
-	TimeMeasure::timeMeasureUsbInterrupt.endAudioLoop();
-	TimeMeasure::timeMeasureAudioProcessing.endAudioLoop();
-	TimeMeasure::timeMeasureFastTimer.endAudioLoop();
-	TimeMeasure::timeMeasureOscInput.endAudioLoop();
+	appliedParametersGeneration.store(generation, std::memory_order_release);
+}
+
+void AudioProcessor::applyScheduledParameters() {
+	// Changes of an open scene are applied together at its commit
+	if(sceneOpen)
+		return;
+
+	for(auto& strip : strips) {
+		strip->compileActiveParameters();
+	}
 }
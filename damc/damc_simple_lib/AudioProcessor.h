@@ -1,17 +1,28 @@
 #pragma once
 
 #include "ChannelStrip.h"
+#include "ConfigStorage.h"
+#include "CrossfeedFilter.h"
+#include "LoopbackMeasurement.h"
+#include "MainLoopScheduler.h"
+#include "MemoryArena.h"
 #include "OscSerialClient.h"
 #include <FilteringChain.h>
 #include <Osc/OscReadOnlyVariable.h>
 #include <Osc/OscDynamicVariable.h>
+#include <Osc/OscEndpoint.h>
 #include <OscRoot.h>
+#include <SignalGenerator.h>
+#include <atomic>
 #include <stdint.h>
 
 class MultiChannelAudioBuffer {
 public:
 	MultiChannelAudioBuffer();
 
+	// Make dataPointers point to the samples starting at offset
+	void setSegment(size_t offset);
+
 	static constexpr size_t CHANNEL_NUMBER = 2;
 	static constexpr size_t BUFFER_SIZE = 48*2;
 
@@ -34,6 +45,25 @@ protected:
 	void interleavedToFloat(const int16_t* data_input, MultiChannelAudioBuffer* data_float, size_t nframes);
 	void floatToInterleaved(MultiChannelAudioBuffer* data_float, int16_t* data_output, size_t nframes);
 	void mixAudio(MultiChannelAudioBuffer* mixed_data, MultiChannelAudioBuffer* data_to_add, size_t nframes);
+	// Process a strip, with test signals injected into or captured from its input
+	void processStrip(size_t index, MultiChannelAudioBuffer* data, size_t nframes);
+	// Process the whole strip graph on nframes samples starting at offset of each buffer
+	void processSegment(size_t offset, size_t nframes);
+
+	// Main loop tasks
+	bool onFastTimer();
+	bool onSlowTimer();
+	bool processBackgroundSlice();
+	bool compileParameters();
+
+	// Swap the strip parameters compiled by compileParameters, at the start of an audio block
+	void applyCompiledParameters();
+	// Compile the parameters changed by timetagged messages, before the segment starting at their sample
+	void applyScheduledParameters();
+
+	// Device clock: the number of processed samples since boot
+	uint64_t samplesToTimetag(uint64_t samples);
+	uint64_t timetagToSamples(uint64_t timetag);
 
 private:
 	uint32_t numChannels;
@@ -41,6 +71,10 @@ private:
 	OscRoot oscRoot;
 	OscSerialClient serialClient;
 	OscContainerArray<ChannelStrip> strips;
+	CrossfeedFilter crossfeed;
+	SignalGenerator generator;
+	LoopbackMeasurement measurement;
+	OscDynamicVariable<int32_t> clock;
 
 	OscReadOnlyVariable<int32_t> timeMeasureUsbInterrupt;
 	OscReadOnlyVariable<int32_t> timeMeasureAudioProcessing;
@@ -52,13 +86,44 @@ private:
 	OscReadOnlyVariable<int32_t> timeMeasureMaxPerLoopFastTimer;
 	OscReadOnlyVariable<int32_t> timeMeasureMaxPerLoopOscInput;
 
+	// Startup time in us, from the TIM2 start (peripheral initialization, before DAMC_start) to the first audio block
+	OscReadOnlyVariable<int32_t> timeToFirstAudioBlock;
+	// TIM2 value at the first audio block, 0 until then
+	std::atomic<uint32_t> firstAudioBlockTime;
+
+	// State messages dropped by a congested connector (then dumped again)
+	OscReadOnlyVariable<int32_t> oscDroppedStateMessages;
+
 	OscDynamicVariable<int32_t> memoryAvailable;
 	OscDynamicVariable<int32_t> memoryUsed;
+	MemoryArenaStatistics memoryArenaStatistics;
+
+	MainLoopScheduler scheduler;
+	ConfigStorage configStorage;
 
-	uint32_t fastTimerPreviousTick;
 	uint32_t nextTimerStripIndex;
-	uint32_t slowTimerPreviousTick;
+	// Slow timer statistics are sent one group per run, each group once per second
+	static constexpr uint32_t SLOW_TIMER_STEPS = 4;
 	uint32_t slowTimerIndex;
+	uint32_t nextBackgroundStripIndex;
+
+	// Strip parameters are compiled in the main loop and swapped by the audio processing at the start of a block.
+	// The main loop publishes a new generation with the strips to swap, and doesn't compile again until the audio
+	// processing applied it.
+	// Changes between /scene/begin and /scene/commit are published together.
+	OscContainer oscScene;
+	OscEndpoint oscSceneBegin;
+	OscEndpoint oscSceneCommit;
+	std::atomic<bool> sceneOpen;
+	uint32_t sceneBeginTime;
+	// A scene not committed after this time is committed anyway, to not block parameter changes
+	static constexpr uint32_t SCENE_TIMEOUT_US = 1000000;
+	uint32_t pendingStripMask;
+	std::atomic<uint32_t> publishedParametersGeneration;
+	std::atomic<uint32_t> appliedParametersGeneration;
+
+	uint32_t sampleRate;
+	uint64_t sampleClock;
 
 
 	MultiChannelAudioBuffer buffer[5];
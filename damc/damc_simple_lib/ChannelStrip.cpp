@@ -10,7 +10,7 @@
 
 ChannelStrip::ChannelStrip(
     OscContainer* parent, int index, std::string_view name, uint32_t numChannels, uint32_t sampleRate, size_t maxNframes)
-    : OscContainer(parent, Utils::toString(index), 10),
+    : OscContainer(parent, Utils::toString(index), 11),
       oscEnable(this, "enable", true),
       oscType(this, "_type", 0),
       oscName(this, "name", Utils::toString(index)),
@@ -18,6 +18,7 @@ ChannelStrip::ChannelStrip(
       oscNumChannels(this, "channels", numChannels),
       oscSampleRate(this, "sample_rate", sampleRate),
       filterChain(this, &oscNumChannels, &oscSampleRate),
+      spectrumAnalyzer(this, &oscNumChannels, &oscSampleRate),
       maxNframes(maxNframes) {
 	oscNumChannels.addCheckCallback([](int32_t value) -> bool { return false; });
 	oscSampleRate.addCheckCallback([](int32_t value) -> bool { return false; });
@@ -51,6 +52,7 @@ void ChannelStrip::processAudioInterleaved(const int16_t* data_input, int16_t* d
 	}
 
 	filterChain.processSamples(channelBuffers, channelNumber, nframes);
+	spectrumAnalyzer.processSamples(channelBuffers, channelNumber, nframes);
 
 	for(uint32_t channel = 0; channel < channelNumber; channel++) {
 		for(uint32_t frame = 0; frame < nframes; frame++) {
@@ -62,8 +64,14 @@ void ChannelStrip::processAudioInterleaved(const int16_t* data_input, int16_t* d
 
 void ChannelStrip::processSamples(float** samples, size_t numChannel, size_t nframes) {
 	filterChain.processSamples(samples, numChannel, nframes);
+	spectrumAnalyzer.processSamples(samples, numChannel, nframes);
 }
 
 void ChannelStrip::onFastTimer() {
 	filterChain.onFastTimer();
+	spectrumAnalyzer.onFastTimer();
+}
+
+bool ChannelStrip::processBackgroundSlice() {
+	return spectrumAnalyzer.processBackgroundSlice();
 }
@@ -3,6 +3,7 @@
 #include <FilteringChain.h>
 #include <Osc/OscContainer.h>
 #include <Osc/OscReadOnlyVariable.h>
+#include <SpectrumAnalyzer.h>
 #include <stdint.h>
 
 class ChannelStrip : public OscContainer {
@@ -13,6 +14,12 @@ public:
 	void processAudioInterleaved(const int16_t* data_input, int16_t* data_output, size_t nframes);
 	void processSamples(float** samples, size_t numChannel, size_t nframes);
 	void onFastTimer();
+	bool processBackgroundSlice();
+
+	bool compileParameters() { return filterChain.compileParameters(); }
+	void swapParameters() { filterChain.swapParameters(); }
+	void compileActiveParameters() { filterChain.compileActiveParameters(); }
+	void invalidateParameters() { filterChain.invalidateParameters(); }
 
 private:
 	OscVariable<bool> oscEnable;
@@ -22,6 +29,7 @@ private:
 	OscReadOnlyVariable<int32_t> oscNumChannels;
 	OscReadOnlyVariable<int32_t> oscSampleRate;
 	FilterChain filterChain;
+	SpectrumAnalyzer spectrumAnalyzer;
 
 	size_t maxNframes;
 	float** channelBuffers;
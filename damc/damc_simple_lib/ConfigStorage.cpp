@@ -0,0 +1,395 @@
+#include "ConfigStorage.h"
+#include "TimeMeasure.h"
+#include <OscRoot.h>
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include <string.h>
+#include <stm32f7xx_hal.h>
+
+ConfigStorage::ConfigStorage(OscRoot* oscRoot)
+    : OscContainer(oscRoot, "config"),
+      oscRoot(oscRoot),
+      nodesGeneration(0),
+      writeOffset(sizeof(MAGIC)),
+      full(false),
+      configChanged(false),
+      scanActive(false),
+      scanIndex(0),
+      pendingRecordWords(0),
+      pendingRecordProgrammedWords(0),
+      pendingNodeIndex(0),
+      oscRestoreTime(this, "restoreTime"),
+      oscUsedSize(this, "usedSize"),
+      oscFull(this, "full") {
+	oscRoot->setOnOscValueChanged([this]() { configChanged = true; });
+}
+
+uint32_t ConfigStorage::getRecordHash(const OscNode* node, size_t valueIndex) {
+	uint32_t hash = node->getConfigAddressHash(valueIndex);
+
+	// Erased flash marks the end of records
+	if(hash == 0xFFFFFFFF)
+		hash = 0;
+
+	return hash;
+}
+
+uint16_t ConfigStorage::computeCrc(const uint8_t* data, size_t size, uint16_t crc) {
+	// CRC-16/CCITT-FALSE
+	for(size_t i = 0; i < size; i++) {
+		crc ^= (uint16_t) data[i] << 8;
+		for(int bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+size_t ConfigStorage::encodeRecord(uint32_t addressHash, const OscArgument* value, uint32_t* record) {
+	RecordType type = RecordType::Default;
+	uint8_t* data = (uint8_t*) &record[2];
+	size_t size = 0;
+
+	if(value) {
+		std::visit(
+		    [&type, &size, data](auto&& arg) -> void {
+			    using U = std::decay_t<decltype(arg)>;
+			    if constexpr(std::is_same_v<U, bool>) {
+				    type = RecordType::Bool;
+				    data[0] = arg;
+				    size = 1;
+			    } else if constexpr(std::is_same_v<U, int32_t>) {
+				    type = RecordType::Int32;
+				    memcpy(data, &arg, sizeof(arg));
+				    size = sizeof(arg);
+			    } else if constexpr(std::is_same_v<U, float>) {
+				    type = RecordType::Float;
+				    memcpy(data, &arg, sizeof(arg));
+				    size = sizeof(arg);
+			    } else if constexpr(std::is_same_v<U, std::string_view>) {
+				    type = RecordType::String;
+				    size = arg.size();
+				    if(size <= MAX_STRING_SIZE)
+					    memcpy(data, arg.data(), size);
+			    }
+		    },
+		    *value);
+
+		if(size > MAX_STRING_SIZE)
+			return 0;
+	}
+
+	size_t words = (HEADER_SIZE + size + 3) / 4;
+
+	// Padding is kept erased
+	memset(data + size, 0xFF, words * 4 - HEADER_SIZE - size);
+
+	record[0] = addressHash;
+	record[1] = (uint32_t) type | (size << 8);
+	// The CRC covers the address hash, type, size and value
+	uint16_t crc = computeCrc(data, size, computeCrc((const uint8_t*) record, HEADER_SIZE - 2));
+	record[1] |= (uint32_t) crc << 16;
+
+	return words;
+}
+
+size_t ConfigStorage::checkRecord(uint32_t offset) {
+	if(offset + HEADER_SIZE > STORAGE_SIZE)
+		return 0;
+
+	const uint32_t* header = (const uint32_t*) (storage() + offset);
+	RecordType type = (RecordType) (header[1] & 0xFF);
+	size_t size = (header[1] >> 8) & 0xFF;
+
+	if(type > RecordType::String || size > MAX_STRING_SIZE)
+		return 0;
+
+	size_t recordSize = (HEADER_SIZE + size + 3) & ~3;
+	if(offset + recordSize > STORAGE_SIZE)
+		return 0;
+
+	uint16_t crc = computeCrc(storage() + offset, HEADER_SIZE - 2);
+	crc = computeCrc(storage() + offset + HEADER_SIZE, size, crc);
+	if(crc != (header[1] >> 16))
+		return 0;
+
+	return recordSize;
+}
+
+bool ConfigStorage::decodeRecord(uint32_t offset, OscArgument* value) {
+	const uint32_t* header = (const uint32_t*) (storage() + offset);
+	const uint8_t* data = storage() + offset + HEADER_SIZE;
+	size_t size = (header[1] >> 8) & 0xFF;
+
+	switch((RecordType) (header[1] & 0xFF)) {
+		case RecordType::Bool:
+			*value = data[0] != 0;
+			return true;
+		case RecordType::Int32: {
+			int32_t v;
+			memcpy(&v, data, sizeof(v));
+			*value = v;
+			return true;
+		}
+		case RecordType::Float: {
+			float v;
+			memcpy(&v, data, sizeof(v));
+			*value = v;
+			return true;
+		}
+		case RecordType::String:
+			*value = std::string_view((const char*) data, size);
+			return true;
+		default:
+			return false;
+	}
+}
+
+template<class RecordFunction> uint32_t ConfigStorage::scanRecords(bool* corrupted, RecordFunction onRecord) {
+	uint32_t offset = sizeof(MAGIC);
+
+	*corrupted = false;
+
+	while(offset + sizeof(uint32_t) <= STORAGE_SIZE) {
+		uint32_t addressHash = *(const uint32_t*) (storage() + offset);
+		if(addressHash == 0xFFFFFFFF)
+			break;
+
+		size_t recordSize = checkRecord(offset);
+		if(recordSize == 0) {
+			*corrupted = true;
+			break;
+		}
+
+		onRecord(offset, addressHash);
+		offset += recordSize;
+	}
+
+	return offset;
+}
+
+void ConfigStorage::prepare() {
+	bool corrupted = false;
+
+	if(*(const uint32_t*) storage() != MAGIC) {
+		// Never used or other content
+		eraseSector();
+	} else {
+		writeOffset = scanRecords(&corrupted, [](uint32_t, uint32_t) {});
+		if(corrupted || writeOffset > STORAGE_SIZE * 3 / 4)
+			compact();
+	}
+
+	oscUsedSize.set(writeOffset);
+}
+
+void ConfigStorage::eraseSector() {
+	FLASH_EraseInitTypeDef eraseInit = {};
+	uint32_t sectorError;
+
+	eraseInit.TypeErase = FLASH_TYPEERASE_SECTORS;
+	eraseInit.Sector = FLASH_SECTOR_7;
+	eraseInit.NbSectors = 1;
+	eraseInit.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+	HAL_FLASH_Unlock();
+	bool success = HAL_FLASHEx_Erase(&eraseInit, &sectorError) == HAL_OK &&
+	               HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, STORAGE_ADDRESS, MAGIC) == HAL_OK;
+	HAL_FLASH_Lock();
+	SCB_InvalidateDCache_by_Addr((uint32_t*) STORAGE_ADDRESS, STORAGE_SIZE);
+
+	writeOffset = sizeof(MAGIC);
+	full = !success;
+	oscFull.set(full);
+}
+
+void ConfigStorage::compact() {
+	// Latest record of each address, sorted by hash
+	std::vector<std::pair<uint32_t, uint32_t>> latestRecords;
+	bool corrupted;
+
+	scanRecords(&corrupted, [&latestRecords](uint32_t offset, uint32_t addressHash) {
+		auto it = std::lower_bound(
+		    latestRecords.begin(), latestRecords.end(), std::make_pair(addressHash, (uint32_t) 0));
+		if(it != latestRecords.end() && it->first == addressHash)
+			it->second = offset;
+		else
+			latestRecords.insert(it, std::make_pair(addressHash, offset));
+	});
+
+	std::vector<uint32_t> records;
+	for(const auto& latestRecord : latestRecords) {
+		uint32_t offset = latestRecord.second;
+		const uint32_t* header = (const uint32_t*) (storage() + offset);
+
+		// Default values don't need a record anymore
+		if((RecordType) (header[1] & 0xFF) == RecordType::Default)
+			continue;
+
+		records.insert(records.end(), header, header + checkRecord(offset) / 4);
+	}
+
+	eraseSector();
+	if(full)
+		return;
+
+	HAL_FLASH_Unlock();
+	for(uint32_t word : records) {
+		if(HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, STORAGE_ADDRESS + writeOffset, word) != HAL_OK) {
+			full = true;
+			break;
+		}
+		writeOffset += sizeof(word);
+	}
+	HAL_FLASH_Lock();
+	SCB_InvalidateDCache_by_Addr((uint32_t*) STORAGE_ADDRESS, STORAGE_SIZE);
+
+	oscFull.set(full);
+}
+
+void ConfigStorage::buildNodeList() {
+	std::function<bool(OscNode*)> visitor = [this](OscNode* node) {
+		size_t valueNumber = node->getConfigValueNumber();
+		for(size_t i = 0; i < valueNumber; i++) {
+			nodes.push_back(NodeEntry{node, (uint32_t) i, getRecordHash(node, i), 0});
+		}
+		return true;
+	};
+
+	nodes.clear();
+	oscRoot->visit(&visitor);
+	nodesGeneration = oscRoot->getConfigNodesGeneration();
+
+	std::sort(nodes.begin(), nodes.end(), [](const NodeEntry& a, const NodeEntry& b) {
+		return a.addressHash < b.addressHash;
+	});
+
+	// Records only have the hash, values sharing one would overwrite each other: they are not persisted
+	auto sameHash = [](const NodeEntry& a, const NodeEntry& b) { return a.addressHash == b.addressHash; };
+	for(auto it = std::adjacent_find(nodes.begin(), nodes.end(), sameHash); it != nodes.end();
+	    it = std::adjacent_find(it, nodes.end(), sameHash)) {
+		uint32_t hash = it->addressHash;
+		auto end = std::find_if(it, nodes.end(), [hash](const NodeEntry& entry) { return entry.addressHash != hash; });
+		SPDLOG_ERROR("Configuration values {} and {} have the same address hash, not persisted",
+		             it->node->getFullAddress(),
+		             (it + 1)->node->getFullAddress());
+		it = nodes.erase(it, end);
+	}
+
+	bool corrupted;
+	scanRecords(&corrupted, [this](uint32_t offset, uint32_t addressHash) {
+		auto it = std::lower_bound(nodes.begin(), nodes.end(), addressHash, [](const NodeEntry& entry, uint32_t hash) {
+			return entry.addressHash < hash;
+		});
+		if(it != nodes.end() && it->addressHash == addressHash)
+			it->recordOffset = offset;
+	});
+}
+
+void ConfigStorage::restore() {
+	uint32_t startTime = TimeMeasure::getCurrent();
+
+	buildNodeList();
+
+	for(NodeEntry& entry : nodes) {
+		OscArgument value;
+		if(entry.recordOffset != 0 && decodeRecord(entry.recordOffset, &value))
+			entry.node->setConfigValue(entry.valueIndex, value);
+	}
+
+	oscRestoreTime.set(TimeMeasure::ticksToUs(TimeMeasure::getCurrent() - startTime));
+}
+
+bool ConfigStorage::programPendingRecord() {
+	size_t end = std::min(pendingRecordProgrammedWords + PROGRAM_SLICE_WORDS, pendingRecordWords);
+
+	HAL_FLASH_Unlock();
+	for(; pendingRecordProgrammedWords < end; pendingRecordProgrammedWords++) {
+		uint32_t address = STORAGE_ADDRESS + writeOffset + pendingRecordProgrammedWords * sizeof(uint32_t);
+		if(HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address, pendingRecord[pendingRecordProgrammedWords]) != HAL_OK) {
+			// Leave the partial record, it is discarded by the next boot compaction
+			full = true;
+			break;
+		}
+	}
+	HAL_FLASH_Lock();
+
+	if(full) {
+		pendingRecordWords = 0;
+		scanActive = false;
+		oscFull.set(true);
+		return true;
+	}
+
+	if(pendingRecordProgrammedWords < pendingRecordWords)
+		return true;
+
+	uint32_t recordSize = pendingRecordWords * sizeof(uint32_t);
+	SCB_InvalidateDCache_by_Addr((uint32_t*) (uintptr_t) (STORAGE_ADDRESS + (writeOffset & ~31)), recordSize + 32);
+
+	// When nodes changed meanwhile, the rebuilt list finds this record in flash
+	if(nodesGeneration == oscRoot->getConfigNodesGeneration())
+		nodes[pendingNodeIndex].recordOffset = writeOffset;
+
+	writeOffset += recordSize;
+	pendingRecordWords = 0;
+	oscUsedSize.set(writeOffset);
+
+	return true;
+}
+
+bool ConfigStorage::persistSlice() {
+	if(pendingRecordWords != 0)
+		return programPendingRecord();
+
+	if(!scanActive) {
+		if(!configChanged.exchange(false) || full)
+			return false;
+		scanActive = true;
+		scanIndex = 0;
+	}
+
+	// Nodes can be changed by the audio interrupt when not busy
+	OscRoot::BusyGuard busyGuard(oscRoot);
+
+	if(nodesGeneration != oscRoot->getConfigNodesGeneration()) {
+		buildNodeList();
+		scanIndex = 0;
+		return true;
+	}
+
+	size_t end = std::min(scanIndex + SCAN_SLICE_NODES, nodes.size());
+	while(scanIndex < end) {
+		NodeEntry& entry = nodes[scanIndex];
+		OscArgument value;
+		bool hasValue = entry.node->getConfigValue(entry.valueIndex, &value);
+
+		scanIndex++;
+
+		if(!hasValue && entry.recordOffset == 0)
+			continue;
+
+		size_t words = encodeRecord(entry.addressHash, hasValue ? &value : nullptr, pendingRecord);
+		if(words == 0)
+			continue;
+
+		if(entry.recordOffset != 0 && memcmp(storage() + entry.recordOffset, pendingRecord, words * 4) == 0)
+			continue;
+
+		if(writeOffset + words * sizeof(uint32_t) > STORAGE_SIZE) {
+			full = true;
+			scanActive = false;
+			oscFull.set(true);
+			return true;
+		}
+
+		pendingRecordWords = words;
+		pendingRecordProgrammedWords = 0;
+		pendingNodeIndex = scanIndex - 1;
+		return true;
+	}
+
+	if(scanIndex >= nodes.size())
+		scanActive = false;
+
+	return true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Osc/OscContainer.h>
+#include <Osc/OscReadOnlyVariable.h>
+#include <atomic>
+#include <stdint.h>
+#include <string_view>
+#include <vector>
+
+class OscRoot;
+
+/**
+ * @brief Persistent configuration in the last internal flash sector.
+ *
+ * Configurable variables not at their default value are stored as append-only records: the hash of the node address
+ * (OscNode::getAddressHash), the value type and size, a CRC and the value. The latest record of an address wins, a
+ * record without value puts the variable back to its default value.
+ *
+ * Erasing a sector stalls all flash reads, and so the code including the audio interrupt, for about 1 second. The
+ * sector is only erased by prepare() before USB and audio are started: when its content is corrupted (power loss while
+ * writing) or more than 3/4 full, the latest records are compacted in RAM and written back.
+ * While running, records are programmed one word at a time, each word stalls flash reads for about 16us.
+ * When the sector is full, new changes are persisted after the next boot.
+ */
+class ConfigStorage : public OscContainer {
+public:
+	ConfigStorage(OscRoot* oscRoot);
+
+	// Check the sector content and compact it if needed, before USB and audio are started
+	void prepare();
+	// Apply persisted values to the nodes
+	void restore();
+	// Main loop task: persist changed variables, return false when there was nothing to do
+	bool persistSlice();
+
+protected:
+	enum class RecordType : uint8_t { Default, Bool, Int32, Float, String };
+
+	struct NodeEntry {
+		OscNode* node;
+		// Index of the value in the node, for nodes with several configuration values
+		uint32_t valueIndex;
+		uint32_t addressHash;
+		// Offset of the latest record of this node, 0 when there is none
+		uint32_t recordOffset;
+	};
+
+	// Hash of the value address, as stored in records
+	static uint32_t getRecordHash(const OscNode* node, size_t valueIndex);
+	static uint16_t computeCrc(const uint8_t* data, size_t size, uint16_t crc = 0xFFFF);
+	static const uint8_t* storage() { return (const uint8_t*) STORAGE_ADDRESS; }
+
+	// Return the record size in words, 0 if the value can't be persisted. value is null for a default value record.
+	static size_t encodeRecord(uint32_t addressHash, const OscArgument* value, uint32_t* record);
+	// Return the record size in bytes, 0 if the record at offset is not valid
+	static size_t checkRecord(uint32_t offset);
+	static bool decodeRecord(uint32_t offset, OscArgument* value);
+	// Call onRecord for each valid record, return the offset after the last one
+	template<class RecordFunction> static uint32_t scanRecords(bool* corrupted, RecordFunction onRecord);
+
+	void buildNodeList();
+	bool programPendingRecord();
+	void eraseSector();
+	void compact();
+
+	static constexpr uint32_t STORAGE_ADDRESS = 0x08060000;  // Sector 7, reserved in the linker script
+	static constexpr uint32_t STORAGE_SIZE = 128 * 1024;
+	static constexpr uint32_t MAGIC = 0x31434d44;  // "DMC1"
+	static constexpr uint32_t HEADER_SIZE = 8;
+	static constexpr uint32_t MAX_STRING_SIZE = 64;
+	static constexpr uint32_t MAX_RECORD_WORDS = (HEADER_SIZE + MAX_STRING_SIZE) / 4;
+
+	// Work done per main loop slice
+	static constexpr size_t SCAN_SLICE_NODES = 16;
+	static constexpr size_t PROGRAM_SLICE_WORDS = 4;
+
+private:
+	OscRoot* oscRoot;
+
+	// Configurable nodes sorted by address hash
+	std::vector<NodeEntry> nodes;
+	uint32_t nodesGeneration;
+
+	uint32_t writeOffset;
+	bool full;
+
+	// Set by any variable change (possibly from the audio interrupt), then all nodes are compared to their record
+	std::atomic<bool> configChanged;
+	bool scanActive;
+	size_t scanIndex;
+
+	uint32_t pendingRecord[MAX_RECORD_WORDS];
+	size_t pendingRecordWords;
+	size_t pendingRecordProgrammedWords;
+	size_t pendingNodeIndex;
+
+	OscReadOnlyVariable<int32_t> oscRestoreTime;
+	OscReadOnlyVariable<int32_t> oscUsedSize;
+	OscReadOnlyVariable<bool> oscFull;
+};
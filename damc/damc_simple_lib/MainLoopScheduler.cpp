@@ -0,0 +1,101 @@
+#include "MainLoopScheduler.h"
+#include "TimeMeasure.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+MainLoopScheduler::MainLoopScheduler(OscContainer* parent)
+    : OscContainer(parent, "scheduler"),
+      lastAudioBlockTime(0),
+      audioStarted(false),
+      longestTask(nullptr),
+      longestTaskDuration(0),
+      maxGapDuration(0),
+      maxGapTask(nullptr),
+      budgetOverrunCount(0),
+      oscMaxGap(this, "maxGap"),
+      oscMaxGapTask(this, "maxGapTask"),
+      oscBudgetOverruns(this, "budgetOverruns") {
+	tasks.reserve(MAX_TASK_NUMBER);
+}
+
+void MainLoopScheduler::addTask(
+    const char* name, uint8_t priority, uint32_t periodUs, uint32_t budgetUs, TaskFunction function) {
+	if(tasks.size() >= MAX_TASK_NUMBER) {
+		SPDLOG_ERROR("Too many main loop tasks, ignoring {}", name);
+		return;
+	}
+
+	Task task = {name, priority, periodUs, budgetUs, TimeMeasure::getCurrent(), std::move(function)};
+
+	// Keep tasks sorted by priority, tasks with the same priority keep their registration order
+	auto it = std::upper_bound(
+	    tasks.begin(), tasks.end(), priority, [](uint8_t priority, const Task& t) { return priority < t.priority; });
+	tasks.insert(it, std::move(task));
+}
+
+void MainLoopScheduler::runOnce() {
+	uint32_t loopStart = TimeMeasure::getCurrent();
+	uint32_t loopBudget = TimeMeasure::usToTicks(LOOP_BUDGET_US);
+	bool workDone = false;
+
+	for(Task& task : tasks) {
+		uint32_t now = TimeMeasure::getCurrent();
+
+		if(task.periodUs != 0 && (int32_t) (now - task.nextRunTime) < 0)
+			continue;
+
+		// Leave the task for the next iteration if it might not fit in the remaining budget
+		uint32_t elapsed = now - loopStart;
+		if(workDone && elapsed + TimeMeasure::usToTicks(task.budgetUs) > loopBudget)
+			break;
+
+		bool didWork = task.function();
+		uint32_t end = TimeMeasure::getCurrent();
+		uint32_t duration = end - now;
+
+		if(task.periodUs != 0) {
+			uint32_t period = TimeMeasure::usToTicks(task.periodUs);
+			task.nextRunTime += period;
+			// Don't try to catch up missed periods, restart from now
+			if((int32_t) (end - task.nextRunTime) >= 0)
+				task.nextRunTime = end + period;
+		}
+
+		if(duration > TimeMeasure::usToTicks(task.budgetUs))
+			budgetOverrunCount++;
+
+		if(duration > longestTaskDuration) {
+			longestTaskDuration = duration;
+			longestTask = &task;
+		}
+
+		workDone = workDone || didWork;
+	}
+}
+
+void MainLoopScheduler::onAudioBlock() {
+	uint32_t now = TimeMeasure::getCurrent();
+
+	if(audioStarted) {
+		uint32_t gap = now - lastAudioBlockTime;
+		if(gap > maxGapDuration) {
+			maxGapDuration = gap;
+			maxGapTask = longestTask;
+		}
+	}
+
+	audioStarted = true;
+	lastAudioBlockTime = now;
+	longestTask = nullptr;
+	longestTaskDuration = 0;
+}
+
+void MainLoopScheduler::updateStatistics() {
+	oscMaxGap.set(TimeMeasure::ticksToUs(maxGapDuration));
+	oscMaxGapTask.set(maxGapTask ? maxGapTask->name : "");
+	oscBudgetOverruns.set(budgetOverrunCount);
+
+	maxGapDuration = 0;
+	maxGapTask = nullptr;
+	budgetOverrunCount = 0;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Osc/OscContainer.h>
+#include <Osc/OscReadOnlyVariable.h>
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @brief Cooperative scheduler of the main loop work.
+ * Audio blocks are processed in an interrupt preempting the main loop, tasks only delay each other.
+ *
+ * Each call to runOnce() runs due tasks in priority order (lower value first) until the loop budget is spent. A task is
+ * deferred to a later iteration when its budget doesn't fit in what remains of the loop budget.
+ * Times are measured with TIM2 and compared with wrap-safe differences.
+ *
+ * The scheduler reports the longest time between 2 audio blocks and the task that ran the longest during that time, to
+ * find tasks delaying audio (for example by masking interrupts).
+ */
+class MainLoopScheduler : public OscContainer {
+public:
+	// Return true when the task did some work, false when it had nothing to do
+	using TaskFunction = std::function<bool()>;
+
+	MainLoopScheduler(OscContainer* parent);
+
+	// periodUs = 0: run on each loop iteration
+	void addTask(const char* name, uint8_t priority, uint32_t periodUs, uint32_t budgetUs, TaskFunction function);
+
+	void runOnce();
+	void onAudioBlock();
+
+	// Send statistics and reset them
+	void updateStatistics();
+
+	// Time allowed for tasks in one main loop iteration
+	static constexpr uint32_t LOOP_BUDGET_US = 250;
+	// Tasks are reserved once: the statistics point to them, they must not move
+	static constexpr size_t MAX_TASK_NUMBER = 12;
+
+protected:
+	struct Task {
+		const char* name;
+		uint8_t priority;
+		uint32_t periodUs;
+		uint32_t budgetUs;
+		uint32_t nextRunTime;
+		TaskFunction function;
+	};
+
+private:
+	std::vector<Task> tasks;
+
+	uint32_t lastAudioBlockTime;
+	bool audioStarted;
+
+	// Longest task run since the last audio block
+	const Task* longestTask;
+	uint32_t longestTaskDuration;
+
+	uint32_t maxGapDuration;
+	const Task* maxGapTask;
+	uint32_t budgetOverrunCount;
+
+	OscReadOnlyVariable<int32_t> oscMaxGap;
+	OscReadOnlyVariable<std::string> oscMaxGapTask;
+	OscReadOnlyVariable<int32_t> oscBudgetOverruns;
+};
@@ -0,0 +1,283 @@
+#include "MemoryArena.h"
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+#include <stm32f7xx.h>
+
+extern "C" uint8_t* __sbrk_heap_end;
+extern "C" void* _sbrk(ptrdiff_t incr);
+
+namespace {
+
+struct Chunk {
+	uint8_t* begin;
+	uint8_t* end;
+};
+
+// Deleted arena block, reused by the next allocation of the same size
+struct FreeBlock {
+	FreeBlock* next;
+	size_t size;
+};
+
+// Zero initialized before any static constructor allocates
+struct ArenaState {
+	Chunk chunks[MemoryArena::MAX_CHUNKS];
+	size_t chunkCount;
+	// Next free byte of the last chunk
+	uint8_t* next;
+	// Latest block, given back to the arena when deleted
+	uint8_t* lastBlock;
+	MemoryArena::Subsystem lastBlockSubsystem;
+	FreeBlock* freeBlocks;
+	MemoryArena::Subsystem subsystem;
+	bool frozen;
+	uint8_t* heapEndAtFreeze;
+
+	uint32_t arenaSize;
+	uint32_t wastedSize;
+	uint32_t subsystemSize[MemoryArena::SUBSYSTEM_NUMBER];
+	// Allocations after the freeze can happen in interrupts
+	std::atomic<uint32_t> allocationsAfterFreeze;
+	std::atomic<uint32_t> allocatedSizeAfterFreeze;
+};
+
+ArenaState arena;
+
+// Masks interrupts while the arena state is changed, nests with other critical sections
+class CriticalSection {
+public:
+	CriticalSection() : primask(__get_PRIMASK()) { __disable_irq(); }
+	~CriticalSection() { __set_PRIMASK(primask); }
+
+private:
+	uint32_t primask;
+};
+
+bool addChunk(size_t size) {
+	Chunk* last = arena.chunkCount > 0 ? &arena.chunks[arena.chunkCount - 1] : nullptr;
+
+	if(last && __sbrk_heap_end == last->end) {
+		// Nothing else took memory from the heap since the last chunk, extend it
+		size_t missing = size - (last->end - arena.next);
+		size_t growth = missing > MemoryArena::CHUNK_SIZE ? missing : MemoryArena::CHUNK_SIZE;
+		if(_sbrk(growth) == (void*) -1)
+			return false;
+
+		last->end += growth;
+		arena.arenaSize += growth;
+		return true;
+	}
+
+	if(arena.chunkCount >= MemoryArena::MAX_CHUNKS)
+		return false;
+
+	size_t chunkSize = size > MemoryArena::CHUNK_SIZE ? size : MemoryArena::CHUNK_SIZE;
+	size_t padding = (-(uintptr_t) _sbrk(0)) & (MemoryArena::ALIGNMENT - 1);
+	uint8_t* begin = (uint8_t*) _sbrk(chunkSize + padding);
+	if(begin == (uint8_t*) -1)
+		return false;
+
+	// The end of the previous chunk is lost
+	if(last)
+		arena.wastedSize += last->end - arena.next;
+
+	begin += padding;
+	arena.chunks[arena.chunkCount++] = Chunk{begin, begin + chunkSize};
+	arena.next = begin;
+	arena.lastBlock = nullptr;
+	arena.arenaSize += chunkSize + padding;
+	return true;
+}
+
+}  // namespace
+
+void MemoryArena::setSubsystem(Subsystem subsystem) {
+	arena.subsystem = subsystem;
+}
+
+void MemoryArena::freeze() {
+	CriticalSection criticalSection;
+
+	arena.frozen = true;
+	arena.lastBlock = nullptr;
+
+	// Give the unused end of the last chunk back to the heap when possible
+	if(arena.chunkCount > 0) {
+		Chunk& last = arena.chunks[arena.chunkCount - 1];
+		if(__sbrk_heap_end == last.end && last.end != arena.next) {
+			size_t unused = last.end - arena.next;
+			_sbrk(-(ptrdiff_t) unused);
+			last.end = arena.next;
+			arena.arenaSize -= unused;
+		}
+	}
+
+	arena.heapEndAtFreeze = __sbrk_heap_end;
+}
+
+bool MemoryArena::contains(const void* ptr) {
+	for(size_t i = 0; i < arena.chunkCount; i++) {
+		if(ptr >= arena.chunks[i].begin && ptr < arena.chunks[i].end)
+			return true;
+	}
+	return false;
+}
+
+void* MemoryArena::allocateFromArena(size_t size) {
+	CriticalSection criticalSection;
+
+	size = size ? (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1) : ALIGNMENT;
+
+	// Blocks freed by vector growth are often followed by an allocation of the same size for the next object
+	for(FreeBlock** freeBlock = &arena.freeBlocks; *freeBlock; freeBlock = &(*freeBlock)->next) {
+		if((*freeBlock)->size == size) {
+			uint8_t* block = (uint8_t*) *freeBlock;
+			*freeBlock = (*freeBlock)->next;
+			arena.wastedSize -= size;
+			arena.subsystemSize[(size_t) arena.subsystem] += size;
+			return block;
+		}
+	}
+
+	if(arena.chunkCount == 0 || size > (size_t) (arena.chunks[arena.chunkCount - 1].end - arena.next)) {
+		if(!addChunk(size))
+			return nullptr;
+	}
+
+	uint8_t* block = arena.next;
+	arena.next += size;
+	arena.lastBlock = block;
+	arena.lastBlockSubsystem = arena.subsystem;
+	arena.subsystemSize[(size_t) arena.subsystem] += size;
+
+	return block;
+}
+
+void* MemoryArena::allocate(size_t size) {
+	if(!arena.frozen) {
+		void* ptr = allocateFromArena(size);
+		if(ptr)
+			return ptr;
+		// The arena can't grow anymore, let malloc try
+	} else {
+		arena.allocationsAfterFreeze.fetch_add(1, std::memory_order_relaxed);
+		arena.allocatedSizeAfterFreeze.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	void* ptr = malloc(size ? size : 1);
+	if(!ptr)
+		abort();
+
+	return ptr;
+}
+
+void MemoryArena::deallocate(void* ptr, size_t size) {
+	if(!ptr)
+		return;
+
+	// Chunks only grow over memory not allocated yet, the result doesn't depend on concurrent changes
+	if(!contains(ptr)) {
+		free(ptr);
+		return;
+	}
+
+	CriticalSection criticalSection;
+
+	uint8_t* block = (uint8_t*) ptr;
+	if(block == arena.lastBlock) {
+		arena.subsystemSize[(size_t) arena.lastBlockSubsystem] -= arena.next - block;
+		arena.next = block;
+		arena.lastBlock = nullptr;
+	} else if(!arena.frozen && size >= sizeof(FreeBlock)) {
+		size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+		FreeBlock* freeBlock = (FreeBlock*) block;
+		freeBlock->next = arena.freeBlocks;
+		freeBlock->size = size;
+		arena.freeBlocks = freeBlock;
+		arena.wastedSize += size;
+	} else {
+		// Lost: too small to be reused, or the size is unknown (unsized deletes of arrays of trivial types)
+		arena.wastedSize += (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+	}
+}
+
+void MemoryArena::getStatistics(Statistics* statistics) {
+	statistics->arenaSize = arena.arenaSize;
+	statistics->wastedSize = arena.wastedSize;
+	for(size_t i = 0; i < SUBSYSTEM_NUMBER; i++) {
+		statistics->subsystemSize[i] = arena.subsystemSize[i];
+	}
+	statistics->allocationsAfterFreeze = arena.allocationsAfterFreeze.load(std::memory_order_relaxed);
+	statistics->allocatedSizeAfterFreeze = arena.allocatedSizeAfterFreeze.load(std::memory_order_relaxed);
+	statistics->heapGrowthAfterFreeze = arena.frozen ? __sbrk_heap_end - arena.heapEndAtFreeze : 0;
+}
+
+const char* MemoryArena::getSubsystemName(Subsystem subsystem) {
+	switch(subsystem) {
+	case Subsystem::Other:
+		return "other";
+	case Subsystem::Osc:
+		return "osc";
+	case Subsystem::Strips:
+		return "strips";
+	case Subsystem::Effects:
+		return "effects";
+	case Subsystem::Config:
+		return "config";
+	default:
+		return "unknown";
+	}
+}
+
+void* operator new(size_t size) {
+	return MemoryArena::allocate(size);
+}
+
+void* operator new[](size_t size) {
+	return MemoryArena::allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+	MemoryArena::deallocate(ptr, 0);
+}
+
+void operator delete[](void* ptr) noexcept {
+	MemoryArena::deallocate(ptr, 0);
+}
+
+void operator delete(void* ptr, size_t size) noexcept {
+	MemoryArena::deallocate(ptr, size);
+}
+
+void operator delete[](void* ptr, size_t size) noexcept {
+	MemoryArena::deallocate(ptr, size);
+}
+
+MemoryArenaStatistics::MemoryArenaStatistics(OscContainer* parent)
+    : OscContainer(parent, "memoryArena"),
+      oscArenaSize(this, "size"),
+      oscWastedSize(this, "wasted"),
+      oscSubsystems(this, "subsystems"),
+      oscAllocationsAfterInit(this, "allocationsAfterInit"),
+      oscAllocatedSizeAfterInit(this, "allocatedSizeAfterInit"),
+      oscHeapGrowthAfterInit(this, "heapGrowthAfterInit") {
+	for(size_t i = 0; i < MemoryArena::SUBSYSTEM_NUMBER; i++) {
+		oscSubsystemSize[i].reset(new OscReadOnlyVariable<int32_t>(
+		    &oscSubsystems, MemoryArena::getSubsystemName((MemoryArena::Subsystem) i)));
+	}
+}
+
+void MemoryArenaStatistics::update() {
+	MemoryArena::Statistics statistics;
+	MemoryArena::getStatistics(&statistics);
+
+	oscArenaSize.set(statistics.arenaSize);
+	oscWastedSize.set(statistics.wastedSize);
+	for(size_t i = 0; i < MemoryArena::SUBSYSTEM_NUMBER; i++) {
+		oscSubsystemSize[i]->set(statistics.subsystemSize[i]);
+	}
+	oscAllocationsAfterInit.set(statistics.allocationsAfterFreeze);
+	oscAllocatedSizeAfterInit.set(statistics.allocatedSizeAfterFreeze);
+	oscHeapGrowthAfterInit.set(statistics.heapGrowthAfterFreeze);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Osc/OscContainer.h>
+#include <Osc/OscReadOnlyVariable.h>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Bump allocator for the objects built at startup (OSC tree, strips, effects).
+ *
+ * Until freeze(), the global operator new allocates from the arena and accounts the memory to the current subsystem.
+ * Arena memory is taken from _sbrk in chunks (extended in place while nothing else moved the heap end). Blocks have no
+ * header and are never given to malloc, so long-lived objects don't fragment the malloc heap. freeze() only gives the
+ * unused end of the last chunk back to the heap (negative _sbrk), when nothing else moved the heap end since.
+ * Deleting the latest block gives it back (temporaries of constructors). Other deleted arena blocks are kept in a free
+ * list and reused by allocations of the same size until the freeze, they are accounted as wasted until then.
+ * The arena state is changed with interrupts masked, arena blocks can be deleted from any context.
+ *
+ * After freeze(), operator new uses malloc and counts allocations: nothing is expected to allocate once started, a non
+ * zero count shows a runtime allocation (and a risk of fragmentation).
+ */
+class MemoryArena {
+public:
+	enum class Subsystem : uint8_t { Other, Osc, Strips, Effects, Config, Number };
+	static constexpr size_t SUBSYSTEM_NUMBER = (size_t) Subsystem::Number;
+
+	// Allocations until the next call are accounted to this subsystem
+	static void setSubsystem(Subsystem subsystem);
+	static void freeze();
+
+	static void* allocate(size_t size);
+	static void deallocate(void* ptr, size_t size);
+
+	struct Statistics {
+		uint32_t arenaSize;  // Taken from _sbrk
+		uint32_t wastedSize;  // Deleted blocks, in the free list or lost, and chunk ends
+		// Allocated by each subsystem, including blocks deleted since
+		uint32_t subsystemSize[SUBSYSTEM_NUMBER];
+		uint32_t allocationsAfterFreeze;
+		uint32_t allocatedSizeAfterFreeze;
+		uint32_t heapGrowthAfterFreeze;  // Heap end increase, includes malloc calls from C code
+	};
+	static void getStatistics(Statistics* statistics);
+	static const char* getSubsystemName(Subsystem subsystem);
+
+	static constexpr size_t CHUNK_SIZE = 4096;
+	static constexpr size_t MAX_CHUNKS = 32;
+	static constexpr size_t ALIGNMENT = 8;
+
+protected:
+	static bool contains(const void* ptr);
+	static void* allocateFromArena(size_t size);
+};
+
+// Arena statistics, sent only when they change
+class MemoryArenaStatistics : public OscContainer {
+public:
+	MemoryArenaStatistics(OscContainer* parent);
+
+	void update();
+
+private:
+	OscReadOnlyVariable<int32_t> oscArenaSize;
+	OscReadOnlyVariable<int32_t> oscWastedSize;
+	OscContainer oscSubsystems;
+	std::unique_ptr<OscReadOnlyVariable<int32_t>> oscSubsystemSize[MemoryArena::SUBSYSTEM_NUMBER];
+	OscReadOnlyVariable<int32_t> oscAllocationsAfterInit;
+	OscReadOnlyVariable<int32_t> oscAllocatedSizeAfterInit;
+	OscReadOnlyVariable<int32_t> oscHeapGrowthAfterInit;
+};
@@ -32,16 +32,67 @@ void OscSerialClient::sendOscData(const uint8_t* data, size_t size) {
 	USB_CDC_IF_TX_write(data, size);
 }
 
+bool OscSerialClient::sendSlipFrame(const uint8_t* data, size_t size) {
+	// Escaped bytes plus start and end markers
+	size_t encodedSize = size + 2;
+	for(size_t i = 0; i < size; i++) {
+		if(data[i] == SLIP_END || data[i] == SLIP_ESC)
+			encodedSize++;
+	}
+	if(USB_CDC_IF_TX_get_free_size() < encodedSize)
+		return false;
+
+	uint32_t spanSize;
+	uint8_t* span = USB_CDC_IF_TX_get_write_span(&spanSize);
+	uint32_t written = 0;
+
+	encodeSlip(data, size, [&](uint8_t c) {
+		if(written >= spanSize) {
+			// Reached the end of the ring, continue at its start
+			USB_CDC_IF_TX_commit(written);
+			span = USB_CDC_IF_TX_get_write_span(&spanSize);
+			written = 0;
+		}
+		span[written++] = c;
+	});
+
+	USB_CDC_IF_TX_commit(written);
+
+	return true;
+}
+
+bool OscSerialClient::canSendTelemetry(size_t size) {
+	return USB_CDC_IF_TX_get_free_size() >= 2 * size + 2 + TELEMETRY_RESERVED_SIZE;
+}
+
 bool OscSerialClient::mainLoop() {
-	size_t read_size = USB_CDC_IF_RX_read(rx_buffer.data(), rx_buffer.size());
-	if(read_size > 0) {
-		TimeMeasure::timeMeasureOscInput.beginMeasure();
-		onOscDataReceived(rx_buffer.data(), read_size);
-		TimeMeasure::timeMeasureOscInput.endMeasure();
-		return true;
+	uint32_t spanSize;
+	const uint8_t* span = USB_CDC_IF_RX_get_read_span(&spanSize);
+	if(spanSize == 0)
+		return false;
+
+	TimeMeasure::timeMeasureOscInput.beginMeasure();
+
+	// Parse SLIP frames in place in the RX ring, up to 2 spans when the data wraps around the end of the ring
+	size_t remainingBudget = RX_BUDGET_SIZE;
+	while(spanSize > 0 && remainingBudget > 0) {
+		if(spanSize > remainingBudget)
+			spanSize = remainingBudget;
+
+		size_t processedSize = onOscDataReceived(span, spanSize);
+		USB_CDC_IF_RX_consume(processedSize);
+		remainingBudget -= processedSize;
+
+		// Wait for received messages to be executed
+		if(processedSize < spanSize)
+			break;
+
+		span = USB_CDC_IF_RX_get_read_span(&spanSize);
 	}
 
-	return false;
+	TimeMeasure::timeMeasureOscInput.endMeasure();
+
+	return remainingBudget < RX_BUDGET_SIZE;
 }
 
 void OscSerialClient::init() {}
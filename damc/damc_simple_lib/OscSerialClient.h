@@ -1,7 +1,6 @@
 #pragma once
 
 #include <OscRoot.h>
-#include <array>
 #include <stdint.h>
 #include <vector>
 
@@ -14,7 +13,15 @@ public:
 	void sendOscData(const uint8_t* buffer, size_t sizeToSend) override;
 	bool mainLoop();
 
+	bool canSendTelemetry(size_t size) override;
+
 protected:
-private:
-	std::array<uint8_t, 256> rx_buffer;
+	// Encode SLIP frames directly in the USB CDC TX ring
+	bool sendSlipFrame(const uint8_t* data, size_t size) override;
+
+	// TX ring space kept for state messages, telemetry is dropped below this
+	static constexpr size_t TELEMETRY_RESERVED_SIZE = 1024;
+
+	// Maximum received bytes processed per main loop iteration
+	static constexpr size_t RX_BUDGET_SIZE = 2048;
 };
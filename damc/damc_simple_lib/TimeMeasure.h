@@ -11,6 +11,8 @@ public:
 	void endAudioLoop();
 
 	static uint32_t getCurrent();
+	static uint32_t usToTicks(uint32_t us) { return us * clock_per_us; }
+	static uint32_t ticksToUs(uint32_t ticks) { return ticks / clock_per_us; }
 
 	uint32_t getCumulatedTimeUsAndReset();
 	uint32_t getMaxTimeUsAndReset();
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <new>
+#include <stddef.h>
+#include <stdlib.h>
+
+// Counts the allocations of the test through a replacement of the global operator new.
+// Replacement functions can't be inline: include this header from a single file of each test.
+inline size_t allocationCount = 0;
+
+// Not inlined, so the compiler doesn't pair the allocations and deallocations with malloc and free
+__attribute__((noinline)) void* operator new(size_t size) {
+	allocationCount++;
+	void* ptr = malloc(size ? size : 1);
+	if(!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, size_t) noexcept {
+	free(ptr);
+}
@@ -0,0 +1,204 @@
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <ConfigStorage.h>
+#include <Osc/OscSchemaNode.h>
+#include <Osc/OscVariable.h>
+#include <TimeMeasure.h>
+#include <Utils.h>
+#include <iterator>
+#include <memory>
+#include <stm32f7xx_hal.h>
+#include <sys/mman.h>
+#include <vector>
+
+// Persisted configuration over a mocked flash sector: each block of main is a boot of the device
+
+uint32_t TimeMeasure::clock_per_us = 1;
+uint32_t TimeMeasure::getCurrent() {
+	return 0;
+}
+
+class TestConfigStorage : public ConfigStorage {
+public:
+	using ConfigStorage::ConfigStorage;
+	using ConfigStorage::STORAGE_ADDRESS;
+	using ConfigStorage::STORAGE_SIZE;
+};
+
+// The storage is the sector given back by the linker script (FLASH is 384K of the 512K)
+static_assert(TestConfigStorage::STORAGE_ADDRESS == MockFlash::SECTOR_7_ADDRESS);
+static_assert(TestConfigStorage::STORAGE_SIZE == MockFlash::SECTOR_7_SIZE);
+static_assert(MockFlash::SECTOR_7_ADDRESS == 0x08000000 + 384 * 1024);
+
+// Value with the address hash of another one
+class CollidingVariable : public OscVariable<float> {
+public:
+	CollidingVariable(OscContainer* parent, std::string_view name, uint32_t hash)
+	    : OscVariable<float>(parent, name, 1.0f), hash(hash) {}
+	uint32_t getConfigAddressHash(size_t) const override { return hash; }
+
+private:
+	uint32_t hash;
+};
+
+struct Parameters {
+	bool enable;
+	int32_t count;
+	float level;
+};
+
+static constexpr OscSchemaEntry PARAMETERS_SCHEMA[] = {
+    OSC_SCHEMA_ENTRY(Parameters, enable, false),
+    OSC_SCHEMA_ENTRY(Parameters, count, 3, 0, 10),
+    OSC_SCHEMA_ENTRY(Parameters, level, 1.0f),
+};
+static_assert(oscSchemaIsValid(PARAMETERS_SCHEMA));
+
+class ParametersNode : public OscSchemaNode {
+public:
+	ParametersNode(OscContainer* parent)
+	    : OscSchemaNode(parent, "parameters", PARAMETERS_SCHEMA, std::size(PARAMETERS_SCHEMA), &values) {
+		initValues();
+	}
+
+	Parameters values;
+};
+
+struct Device {
+	OscRoot root{true};
+	TestConnector client{&root};
+	TestConfigStorage storage{&root};
+	OscVariable<bool> enable{&root, "enable", false};
+	OscVariable<int32_t> count{&root, "count", 3};
+	OscVariable<std::string> name{&root, "name", "x"};
+	ParametersNode parameters{&root};
+	CollidingVariable collidingA{&root, "collidingA", 0x1234};
+	CollidingVariable collidingB{&root, "collidingB", 0x1234};
+	OscContainer levelContainer{&root, "level"};
+	std::vector<std::unique_ptr<OscVariable<float>>> levels;
+
+	Device() {
+		// Node names are not copied, Utils::toString keeps them
+		levels.reserve(100);
+		for(uint32_t i = 0; i < 100; i++)
+			levels.emplace_back(new OscVariable<float>(&levelContainer, Utils::toString(i), 1.0f));
+		storage.prepare();
+		storage.restore();
+	}
+
+	// Run the persist task until it has nothing to do
+	void persist() {
+		while(storage.persistSlice()) {
+		}
+	}
+
+	bool isFull() {
+		root.flushMessages();
+		return client.hasSent("/config/full true");
+	}
+};
+
+int main() {
+	void* sector = mmap((void*) (uintptr_t) MockFlash::SECTOR_7_ADDRESS,
+	                    MockFlash::SECTOR_7_SIZE,
+	                    PROT_READ | PROT_WRITE,
+	                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+	                    -1,
+	                    0);
+	if(sector != (void*) (uintptr_t) MockFlash::SECTOR_7_ADDRESS) {
+		printf("can't map the flash sector\n");
+		return 1;
+	}
+	// Content of a sector never used by the configuration
+	memset(sector, 0x5A, MockFlash::SECTOR_7_SIZE);
+
+	{
+		Device device;
+		CHECK(MockFlash::eraseCount == 1);
+		device.persist();
+
+		device.levels[7]->set(0.25f);
+		device.enable.set(true);
+		device.count.set(42);
+		device.name.set("hello");
+		device.root.execute("parameters/count", std::vector<OscArgument>{int32_t{42}});
+		device.parameters.setValue(2, 2.5f);
+		device.collidingA.set(5.0f);
+		MockFlash::programCount = 0;
+		device.persist();
+		CHECK(MockFlash::programCount > 0);
+
+		// Already persisted
+		MockFlash::programCount = 0;
+		device.levels[7]->set(0.25f);
+		device.persist();
+		CHECK(MockFlash::programCount == 0);
+	}
+
+	{
+		Device device;
+		CHECK(MockFlash::eraseCount == 1);
+		CHECK(device.levels[7]->get() == 0.25f);
+		CHECK(device.levels[8]->get() == 1.0f);
+		CHECK(device.enable.get());
+		CHECK(device.count.get() == 42);
+		CHECK(device.name.get() == "hello");
+		// Clamped to the schema range when set, then persisted
+		CHECK(device.parameters.values.count == 10);
+		CHECK(device.parameters.values.level == 2.5f);
+		CHECK(!device.parameters.values.enable);
+		// Values sharing an address hash are not persisted
+		CHECK(device.collidingA.get() == 1.0f);
+
+		// Back to the default value
+		device.count.forceDefault(3);
+		device.persist();
+	}
+
+	{
+		Device device;
+		CHECK(device.count.get() == 3);
+		CHECK(device.count.isDefault());
+
+		// Power loss while programming a record
+		MockFlash::failAfter = 3;
+		device.name.set("partially written string");
+		device.persist();
+		MockFlash::failAfter = -1;
+	}
+
+	{
+		// The partial record is discarded by compacting the sector
+		Device device;
+		CHECK(MockFlash::eraseCount == 2);
+		CHECK(device.name.get() == "hello");
+		CHECK(device.levels[7]->get() == 0.25f);
+
+		// Fill the sector, changes are then kept for the next boot
+		for(int i = 0; i < 20000 && !device.isFull(); i++) {
+			device.levels[i % device.levels.size()]->set(i * 0.5f);
+			device.persist();
+		}
+		CHECK(device.isFull());
+	}
+
+	{
+		// A sector more than 3/4 full is compacted, the latest values are kept
+		Device device;
+		CHECK(MockFlash::eraseCount == 3);
+		CHECK(!device.isFull());
+		CHECK(device.name.get() == "hello");
+		CHECK(device.parameters.values.count == 10);
+
+		device.levels[1]->set(-5.0f);
+		device.persist();
+	}
+
+	{
+		Device device;
+		CHECK(MockFlash::eraseCount == 3);
+		CHECK(device.levels[1]->get() == -5.0f);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,132 @@
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <FilteringChain.h>
+#include <math.h>
+#include <vector>
+
+// Timetagged parameters of a filter chain apply at their exact sample: the block is split at the timetag and the
+// changed parameters are compiled before the next segment, as in AudioProcessor::processAudioInterleaved
+
+static constexpr size_t BLOCK_SIZE = 48;
+static constexpr size_t NUM_CHANNEL = 2;
+static constexpr uint64_t TIMETAG_PER_SAMPLE = 1 << 16;
+
+struct Strip {
+	Strip() : client(&root), numChannel(&root, "numChannel", 0), sampleRate(&root, "sampleRate", 48000) {
+		numChannel.set(NUM_CHANNEL);
+		filterChain.reset(48000);
+		root.execute("filterChain/eqFilters/0/enable", std::vector<OscArgument>{true});
+		root.execute("filterChain/eqFilters/0/type", std::vector<OscArgument>{(int32_t) FilterType::Peak});
+	}
+
+	OscRoot root{true};
+	TestConnector client;
+	OscReadOnlyVariable<int32_t> numChannel;
+	OscReadOnlyVariable<int32_t> sampleRate;
+	FilterChain filterChain{&root, &numChannel, &sampleRate};
+	uint64_t sampleClock = 0;
+	std::vector<float> output;
+};
+
+template<typename... Args>
+static void schedule(Strip& strip, uint64_t sample, const char* address, const char* format, Args... args) {
+	char buffer[256];
+	tosc_bundle bundle;
+	tosc_writeBundle(&bundle, sample * TIMETAG_PER_SAMPLE, buffer, sizeof(buffer));
+	tosc_writeNextMessage(&bundle, address, format, args...);
+	strip.client.receivePacket(buffer, tosc_getBundleLength(&bundle));
+}
+
+static float peakOfLastBlock(const Strip& strip) {
+	float peak = 0;
+	for(size_t i = strip.output.size() - BLOCK_SIZE; i < strip.output.size(); i++)
+		peak = fmaxf(peak, fabsf(strip.output[i]));
+	return peak;
+}
+
+// Process one block of a 1 kHz sine, keep the left channel
+static void processBlock(Strip& strip) {
+	float left[BLOCK_SIZE];
+	float right[BLOCK_SIZE];
+	for(size_t i = 0; i < BLOCK_SIZE; i++) {
+		left[i] = right[i] = 0.5f * sinf(2 * (float) M_PI * 1000 * (strip.sampleClock + i) / 48000);
+	}
+
+	// Main loop between blocks, then the start of the block
+	if(strip.filterChain.compileParameters())
+		strip.filterChain.swapParameters();
+	strip.root.executeReceivedMessages();
+
+	size_t offset = 0;
+	while(offset < BLOCK_SIZE) {
+		uint64_t nextTimetag = strip.root.getNextScheduledTimetag();
+		uint64_t nextMessageTime = nextTimetag == OscRoot::NO_SCHEDULED_MESSAGE ? UINT64_MAX
+		                                                                          : nextTimetag / TIMETAG_PER_SAMPLE;
+		uint64_t currentTime = strip.sampleClock + offset;
+
+		if(nextMessageTime <= currentTime) {
+			strip.root.executeScheduledMessages(currentTime * TIMETAG_PER_SAMPLE);
+			strip.filterChain.compileActiveParameters();
+			continue;
+		}
+
+		size_t count = BLOCK_SIZE - offset;
+		if(nextMessageTime < currentTime + count)
+			count = nextMessageTime - currentTime;
+
+		float* samples[] = {&left[offset], &right[offset]};
+		strip.filterChain.processSamples(samples, NUM_CHANNEL, count);
+		offset += count;
+	}
+	strip.sampleClock += BLOCK_SIZE;
+	strip.output.insert(strip.output.end(), left, left + BLOCK_SIZE);
+}
+
+int main() {
+	Strip strip;
+	Strip reference;
+
+	// Mute from sample 20 of the first block to sample 8 of the second one, in both strips
+	for(Strip* s : {&strip, &reference}) {
+		schedule(*s, 20, "/filterChain/mute", "T");
+		schedule(*s, BLOCK_SIZE + 8, "/filterChain/mute", "F");
+	}
+	// EQ gain at sample 30 of the second block, only in the tested strip
+	schedule(strip, BLOCK_SIZE + 30, "/filterChain/eqFilters/0/gain", "f", 12.0f);
+
+	for(size_t block = 0; block < 3; block++) {
+		processBlock(strip);
+		processBlock(reference);
+	}
+
+	CHECK(strip.output[19] != 0);
+	for(size_t i = 20; i < BLOCK_SIZE + 8; i++)
+		CHECK(strip.output[i] == 0);
+	CHECK(strip.output[BLOCK_SIZE + 8] != 0);
+
+	for(size_t i = 0; i < BLOCK_SIZE + 30; i++)
+		CHECK(strip.output[i] == reference.output[i]);
+	CHECK(strip.output[BLOCK_SIZE + 30] != reference.output[BLOCK_SIZE + 30]);
+
+	// Already compiled by the audio processing, the main loop has nothing left to compile
+	CHECK(!strip.filterChain.compileParameters());
+
+	// +12 dB at 1 kHz once the filter settled
+	for(size_t block = 0; block < 20; block++) {
+		processBlock(strip);
+		processBlock(reference);
+	}
+	CHECK(peakOfLastBlock(strip) > peakOfLastBlock(reference) * 3);
+
+	// Other stages are compiled the same way: the compressor enabled at sample 14 of the next block, near a peak of the
+	// sine, brings it back to 0 dBFS from that sample. Before it the output repeats the previous period.
+	uint64_t compressorSample = strip.sampleClock + 14;
+	schedule(strip, compressorSample, "/filterChain/compressorFilter/enable", "T");
+	processBlock(strip);
+	for(size_t i = compressorSample - 10; i < compressorSample; i++)
+		CHECK(fabsf(strip.output[i] - strip.output[i - BLOCK_SIZE]) < 1e-4f);
+	CHECK(fabsf(strip.output[compressorSample - BLOCK_SIZE]) > 1.5f);
+	CHECK(fabsf(strip.output[compressorSample]) < 1.1f);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,70 @@
+#include "AllocationCounter.h"
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <LoopbackMeasurement.h>
+#include <vector>
+
+// Latency found by the MLS measurement through a simulated loopback cable, without allocation once constructed and
+// unaffected by a type change while playing
+
+static constexpr size_t BLOCK_SIZE = 48;
+static constexpr size_t DELAY = 137;
+
+int main() {
+	OscRoot root(true);
+	TestConnector client(&root);
+	LoopbackMeasurement measurement(&root);
+	measurement.reset(48000);
+
+	// Output of the device looped back to its input with a delay and attenuation
+	std::vector<float> cable(DELAY + BLOCK_SIZE, 0);
+	float output[BLOCK_SIZE];
+	float input[BLOCK_SIZE];
+
+	std::vector<OscArgument> impulseType{(int32_t) LoopbackMeasurement::SignalType::Impulse};
+
+	size_t allocationsBefore = allocationCount;
+	root.execute("measurement/start", {});
+	CHECK(measurement.getOutputStrip() == 0);
+
+	size_t blocks = 0;
+	while(measurement.getOutputStrip() >= 0 && blocks < 1000) {
+		float* outputSamples[] = {output};
+		float* inputSamples[] = {input};
+
+		std::fill(std::begin(output), std::end(output), 0.f);
+		measurement.generateOutput(outputSamples, 1, BLOCK_SIZE);
+
+		for(size_t i = 0; i < BLOCK_SIZE; i++) {
+			cable[DELAY + i] = 0.5f * output[i];
+			input[i] = cable[i];
+		}
+		std::copy(cable.begin() + BLOCK_SIZE, cable.end(), cable.begin());
+
+		measurement.captureInput(inputSamples, BLOCK_SIZE);
+		blocks++;
+
+		// Changing the type while playing applies to the next measurement
+		if(blocks == 10)
+			root.execute("measurement/type", impulseType);
+	}
+
+	// Correlation and analysis slices, the last one sends the results
+	size_t slices = 0;
+	size_t allocationsBeforeLastSlice = allocationCount;
+	for(;;) {
+		size_t allocations = allocationCount;
+		if(!measurement.processBackgroundSlice() || slices >= 100000)
+			break;
+		allocationsBeforeLastSlice = allocations;
+		slices++;
+	}
+	CHECK(allocationsBeforeLastSlice == allocationsBefore);
+	printf("measured in %zu blocks and %zu background slices\n", blocks, slices);
+
+	root.flushMessages();
+	CHECK(client.hasSent("/measurement/latency " + std::to_string(DELAY)));
+	CHECK(slices > LoopbackMeasurement::IMPULSE_RESPONSE_LENGTH);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,147 @@
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <MemoryArena.h>
+#include <Osc/OscDynamicVariable.h>
+#include <Osc/OscVariable.h>
+#include <OscRoot.h>
+#include <Utils.h>
+#include <stm32f7xx.h>
+#include <vector>
+
+// Arena allocation, reuse of deleted blocks, freeze and allocations after it, over a mocked _sbrk
+
+static uint8_t heap[1 << 20] __attribute__((aligned(8)));
+
+extern "C" {
+uint8_t* __sbrk_heap_end = nullptr;
+
+// Same behavior as the firmware sysmem.c, the heap starts unaligned like after the C library data
+void* _sbrk(ptrdiff_t incr) {
+	if(!__sbrk_heap_end)
+		__sbrk_heap_end = heap + 4;
+	if(__sbrk_heap_end + incr > heap + sizeof(heap))
+		return (void*) -1;
+
+	uint8_t* previousHeapEnd = __sbrk_heap_end;
+	__sbrk_heap_end += incr;
+	return previousHeapEnd;
+}
+}
+
+// Sent messages are counted, not recorded
+class SilentConnector : public TestConnector {
+public:
+	using TestConnector::TestConnector;
+	size_t sentSize = 0;
+
+protected:
+	void sendOscData(const uint8_t*, size_t size) override { sentSize += size; }
+};
+
+static bool isInHeap(const void* ptr) {
+	return ptr >= heap && ptr < heap + sizeof(heap);
+}
+
+static MemoryArena::Statistics getStatistics() {
+	MemoryArena::Statistics statistics;
+	MemoryArena::getStatistics(&statistics);
+	return statistics;
+}
+
+int main() {
+	MemoryArena::setSubsystem(MemoryArena::Subsystem::Osc);
+	OscRoot* root = new OscRoot(false);
+	CHECK(isInHeap(root));
+	CHECK(((uintptr_t) root & (MemoryArena::ALIGNMENT - 1)) == 0);
+
+	MemoryArena::setSubsystem(MemoryArena::Subsystem::Strips);
+	uint32_t stripsSizeBefore = getStatistics().subsystemSize[(size_t) MemoryArena::Subsystem::Strips];
+	for(uint32_t i = 0; i < 5; i++) {
+		OscContainer* strip = new OscContainer(root, Utils::toString(i));
+		for(uint32_t v = 0; v < 40; v++)
+			new OscVariable<float>(strip, Utils::toString(v), 1.0f);
+	}
+	CHECK(getStatistics().subsystemSize[(size_t) MemoryArena::Subsystem::Strips] > stripsSizeBefore);
+	// Interrupts masked while changing the arena, then restored
+	CHECK(MockCpu::disableCount > 0);
+	CHECK(MockCpu::primask == 0);
+
+	// The latest block is given back
+	uint32_t wastedBefore = getStatistics().wastedSize;
+	uint8_t* temporary = new uint8_t[100];
+	delete[] temporary;
+	uint8_t* next = new uint8_t[100];
+	CHECK(next == temporary);
+	CHECK(getStatistics().wastedSize == wastedBefore);
+
+	// Other deleted blocks are reused by the next allocation of the same size
+	uint64_t* first = (uint64_t*) ::operator new(8 * sizeof(uint64_t));
+	uint64_t* second = (uint64_t*) ::operator new(8 * sizeof(uint64_t));
+	CHECK(second != first);
+	wastedBefore = getStatistics().wastedSize;
+	::operator delete(first, 8 * sizeof(uint64_t));
+	CHECK(getStatistics().wastedSize == wastedBefore + 8 * sizeof(uint64_t));
+	uint64_t* reused = (uint64_t*) ::operator new(8 * sizeof(uint64_t));
+	CHECK(reused == first);
+	CHECK(getStatistics().wastedSize == wastedBefore);
+
+	// Deleting with interrupts already masked keeps them masked
+	MockCpu::primask = 1;
+	::operator delete(reused, 8 * sizeof(uint64_t));
+	CHECK(MockCpu::primask == 1);
+	MockCpu::primask = 0;
+
+	// C code moving the heap end: a new chunk is started, the end of the previous one is lost
+	MemoryArena::setSubsystem(MemoryArena::Subsystem::Config);
+	uint32_t arenaSizeBefore = getStatistics().arenaSize;
+	_sbrk(100);
+	std::vector<int>* large = new std::vector<int>(5000);
+	CHECK(isInHeap(large->data()));
+	CHECK(getStatistics().arenaSize >= arenaSizeBefore + 5000 * sizeof(int));
+	CHECK(getStatistics().wastedSize > wastedBefore);
+	CHECK(((uintptr_t) large->data() & (MemoryArena::ALIGNMENT - 1)) == 0);
+
+	// Telemetry nodes created at init, their first message is sent after the freeze
+	SilentConnector* client = new SilentConnector(root);
+	OscContainer* strip = new OscContainer(root, "strip");
+	OscDynamicVariable<float>* meter = new OscDynamicVariable<float>(strip, "meter_per_channel");
+	OscDynamicVariable<int32_t>* clock = new OscDynamicVariable<int32_t>(root, "clock");
+
+	// The unused end of the last chunk is given back to the heap
+	uint8_t* lastBlock = (uint8_t*) ::operator new(8);
+	uint8_t* lastBlockEnd = lastBlock + 8;
+	uint32_t arenaSize = getStatistics().arenaSize;
+	uint8_t* heapEnd = __sbrk_heap_end;
+	MemoryArena::freeze();
+	CHECK(__sbrk_heap_end == lastBlockEnd);
+	CHECK(__sbrk_heap_end < heapEnd);
+	CHECK(getStatistics().arenaSize == arenaSize - (heapEnd - __sbrk_heap_end));
+	CHECK(MockCpu::primask == 0);
+
+	// After the freeze, allocations use malloc and are counted, the latest arena block is not given back anymore
+	CHECK(getStatistics().allocationsAfterFreeze == 0);
+	OscVariable<int32_t>* late = new OscVariable<int32_t>(root, "late");
+	CHECK(!isInHeap(late));
+	CHECK(getStatistics().allocationsAfterFreeze > 0);
+	CHECK(getStatistics().heapGrowthAfterFreeze == 0);
+
+	// Steady state: telemetry and its cached message headers don't allocate, even when the number of values changes
+	uint32_t allocationsBefore = getStatistics().allocationsAfterFreeze;
+	for(int i = 0; i < 3; i++) {
+		OscArgument levels[] = {-10.0f, -12.0f, -20.0f, -30.0f};
+		meter->sendMessage(levels, i == 2 ? 4 : 2);
+		OscArgument time = int32_t{i};
+		clock->sendMessage(&time, 1);
+		root->flushMessages();
+	}
+	CHECK(client->sentSize > 0);
+	CHECK(getStatistics().allocationsAfterFreeze == allocationsBefore);
+
+	wastedBefore = getStatistics().wastedSize;
+	::operator delete(lastBlock, 8);
+	CHECK(getStatistics().wastedSize == wastedBefore + 8);
+	CHECK(__sbrk_heap_end == lastBlockEnd);
+	delete late;
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,132 @@
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <Osc/OscVariable.h>
+#include <Utils.h>
+#include <memory>
+#include <stdlib.h>
+#include <vector>
+
+// Dumps run a few nodes per dumpSlice: paced by the connectors, only changed values for a delta dump, and resumed
+// safely when the dumped subtree is removed
+
+static constexpr size_t VALUE_NUMBER = 100;
+
+struct Strip {
+	Strip(OscContainer* parent, std::string_view name, size_t valueNumber) : container(parent, name) {
+		values.reserve(valueNumber);
+		for(size_t i = 0; i < valueNumber; i++)
+			values.emplace_back(new OscVariable<float>(&container, Utils::toString(i), 1.0f));
+	}
+
+	OscContainer container;
+	std::vector<std::unique_ptr<OscVariable<float>>> values;
+};
+
+// Run the dump task until done, return the number of slices
+static size_t runDump(OscRoot& root) {
+	size_t slices = 0;
+	while(root.dumpSlice()) {
+		slices++;
+		root.flushMessages();
+	}
+	root.flushMessages();
+	return slices;
+}
+
+static size_t countMessages(const TestConnector& client, const std::string& prefix) {
+	size_t count = 0;
+	for(const std::string& message : client.messages) {
+		if(message.compare(0, prefix.size(), prefix) == 0)
+			count++;
+	}
+	return count;
+}
+
+// Sequence number of the "<address>/dump <seq>" reply
+static int32_t getDumpEnd(const TestConnector& client, const std::string& address) {
+	std::string prefix = address + "/dump ";
+	for(const std::string& message : client.messages) {
+		if(message.compare(0, prefix.size(), prefix) == 0)
+			return atoi(message.c_str() + prefix.size());
+	}
+	return -1;
+}
+
+int main() {
+	OscRoot root(true);
+	TestConnector client(&root);
+	Strip strip(&root, "strip", VALUE_NUMBER);
+	root.flushMessages();
+	client.messages.clear();
+
+	// Full dump: the container, its dump endpoint and its values, DUMP_SLICE_NODES nodes per slice
+	CHECK(client.receive("/strip/dump", "") > 0);
+	size_t slices = 0;
+	while(root.dumpSlice()) {
+		slices++;
+		size_t before = client.messages.size();
+		root.flushMessages();
+		CHECK(client.messages.size() - before <= OscRoot::DUMP_SLICE_NODES);
+	}
+	size_t nodeNumber = VALUE_NUMBER + 2;
+	CHECK(slices == (nodeNumber + OscRoot::DUMP_SLICE_NODES - 1) / OscRoot::DUMP_SLICE_NODES);
+	// Values and the end reply
+	CHECK(countMessages(client, "/strip/") == VALUE_NUMBER + 1);
+	CHECK(client.hasSent("/strip/99 1"));
+	// The end reply comes last
+	CHECK(client.messages.back().compare(0, 12, "/strip/dump ") == 0);
+	int32_t sequence = getDumpEnd(client, "/strip");
+	CHECK(sequence >= 0);
+
+	// Delta dump: only the values changed after the sequence number of the previous dump
+	strip.values[3]->set(2.0f);
+	strip.values[70]->set(3.0f);
+	root.flushMessages();
+	client.messages.clear();
+	CHECK(client.receive("/strip/dump", "i", sequence) > 0);
+	runDump(root);
+	CHECK((client.messages == std::vector<std::string>{"/strip/3 2", "/strip/70 3", client.messages.back()}));
+	CHECK(getDumpEnd(client, "/strip") > sequence);
+
+	// Congestion: no slice while a connector has no room, the dump goes on once it has
+	client.messages.clear();
+	client.telemetryAllowed = false;
+	CHECK(client.receive("/strip/dump", "") > 0);
+	CHECK(!root.dumpSlice());
+	root.flushMessages();
+	CHECK(client.messages.empty());
+	client.telemetryAllowed = true;
+	runDump(root);
+	CHECK(countMessages(client, "/strip/") == VALUE_NUMBER + 1);
+
+	// A removed container drops its pending dump
+	{
+		Strip removed(&root, "removed", 10);
+		root.flushMessages();
+		client.messages.clear();
+		CHECK(client.receive("/removed/dump", "") > 0);
+	}
+	CHECK(runDump(root) == 0);
+	CHECK(client.messages.empty());
+
+	// The cursor is moved out of a removed subtree: the dump restarts without it
+	OscContainer group(&root, "group");
+	std::unique_ptr<Strip> first(new Strip(&group, "first", 2 * OscRoot::DUMP_SLICE_NODES));
+	Strip second(&group, "second", 5);
+	root.flushMessages();
+	client.messages.clear();
+	CHECK(client.receive("/group/dump", "") > 0);
+	// The first slice ends in "first"
+	CHECK(root.dumpSlice());
+	root.flushMessages();
+	CHECK(client.hasSent("/group/first/0 1"));
+	CHECK(!client.hasSent("/group/first/63 1"));
+	first.reset();
+	client.messages.clear();
+	runDump(root);
+	CHECK(!client.hasSent("/group/first/"));
+	CHECK(countMessages(client, "/group/second/") == 5);
+	CHECK(client.messages.back().compare(0, 12, "/group/dump ") == 0);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,53 @@
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <Osc/OscDynamicVariable.h>
+#include <vector>
+
+// Telemetry nodes send from a cached message header: it follows the node address and its type tags
+
+int main() {
+	OscRoot root(true);
+	TestConnector client(&root);
+	OscContainer strips(&root, "strips");
+	OscContainer strip(&root, "strip");
+	OscDynamicVariable<float> meter(&strip, "meter");
+
+	auto send = [&](std::vector<OscArgument> arguments) {
+		client.messages.clear();
+		client.formats.clear();
+		meter.sendMessage(arguments.data(), arguments.size());
+		root.flushMessages();
+	};
+
+	send({-10.0f, -20.0f});
+	CHECK((client.messages == std::vector<std::string>{"/strip/meter -10 -20"}));
+	CHECK((client.formats == std::vector<std::string>{",ff"}));
+
+	// Cached
+	send({-11.0f, -21.0f});
+	CHECK((client.messages == std::vector<std::string>{"/strip/meter -11 -21"}));
+
+	// More type tags, with a larger padded size (channel count change)
+	send({-10.0f, -20.0f, -30.0f, -40.0f});
+	CHECK((client.messages == std::vector<std::string>{"/strip/meter -10 -20 -30 -40"}));
+	CHECK((client.formats == std::vector<std::string>{",ffff"}));
+
+	// Other type tags with the same padded size
+	send({-10.0f, int32_t{3}, -30.0f, -40.0f});
+	CHECK((client.formats == std::vector<std::string>{",fiff"}));
+	send({-10.0f, -20.0f, -30.0f});
+	CHECK((client.messages == std::vector<std::string>{"/strip/meter -10 -20 -30"}));
+	CHECK((client.formats == std::vector<std::string>{",fff"}));
+
+	// The container is moved: the header of its children is rebuilt at the new address
+	strip.setOscParent(&strips);
+	send({-10.0f, -20.0f, -30.0f});
+	CHECK((client.messages == std::vector<std::string>{"/strips/strip/meter -10 -20 -30"}));
+	CHECK((client.formats == std::vector<std::string>{",fff"}));
+
+	send({-10.0f});
+	CHECK((client.messages == std::vector<std::string>{"/strips/strip/meter -10"}));
+	CHECK((client.formats == std::vector<std::string>{",f"}));
+
+	return TEST_RESULT();
+}
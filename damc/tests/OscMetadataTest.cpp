@@ -0,0 +1,107 @@
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <CompressorFilter.h>
+#include <EqFilter.h>
+#include <FilteringChain.h>
+#include <MathUtils.h>
+#include <Osc/OscVariable.h>
+#include <math.h>
+#include <vector>
+
+// Values are clamped to their metadata range (NaN refused), clamped OSC writes are echoed and "/schema" exports the
+// metadata of each described value
+
+static constexpr OscMetadata LEVEL_METADATA = oscRange(-10, 10, "dB");
+static constexpr OscMetadata CHOICE_METADATA = oscEnum("a,b,c");
+
+static void setFromOsc(OscRoot& root, const char* address, OscArgument value) {
+	root.execute(address, std::vector<OscArgument>{value});
+}
+
+int main() {
+	OscRoot root(false);
+	TestConnector client(&root);
+	OscVariable<float> level(&root, "level", 0);
+	OscVariable<float> volume(&root, "volume", 1);
+	OscVariable<int32_t> choice(&root, "choice", 0);
+	OscVariable<float> unbounded(&root, "unbounded", 0);
+	OscContainer chain(&root, "chain");
+	CompressorFilter compressor(&chain);
+	EqFilter eq(&chain, "eq");
+
+	level.setMetadata(&LEVEL_METADATA);
+	volume.setOscConverters(&LogScaleOscConverter);
+	volume.setMetadata(&LEVEL_METADATA);
+	choice.setMetadata(&CHOICE_METADATA);
+
+	// Clamping and NaN
+	level.set(50);
+	CHECK(level.get() == 10);
+	level.set(-50);
+	CHECK(level.get() == -10);
+	level.set(NAN);
+	CHECK(level.get() == -10);
+	choice.set(7);
+	CHECK(choice.get() == 2);
+	choice.set(-3);
+	CHECK(choice.get() == 0);
+	unbounded.set(1e30f);
+	CHECK(unbounded.get() == 1e30f);
+	unbounded.set(NAN);
+	CHECK(isnan(unbounded.get()));
+
+	// The range of converted values is in their OSC representation
+	volume.set(100);
+	CHECK(LogScaleToOsc(volume.get()) <= 10.01f);
+	setFromOsc(root, "volume", -50.0f);
+	CHECK(fabsf(LogScaleToOsc(volume.get()) + 10) < 0.01f);
+
+	// EQ frequencies stay below the Nyquist frequency
+	setFromOsc(root, "chain/eq/f0", 24000.0f);
+	root.flushMessages();
+	CHECK(client.hasSent("/chain/eq/f0 20000"));
+
+	// A clamped OSC write is sent back with the applied value
+	root.flushMessages();
+	client.messages.clear();
+	setFromOsc(root, "level", 99.0f);
+	root.flushMessages();
+	CHECK((client.messages == std::vector<std::string>{"/level 10"}));
+
+	// Export: only values with metadata and schema entries, then the number of exported values
+	client.messages.clear();
+	CHECK(client.receive("/schema", "") > 0);
+	while(root.dumpSlice())
+		root.flushMessages();
+	root.flushMessages();
+
+	CHECK(client.hasSent("/schema /level f -10 10 dB 0"));
+	CHECK(client.hasSent("/schema /choice i 0 2  0 a,b,c"));
+	CHECK(client.hasSent("/schema /chain/compressorFilter/enable T"));
+	CHECK(client.hasSent("/schema /chain/compressorFilter/ratio f 1 "));
+	CHECK(client.hasSent("/schema /chain/eq/f0 f 10 20000 Hz"));
+	CHECK(!client.hasSent("/schema /unbounded"));
+
+	// level, volume, choice, 8 compressor entries, 8 EQ values
+	CHECK(client.messages.back() == "/schema 19");
+
+	// The DC blocker range only has values its check accepts
+	OscReadOnlyVariable<int32_t> numChannel(&root, "numChannel", 2);
+	OscReadOnlyVariable<int32_t> sampleRate(&root, "sampleRate", 48000);
+	FilterChain filterChain(&root, &numChannel, &sampleRate);
+	filterChain.reset(48000);
+	setFromOsc(root, "filterChain/dcBlockerFrequency", 0.0f);
+	root.flushMessages();
+	CHECK(client.hasSent("/filterChain/dcBlockerFrequency 1"));
+	setFromOsc(root, "filterChain/dcBlockerFrequency", 30000.0f);
+	root.flushMessages();
+	CHECK(client.hasSent("/filterChain/dcBlockerFrequency 20000"));
+	client.messages.clear();
+	CHECK(client.receive("/schema", "") > 0);
+	while(root.dumpSlice())
+		root.flushMessages();
+	root.flushMessages();
+	CHECK(client.hasSent("/schema /filterChain/dcBlockerFrequency f 1 20000 Hz"));
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,90 @@
+#include "AllocationCounter.h"
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <CompressorFilter.h>
+#include <Osc/OscVariable.h>
+#include <vector>
+
+// The receive path doesn't allocate once warmed up: SLIP decoding, parsing, argument vectors, execution, immediate and
+// timetagged bundles, the received message queue and the replies, from the main loop and the audio processing
+
+// Replies are counted, not recorded
+class SilentConnector : public TestConnector {
+public:
+	using TestConnector::TestConnector;
+	size_t sentSize = 0;
+
+protected:
+	void sendOscData(const uint8_t*, size_t size) override { sentSize += size; }
+};
+
+template<typename... Args> static std::vector<uint8_t> message(const char* address, const char* format, Args... args) {
+	char buffer[128];
+	uint32_t size = tosc_writeMessage(buffer, sizeof(buffer), address, format, args...);
+	return TestConnector::encodeFrame(buffer, size);
+}
+
+static std::vector<uint8_t> bundle(uint64_t timetag, float value) {
+	char buffer[128];
+	tosc_bundle bundle;
+	tosc_writeBundle(&bundle, timetag, buffer, sizeof(buffer));
+	tosc_writeNextMessage(&bundle, "/filter/gain", "f", value);
+	tosc_writeNextMessage(&bundle, "/compressorFilter/threshold", "f", -value);
+	return TestConnector::encodeFrame(buffer, tosc_getBundleLength(&bundle));
+}
+
+int main() {
+	OscRoot root(true);
+	SilentConnector client(&root);
+	OscContainer filter(&root, "filter");
+	OscVariable<float> gain(&filter, "gain", 0.f);
+	OscVariable<bool> mute(&filter, "mute", false);
+	OscVariable<int32_t> count(&filter, "count", 0);
+	CompressorFilter compressor(&root);
+
+	// All frames are encoded before counting, escaped bytes make rounds of different sizes
+	static constexpr size_t ROUNDS = 20;
+	std::vector<std::vector<uint8_t>> frames(ROUNDS);
+	for(size_t i = 0; i < ROUNDS; i++) {
+		for(const std::vector<uint8_t>& frame : {message("/filter/gain", "f", (float) i),
+		                                          message("/filter/mute/toggle", ""),
+		                                          message("/filter/count/increment", "i", 2),
+		                                          message("/compressorFilter/ratio", "f", 2.0f + i),
+		                                          message("/filter/gain", "ffff", 1.0f, 2.0f, 3.0f, 4.0f),
+		                                          bundle(1, 10.0f + i),
+		                                          bundle(((uint64_t) i + 1) << 32, 20.0f + i)}) {
+			frames[i].insert(frames[i].end(), frame.begin(), frame.end());
+		}
+	}
+
+	auto receiveRound = [&](size_t round) {
+		client.receiveRaw(frames[round].data(), frames[round].size());
+		// Same order as the audio processing: received messages at the start of the block, then the scheduled ones
+		root.executeReceivedMessages();
+		root.executeScheduledMessages(((uint64_t) round + 1) << 32);
+		root.flushMessages();
+	};
+
+	// The first round reserves the reused buffers (addresses, output frames)
+	receiveRound(0);
+
+	size_t allocationsBefore = allocationCount;
+	for(size_t round = 1; round < ROUNDS / 2; round++)
+		receiveRound(round);
+	CHECK(allocationCount == allocationsBefore);
+	CHECK(gain.get() == 20.0f + ROUNDS / 2 - 1);
+	CHECK(count.get() == 2 * (int32_t) (ROUNDS / 2));
+
+	// Same through the received message queue executed by the audio processing
+	root.enableReceivedMessageQueue();
+	receiveRound(ROUNDS / 2);
+	allocationsBefore = allocationCount;
+	for(size_t round = ROUNDS / 2 + 1; round < ROUNDS; round++)
+		receiveRound(round);
+	CHECK(allocationCount == allocationsBefore);
+	CHECK(gain.get() == 20.0f + ROUNDS - 1);
+	CHECK(count.get() == 2 * (int32_t) ROUNDS);
+	CHECK(client.sentSize > 0);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,119 @@
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <Osc/OscEndpoint.h>
+#include <Osc/OscVariable.h>
+#include <vector>
+
+// With the received message queue: parameters are queued for the audio processing, other messages are executed by the
+// main loop once the queue is drained with the audio processing held, packets that can't be taken yet are received
+// again later, so nothing is dropped nor executed out of order
+
+template<typename... Args> static std::vector<uint8_t> message(const char* address, const char* format, Args... args) {
+	char buffer[128];
+	uint32_t size = tosc_writeMessage(buffer, sizeof(buffer), address, format, args...);
+	return TestConnector::encodeFrame(buffer, size);
+}
+
+int main() {
+	OscRoot root(true);
+	TestConnector client(&root);
+	OscContainer filter(&root, "filter");
+	OscVariable<float> gain(&filter, "gain", 0.f);
+	OscVariable<int32_t> delay(&filter, "delay", 0);
+	OscEndpoint trigger(&filter, "trigger");
+	delay.setMainLoopOnly();
+
+	std::vector<bool> holds;
+	root.setHoldAudioProcessing([&holds](bool hold) { holds.push_back(hold); });
+	float gainAtTrigger = -1;
+	trigger.setCallback([&](const std::vector<OscArgument>&) { gainAtTrigger = gain.get(); });
+
+	root.enableReceivedMessageQueue();
+
+	// Parameters are queued, not executed by the main loop
+	std::vector<uint8_t> data;
+	for(size_t i = 0; i < OscRoot::RECEIVED_MESSAGE_NUMBER + 4; i++) {
+		std::vector<uint8_t> frame = message("/filter/gain", "f", (float) i + 1);
+		data.insert(data.end(), frame.begin(), frame.end());
+	}
+	std::vector<uint8_t> frame = message("/filter/trigger", "");
+	data.insert(data.end(), frame.begin(), frame.end());
+	frame = message("/filter/delay", "i", 5);
+	data.insert(data.end(), frame.begin(), frame.end());
+
+	// Back-pressure: the data after the queued frames is kept by the client
+	size_t offset = client.receiveRaw(data.data(), data.size());
+	CHECK(offset < data.size());
+	CHECK(gain.get() == 0);
+	CHECK(holds.empty());
+
+	// Received again until all is taken, the audio processing executes the queue between calls
+	size_t rounds = 0;
+	while(offset < data.size() && rounds++ < 10) {
+		root.executeReceivedMessages();
+		offset += client.receiveRaw(data.data() + offset, data.size() - offset);
+	}
+	CHECK(offset == data.size());
+
+	// The endpoint and the main loop only variable waited for the gains received before them
+	CHECK(gainAtTrigger == OscRoot::RECEIVED_MESSAGE_NUMBER + 4);
+	CHECK(delay.get() == 5);
+	CHECK((holds == std::vector<bool>{true, false, true, false}));
+
+	// A dump waits for the sets received before it
+	root.flushMessages();
+	client.messages.clear();
+	CHECK(client.receive("/filter/gain", "f", 42.0f) > 0);
+	frame = message("/filter/gain/dump", "");
+	offset = client.receiveRaw(frame.data(), frame.size());
+	CHECK(offset < frame.size());
+	root.flushMessages();
+	CHECK(client.messages.empty());
+	root.executeReceivedMessages();
+	CHECK(client.receiveRaw(frame.data() + offset, frame.size() - offset) == frame.size() - offset);
+	root.flushMessages();
+	// The set is notified, then dumped with its new value
+	CHECK((client.messages == std::vector<std::string>{"/filter/gain 42", "/filter/gain 42"}));
+
+	CHECK(client.receive("/filter/gain", "f", 43.0f) > 0);
+	CHECK(!root.triggerAddress("/filter/trigger"));
+	root.executeReceivedMessages();
+	CHECK(root.triggerAddress("/filter/trigger"));
+	CHECK(gainAtTrigger == 43.0f);
+
+	// A bundle is taken message by message: the gain is queued once, the endpoint waits for it
+	char buffer[128];
+	tosc_bundle bundle;
+	tosc_writeBundle(&bundle, TINYOSC_TIMETAG_IMMEDIATELY, buffer, sizeof(buffer));
+	tosc_writeNextMessage(&bundle, "/filter/gain", "f", 44.0f);
+	tosc_writeNextMessage(&bundle, "/filter/trigger", "");
+	std::vector<uint8_t> bundleFrame = TestConnector::encodeFrame(buffer, tosc_getBundleLength(&bundle));
+	gainAtTrigger = -1;
+	offset = client.receiveRaw(bundleFrame.data(), bundleFrame.size());
+	CHECK(offset < bundleFrame.size());
+	CHECK(client.receiveRaw(bundleFrame.data() + offset, bundleFrame.size() - offset) == 0);
+	CHECK(gainAtTrigger == -1);
+	root.executeReceivedMessages();
+	CHECK(client.receiveRaw(bundleFrame.data() + offset, bundleFrame.size() - offset) == bundleFrame.size() - offset);
+	CHECK(gainAtTrigger == 44.0f);
+
+	// Timetagged parameters wait for free schedule slots
+	size_t scheduled = 0;
+	for(size_t i = 0; i < 40; i++) {
+		tosc_writeBundle(&bundle, ((uint64_t) i + 1) << 32, buffer, sizeof(buffer));
+		tosc_writeNextMessage(&bundle, "/filter/gain", "f", 100.0f + i);
+		bundleFrame = TestConnector::encodeFrame(buffer, tosc_getBundleLength(&bundle));
+		offset = client.receiveRaw(bundleFrame.data(), bundleFrame.size());
+		if(offset != bundleFrame.size())
+			break;
+		scheduled++;
+	}
+	CHECK(scheduled > 0 && scheduled < 40);
+	root.executeScheduledMessages((uint64_t) scheduled << 32);
+	CHECK(gain.get() == 100.0f + scheduled - 1);
+	CHECK(client.receiveRaw(bundleFrame.data() + offset, bundleFrame.size() - offset) == bundleFrame.size() - offset);
+	root.executeScheduledMessages((uint64_t) (scheduled + 1) << 32);
+	CHECK(gain.get() == 100.0f + scheduled);
+
+	return TEST_RESULT();
+}
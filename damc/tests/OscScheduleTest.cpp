@@ -0,0 +1,108 @@
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <CompressorFilter.h>
+#include <Osc/OscEndpoint.h>
+#include <Osc/OscVariable.h>
+#include <memory>
+#include <vector>
+
+// Timetagged bundles: only parameters are scheduled, they are applied by executeScheduledMessages (the audio
+// processing) which sends nothing, the main loop sends their new value with the next flush
+
+static constexpr uint64_t TIMETAG = 100ull << 32;
+
+template<typename... Args>
+static void receiveBundle(TestConnector& client, uint64_t timetag, const char* address, const char* format, Args... args) {
+	char buffer[256];
+	tosc_bundle bundle;
+	tosc_writeBundle(&bundle, timetag, buffer, sizeof(buffer));
+	tosc_writeNextMessage(&bundle, address, format, args...);
+	client.receivePacket(buffer, tosc_getBundleLength(&bundle));
+}
+
+int main() {
+	OscRoot root(true);
+	TestConnector client(&root);
+	OscContainer filter(&root, "filter");
+	OscVariable<float> gain(&filter, "gain", 0.f);
+	OscVariable<std::string> name(&filter, "name", "a");
+	OscVariable<int32_t> delay(&filter, "delay", 0);
+	OscEndpoint trigger(&filter, "trigger");
+	CompressorFilter compressor(&root);
+
+	int triggerCount = 0;
+	trigger.setCallback([&triggerCount](const std::vector<OscArgument>&) { triggerCount++; });
+	int valueChangedCount = 0;
+	root.setOnOscValueChanged([&valueChangedCount]() { valueChangedCount++; });
+	delay.setMainLoopOnly();
+
+	// Parameters
+	CHECK(root.isAudioParameter("filter/gain"));
+	CHECK(root.isAudioParameter("filter/gain/increment"));
+	CHECK(root.isAudioParameter("compressorFilter/ratio"));
+	CHECK(root.isAudioParameter("compressorFilter/*"));
+	CHECK(root.isAudioParameter("filter/unknown"));
+	// Requests, allocations and reconfigurations
+	CHECK(!root.isAudioParameter("filter/gain/dump"));
+	CHECK(!root.isAudioParameter("compressorFilter/ratio/dump"));
+	CHECK(!root.isAudioParameter("filter/name"));
+	CHECK(!root.isAudioParameter("filter/delay"));
+	CHECK(!root.isAudioParameter("filter/trigger"));
+	CHECK(!root.isAudioParameter("filter/dump"));
+	CHECK(!root.isAudioParameter("filter/*"));
+	CHECK(!root.isAudioParameter("**/gain"));
+	CHECK(!root.isAudioParameter("sync"));
+
+	root.flushMessages();
+	client.messages.clear();
+
+	receiveBundle(client, TIMETAG, "/filter/gain", "f", 6.0f);
+	receiveBundle(client, TIMETAG, "/compressorFilter/ratio", "f", 4.0f);
+	receiveBundle(client, TIMETAG, "/filter/trigger", "");
+	receiveBundle(client, TIMETAG, "/filter/name", "s", "b");
+	CHECK(root.getNextScheduledTimetag() == TIMETAG);
+
+	root.executeScheduledMessages(TIMETAG - 1);
+	CHECK(gain.get() == 0);
+
+	root.executeScheduledMessages(TIMETAG);
+	CHECK(gain.get() == 6);
+	CHECK(compressor.getValue(compressor.findEntry("ratio")) == OscArgument(4.0f));
+	CHECK(root.getNextScheduledTimetag() == OscRoot::NO_SCHEDULED_MESSAGE);
+	// Refused, not executed now
+	CHECK(triggerCount == 0);
+	CHECK(name.get() == "a");
+	// Nothing sent from the audio processing
+	CHECK(client.messages.empty());
+	CHECK(valueChangedCount == 0);
+
+	root.flushMessages();
+	CHECK(client.hasSent("/filter/gain 6"));
+	CHECK(client.hasSent("/compressorFilter/ratio 4"));
+	CHECK(valueChangedCount == 1);
+
+	// More changes than queued notifications in one block: values changed by the block are dumped instead
+	std::vector<std::string> names;
+	std::vector<std::unique_ptr<OscVariable<int32_t>>> values;
+	for(size_t i = 0; i < OscRoot::DEFERRED_NOTIFICATION_NUMBER + 8; i++)
+		names.push_back("value" + std::to_string(i));
+	for(const std::string& valueName : names)
+		values.emplace_back(new OscVariable<int32_t>(&filter, valueName, 0));
+	gain.addChangeCallback([&values](float v) {
+		for(auto& value : values)
+			value->set((int32_t) v);
+	});
+
+	root.flushMessages();
+	client.messages.clear();
+	receiveBundle(client, TIMETAG + 1, "/filter/gain", "f", 7.0f);
+	root.executeScheduledMessages(TIMETAG + 1);
+	root.flushMessages();
+	while(root.dumpSlice())
+		root.flushMessages();
+	CHECK(client.hasSent("/filter/gain 7"));
+	CHECK(client.hasSent("/filter/value0 7"));
+	CHECK(client.hasSent("/filter/value" + std::to_string(values.size() - 1) + " 7"));
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,116 @@
+#include "AllocationCounter.h"
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <CompressorFilter.h>
+#include <ExpanderFilter.h>
+#include <vector>
+
+// Schema nodes behave like a container of variables at the same addresses, without a node or an allocation per value
+
+template<typename T> static T getValue(const OscSchemaNode& node, const char* name) {
+	return std::get<T>(node.getValue(node.findEntry(name)));
+}
+
+int main() {
+	OscRoot root(true);
+	TestConnector client(&root);
+	OscContainer chain(&root, "chain", 4);
+
+	// Only the objects are allocated (values not sent at init, their message headers are built when first sent)
+	{
+		OscRoot silentRoot(false);
+		OscContainer silentChain(&silentRoot, "chain", 4);
+		size_t allocationsBefore = allocationCount;
+		CompressorFilter* compressor = new CompressorFilter(&silentChain);
+		ExpanderFilter* expander = new ExpanderFilter(&silentChain);
+		CHECK(allocationCount - allocationsBefore == 2);
+		delete expander;
+		delete compressor;
+	}
+
+	CompressorFilter* compressor = new CompressorFilter(&chain);
+	ExpanderFilter* expander = new ExpanderFilter(&chain);
+
+	// Set, clamp to the range, sub-endpoints
+	root.execute("chain/compressorFilter/ratio", std::vector<OscArgument>{0.5f});
+	CHECK(getValue<float>(*compressor, "ratio") == 1.0f);
+	root.execute("chain/compressorFilter/ratio", std::vector<OscArgument>{4.0f});
+	CHECK(getValue<float>(*compressor, "ratio") == 4.0f);
+	root.execute("chain/compressorFilter/ratio/increment", std::vector<OscArgument>{});
+	CHECK(getValue<float>(*compressor, "ratio") == 5.0f);
+	root.execute("chain/compressorFilter/ratio/decrement", std::vector<OscArgument>{2.0f});
+	CHECK(getValue<float>(*compressor, "ratio") == 3.0f);
+	root.execute("chain/compressorFilter/enable/toggle", std::vector<OscArgument>{});
+	CHECK(getValue<bool>(*compressor, "enable"));
+	// Integers converted like variables
+	root.execute("chain/compressorFilter/threshold", std::vector<OscArgument>{int32_t{-20}});
+	CHECK(getValue<float>(*compressor, "threshold") == -20.0f);
+
+	// Unknown values are ignored
+	root.execute("chain/compressorFilter/unknown", std::vector<OscArgument>{1.0f});
+	CHECK(compressor->findEntry("unknown") == compressor->getConfigValueNumber());
+
+	// Values are sent at their own address
+	root.flushMessages();
+	CHECK(client.hasSent("/chain/compressorFilter/ratio 3"));
+	CHECK(client.hasSent("/chain/compressorFilter/enable true"));
+
+	// Wildcard through the parent container
+	root.execute("chain/*/enable/toggle", std::vector<OscArgument>{});
+	CHECK(!getValue<bool>(*compressor, "enable"));
+	CHECK(getValue<bool>(*expander, "enable"));
+
+	root.flushMessages();
+	client.messages.clear();
+	root.execute("chain/expanderFilter/dump", std::vector<OscArgument>{});
+	root.flushMessages();
+	CHECK(client.hasSent("/chain/expanderFilter/ratio 4"));
+	CHECK(client.hasSent("/chain/expanderFilter/releaseTime 8000"));
+	CHECK(client.messages.size() == expander->getConfigValueNumber());
+
+	client.messages.clear();
+	root.execute("chain/compressorFilter/ratio/dump", std::vector<OscArgument>{});
+	root.flushMessages();
+	CHECK((client.messages == std::vector<std::string>{"/chain/compressorFilter/ratio 3"}));
+
+	// Configuration at the addresses of the former variables, only modified values are persisted
+	size_t ratio = compressor->findEntry("ratio");
+	CHECK(compressor->getConfigAddressHash(ratio) == OscNode::hashAddress("/chain/compressorFilter/ratio"));
+	OscArgument value;
+	CHECK(compressor->getConfigValue(ratio, &value) && value == OscArgument(3.0f));
+	CHECK(!compressor->getConfigValue(compressor->findEntry("kneeWidth"), &value));
+
+	// Same state checksum contribution as a variable at the same address
+	uint32_t checksum = root.getStateChecksum();
+	OscArgument ratioValue = 3.0f;
+	OscArgument newRatioValue = 6.0f;
+	root.execute("chain/compressorFilter/ratio", std::vector<OscArgument>{6.0f});
+	uint32_t addressHash = OscNode::hashAddress("/chain/compressorFilter/ratio");
+	CHECK(root.getStateChecksum() == (checksum ^ OscNode::hashState(addressHash, &ratioValue, 1) ^
+	                                  OscNode::hashState(addressHash, &newRatioValue, 1)));
+
+	// The checksum doesn't keep removed values
+	checksum = root.getStateChecksum();
+	{
+		CompressorFilter temporary(&root);
+		temporary.setValue(temporary.findEntry("ratio"), 2.0f);
+	}
+	CHECK(root.getStateChecksum() == checksum);
+
+	// Default configuration loaded by address hash
+	CompressorFilter* loaded = new CompressorFilter(&root);
+	OscRoot::ConfigValue config[] = {
+	    {OscNode::hashAddress("/compressorFilter/makeUpGain"), -1.0f},
+	    {OscNode::hashAddress("/compressorFilter/enable"), true},
+	};
+	root.loadNodeConfig(config, std::size(config));
+	CHECK(getValue<float>(*loaded, "makeUpGain") == -1.0f);
+	CHECK(getValue<bool>(*loaded, "enable"));
+	CHECK(loaded->getAsString().find("\"makeUpGain\": -1") != std::string::npos);
+
+	delete loaded;
+	delete expander;
+	delete compressor;
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,62 @@
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <Osc/OscVariable.h>
+
+// State messages refused by a congested connector are counted and their values are dumped again once it has room
+
+class CongestedConnector : public TestConnector {
+public:
+	using TestConnector::TestConnector;
+	bool congested = false;
+
+protected:
+	bool sendSlipFrame(const uint8_t* data, size_t size) override {
+		if(congested)
+			return false;
+		return TestConnector::sendSlipFrame(data, size);
+	}
+};
+
+int main() {
+	OscRoot root(true);
+	CongestedConnector client(&root);
+	OscContainer filter(&root, "filter");
+	OscVariable<float> gain(&filter, "gain", 0.f);
+	OscVariable<int32_t> delay(&filter, "delay", 0);
+	OscVariable<bool> mute(&filter, "mute", false);
+
+	root.flushMessages();
+	while(root.dumpSlice())
+		root.flushMessages();
+	client.messages.clear();
+
+	// Sent before the congestion
+	mute.set(true);
+	root.flushMessages();
+	CHECK(client.hasSent("/filter/mute true"));
+	CHECK(root.getDroppedStateMessageCount() == 0);
+
+	client.congested = true;
+	client.telemetryAllowed = false;
+	gain.set(3.0f);
+	root.flushMessages();
+	delay.set(7);
+	root.flushMessages();
+	CHECK(root.getDroppedStateMessageCount() == 2);
+	// The dump waits for room
+	CHECK(!root.dumpSlice());
+
+	client.congested = false;
+	client.telemetryAllowed = true;
+	client.messages.clear();
+	while(root.dumpSlice())
+		root.flushMessages();
+	root.flushMessages();
+	CHECK(client.hasSent("/filter/gain 3"));
+	CHECK(client.hasSent("/filter/delay 7"));
+	// Only values changed since the lost messages
+	CHECK(!client.hasSent("/filter/mute"));
+	CHECK(root.getDroppedStateMessageCount() == 2);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,144 @@
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <Osc/OscDynamicVariable.h>
+#include <Osc/OscVariable.h>
+#include <Utils.h>
+#include <map>
+#include <memory>
+#include <stdlib.h>
+#include <vector>
+
+// "/sync" streams the state values changed after a sequence number then replies with the sequence number and the
+// state checksum, which a client computes from its own copy of the state
+
+// Copy of the state kept by a client from the messages it receives
+class MirrorClient : public TestConnector {
+public:
+	using TestConnector::TestConnector;
+
+	// Apply the received messages, return the arguments of the last "/sync" reply
+	bool update(int32_t* sequence, uint32_t* checksum) {
+		bool hasReply = false;
+		for(size_t i = 0; i < messages.size(); i++) {
+			const std::string& message = messages[i];
+			size_t space = message.find(' ');
+			std::string address = message.substr(0, space);
+			std::string value = space != std::string::npos ? message.substr(space + 1) : "";
+
+			if(address == "/sync") {
+				size_t separator = value.find(' ');
+				*sequence = atoi(value.c_str());
+				*checksum = (uint32_t) atoll(value.c_str() + separator + 1);
+				hasReply = true;
+				continue;
+			}
+
+			switch(formats[i][1]) {
+				case 'f':
+					state[address] = (float) atof(value.c_str());
+					break;
+				case 'i':
+					state[address] = (int32_t) atoi(value.c_str());
+					break;
+				case 'T':
+				case 'F':
+					state[address] = formats[i][1] == 'T';
+					break;
+			}
+		}
+		messages.clear();
+		formats.clear();
+		return hasReply;
+	}
+
+	uint32_t computeChecksum() const {
+		uint32_t checksum = 0;
+		for(const auto& [address, value] : state)
+			checksum ^= OscNode::hashState(OscNode::hashAddress(address), &value, 1);
+		return checksum;
+	}
+
+	std::map<std::string, OscArgument> state;
+};
+
+struct Strip {
+	Strip(OscContainer* parent, std::string_view name) : container(parent, name) {
+		values.reserve(100);
+		for(size_t i = 0; i < 100; i++)
+			values.emplace_back(new OscVariable<float>(&container, Utils::toString(i), 0.5f));
+	}
+
+	OscContainer container;
+	OscVariable<int32_t> delay{&container, "delay", 10};
+	OscVariable<bool> mute{&container, "mute", false};
+	std::vector<std::unique_ptr<OscVariable<float>>> values;
+};
+
+static void runDump(OscRoot& root) {
+	while(root.dumpSlice())
+		root.flushMessages();
+	root.flushMessages();
+}
+
+int main() {
+	OscRoot root(false);
+	MirrorClient client(&root);
+	Strip strip(&root, "strip");
+	std::unique_ptr<Strip> removable(new Strip(&root, "removable"));
+	OscDynamicVariable<float> meter(&root, "meter");
+	int32_t sequence = 0;
+	uint32_t checksum = 0;
+
+	// Full sync: every state value, not the telemetry
+	CHECK(client.receive("/sync", "") > 0);
+	runDump(root);
+	CHECK(!client.hasSent("/meter"));
+	CHECK(client.update(&sequence, &checksum));
+	CHECK(client.state.size() == 2 * 102);
+	CHECK(checksum == root.getStateChecksum());
+	CHECK(client.computeChecksum() == checksum);
+
+	// Delta sync after 3 changes, while disconnected (the change notifications are lost)
+	client.telemetryAllowed = false;
+	strip.values[5]->set(0.25f);
+	strip.delay.set(42);
+	removable->mute.set(true);
+	root.flushMessages();
+	client.messages.clear();
+	client.formats.clear();
+	client.telemetryAllowed = true;
+
+	int32_t previousSequence = sequence;
+	CHECK(client.receive("/sync", "i", sequence) > 0);
+	runDump(root);
+	CHECK(client.messages.size() == 3 + 1);
+	CHECK(client.update(&sequence, &checksum));
+	CHECK(sequence != previousSequence);
+	CHECK(client.computeChecksum() == checksum);
+
+	// Idle sync: only the reply
+	CHECK(client.receive("/sync", "i", sequence) > 0);
+	runDump(root);
+	CHECK(client.messages.size() == 1);
+	CHECK(client.update(&sequence, &checksum));
+	CHECK(client.computeChecksum() == checksum);
+
+	// Removed container and variable: the checksum doesn't keep their values, the client copy no longer matches
+	removable.reset();
+	strip.values.pop_back();
+	CHECK(client.receive("/sync", "i", sequence) > 0);
+	runDump(root);
+	CHECK(client.update(&sequence, &checksum));
+	CHECK(client.computeChecksum() != checksum);
+
+	// Full sync from an empty copy
+	client.state.clear();
+	CHECK(client.receive("/sync", "") > 0);
+	runDump(root);
+	CHECK(client.update(&sequence, &checksum));
+	CHECK(client.state.size() == 101);
+	CHECK(client.computeChecksum() == checksum);
+	CHECK(checksum == root.getStateChecksum());
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,49 @@
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <PeakMeter.h>
+
+// Meters accumulated by the audio processing are handed over to onFastTimer through a double buffer: the audio
+// processing swaps at its next block, the accumulator it left is read by the following onFastTimer
+
+int main() {
+	OscRoot root(true);
+	TestConnector client(&root);
+	OscReadOnlyVariable<int32_t> numChannel(&root, "numChannel", 0);
+	OscReadOnlyVariable<int32_t> sampleRate(&root, "sampleRate", 48000);
+	PeakMeter meter(&root, &numChannel, &sampleRate);
+	numChannel.set(2);
+	root.execute("meter_enable_extended", std::vector<OscArgument>{true});
+
+	const float peaks[] = {0.5f, 0.25f};
+	const float sumSquares[] = {48 * 0.25f, 48 * 0.0625f};
+	auto processBlock = [&]() {
+		meter.processSamples(peaks, 2, 48);
+		meter.processExtendedSamples(sumSquares, 48 * 0.125f, 2);
+	};
+
+	// The first blocks are read after the audio processing swapped
+	processBlock();
+	meter.onFastTimer();
+	root.flushMessages();
+	client.messages.clear();
+	processBlock();
+	meter.onFastTimer();
+	root.flushMessages();
+	CHECK(client.hasSent("/meter_per_channel -6.0206 -12.0412"));
+	CHECK(client.hasSent("/meter_rms -6.0206 -12.0412"));
+	CHECK(client.hasSent("/meter_correlation 1"));
+
+	// Without a block since the swap request, nothing is read and the values are not lost
+	client.messages.clear();
+	meter.onFastTimer();
+	root.flushMessages();
+	CHECK(!client.hasSent("/meter_per_channel"));
+
+	processBlock();
+	processBlock();
+	meter.onFastTimer();
+	root.flushMessages();
+	CHECK(client.hasSent("/meter_rms -6.0206 -12.0412"));
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,108 @@
+#include "TestConnector.h"
+#include "TestUtils.h"
+#include <HalfBandOversampler.h>
+#include <SaturationFilter.h>
+#include <chrono>
+#include <math.h>
+#include <vector>
+
+// Aliasing and CPU cost of the saturation with and without oversampling, and its published latency
+
+static constexpr float FS = 48000;
+static constexpr size_t BLOCK_SIZE = 48;
+
+static void setValue(OscRoot& root, const char* address, OscArgument value) {
+	root.execute(address, std::vector<OscArgument>{value});
+}
+
+static void process(SaturationFilter& saturation, std::vector<float>& signal) {
+	for(size_t offset = 0; offset < signal.size(); offset += BLOCK_SIZE) {
+		float* samples[] = {&signal[offset]};
+		saturation.processSamples(samples, BLOCK_SIZE);
+	}
+}
+
+// Level of frequency in signal, in dB relative to a full scale sine
+static float levelDb(const std::vector<float>& signal, size_t start, float frequency) {
+	double re = 0;
+	double im = 0;
+	for(size_t i = start; i < signal.size(); i++) {
+		double phase = 2 * M_PI * frequency * i / FS;
+		re += signal[i] * cos(phase);
+		im += signal[i] * sin(phase);
+	}
+	double amplitude = 2 * sqrt(re * re + im * im) / (signal.size() - start);
+	return 20 * log10(amplitude + 1e-12);
+}
+
+// Level of the folded 3rd harmonic of a 15 kHz sine (45 kHz aliased to 3 kHz) relative to the fundamental
+static float measureAliasing(OscRoot& root, SaturationFilter& saturation, bool oversampling) {
+	setValue(root, "saturation/oversampling", oversampling);
+	saturation.reset(FS);
+
+	std::vector<float> signal(BLOCK_SIZE * 200);
+	for(size_t i = 0; i < signal.size(); i++)
+		signal[i] = 0.5f * sinf(2 * (float) M_PI * 15000 * i / FS);
+
+	process(saturation, signal);
+
+	// Skip the filter transient, keep an integer number of periods of both frequencies
+	size_t start = signal.size() - 4800;
+	return levelDb(signal, start, 3000) - levelDb(signal, start, 15000);
+}
+
+static float measureNanosecondsPerSample(OscRoot& root, SaturationFilter& saturation, bool oversampling) {
+	setValue(root, "saturation/oversampling", oversampling);
+
+	std::vector<float> signal(BLOCK_SIZE * 2000);
+	for(size_t i = 0; i < signal.size(); i++)
+		signal[i] = 0.5f * sinf(2 * (float) M_PI * 1000 * i / FS);
+
+	auto begin = std::chrono::steady_clock::now();
+	process(saturation, signal);
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<float, std::nano>(end - begin).count() / signal.size();
+}
+
+int main() {
+	OscRoot root(true);
+	TestConnector client(&root);
+	SaturationFilter saturation(&root);
+	saturation.init(1);
+	saturation.reset(FS);
+
+	// Latency published for the current configuration
+	setValue(root, "saturation/enable", true);
+	setValue(root, "saturation/drive", 0.f);
+	root.flushMessages();
+	CHECK(client.hasSent("/saturation/latency 23"));
+
+	// The impulse response peaks after the published latency
+	std::vector<float> impulse(BLOCK_SIZE * 2, 0);
+	impulse[0] = 0.001f;
+	process(saturation, impulse);
+	size_t peak = 0;
+	for(size_t i = 0; i < impulse.size(); i++) {
+		if(fabsf(impulse[i]) > fabsf(impulse[peak]))
+			peak = i;
+	}
+	CHECK(peak == HalfBandOversampler::LATENCY);
+
+	client.messages.clear();
+	setValue(root, "saturation/oversampling", false);
+	root.flushMessages();
+	CHECK(client.hasSent("/saturation/latency 0"));
+
+	setValue(root, "saturation/drive", 12.f);
+	float aliasing = measureAliasing(root, saturation, false);
+	float aliasingOversampled = measureAliasing(root, saturation, true);
+	printf("aliasing of the 3rd harmonic of 15 kHz: %.1f dB, oversampled: %.1f dB\n", aliasing, aliasingOversampled);
+	CHECK(aliasingOversampled < aliasing - 40);
+
+	float cost = measureNanosecondsPerSample(root, saturation, false);
+	float costOversampled = measureNanosecondsPerSample(root, saturation, true);
+	printf("cost per sample: %.1f ns, oversampled: %.1f ns (host CPU)\n", cost, costOversampled);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <OscRoot.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <tinyosc.h>
+#include <vector>
+
+/**
+ * @brief SLIP connector standing for a host client in the tests.
+ * Messages sent by the device are decoded and recorded as text, "<address> <arguments>" with arguments separated by
+ * spaces (floats with %g, booleans as true/false, strings as is).
+ */
+class TestConnector : public OscConnector {
+public:
+	TestConnector(OscRoot* root) : OscConnector(root, true) {}
+
+	// Feed a packet as received from the host, return the number of bytes consumed by the device
+	size_t receivePacket(const char* data, size_t size) {
+		std::vector<uint8_t> frame = encodeFrame(data, size);
+		return onOscDataReceived(frame.data(), frame.size());
+	}
+
+	static std::vector<uint8_t> encodeFrame(const char* data, size_t size) {
+		std::vector<uint8_t> frame;
+		encodeSlip((const uint8_t*) data, size, [&frame](uint8_t c) { frame.push_back(c); });
+		return frame;
+	}
+
+	// Feed the remaining bytes of a previous receivePacket
+	size_t receiveRaw(const uint8_t* data, size_t size) { return onOscDataReceived(data, size); }
+
+	template<typename... Args> size_t receive(const char* address, const char* format, Args... args) {
+		char buffer[256];
+		uint32_t size = tosc_writeMessage(buffer, sizeof(buffer), address, format, args...);
+		return receivePacket(buffer, size);
+	}
+
+	bool canSendTelemetry(size_t) override { return telemetryAllowed; }
+
+	// True if a message starting with text was sent
+	bool hasSent(const std::string& text) const {
+		for(const std::string& message : messages) {
+			if(message.compare(0, text.size(), text) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	std::vector<std::string> messages;
+	// OSC type tags of each message, with the leading ','
+	std::vector<std::string> formats;
+	bool telemetryAllowed = true;
+
+protected:
+	void sendOscData(const uint8_t* data, size_t size) override {
+		std::vector<uint8_t> decoded;
+		for(size_t i = 1; i + 1 < size; i++) {
+			if(data[i] == SLIP_ESC) {
+				i++;
+				decoded.push_back(data[i] == SLIP_ESC_END ? SLIP_END : SLIP_ESC);
+			} else {
+				decoded.push_back(data[i]);
+			}
+		}
+
+		if(tosc_isBundle((const char*) decoded.data())) {
+			tosc_bundle_const bundle;
+			tosc_message_const osc;
+			tosc_parseBundle(&bundle, (const char*) decoded.data(), decoded.size());
+			while(tosc_getNextMessage(&bundle, &osc))
+				recordMessage(&osc);
+		} else {
+			tosc_message_const osc;
+			if(tosc_parseMessage(&osc, (const char*) decoded.data(), decoded.size()) == 0)
+				recordMessage(&osc);
+		}
+	}
+
+	void recordMessage(tosc_message_const* osc) {
+		std::string text = tosc_getAddress(osc);
+		char value[32];
+
+		for(const char* type = tosc_getFormat(osc); *type; type++) {
+			switch(*type) {
+				case 'i':
+					snprintf(value, sizeof(value), " %d", tosc_getNextInt32(osc));
+					text += value;
+					break;
+				case 'f':
+					snprintf(value, sizeof(value), " %g", tosc_getNextFloat(osc));
+					text += value;
+					break;
+				case 's':
+					text += ' ';
+					text += tosc_getNextString(osc);
+					break;
+				case 'T':
+					text += " true";
+					break;
+				case 'F':
+					text += " false";
+					break;
+				case 'b': {
+					const char* blob;
+					int blobSize;
+					tosc_getNextBlob(osc, &blob, &blobSize);
+					text += " <blob>";
+					break;
+				}
+			}
+		}
+
+		messages.push_back(text);
+		formats.push_back(tosc_getFormat(osc) - 1);
+	}
+};
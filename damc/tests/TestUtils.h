@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdio.h>
+
+// Minimal checks for the host tests: failures are printed and counted, main returns TEST_RESULT()
+inline int testFailures = 0;
+
+#define CHECK(condition_) \
+	do { \
+		if(!(condition_)) { \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition_); \
+			testFailures++; \
+		} \
+	} while(0)
+
+#define TEST_RESULT() (testFailures == 0 ? 0 : 1)
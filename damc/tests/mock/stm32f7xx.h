@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+// Interrupt masking of the host tests: PRIMASK is a variable, interrupts never happen
+
+struct MockCpu {
+	static inline uint32_t primask = 0;
+	// Number of times interrupts were masked
+	static inline int disableCount = 0;
+};
+
+inline uint32_t __get_PRIMASK() {
+	return MockCpu::primask;
+}
+
+inline void __set_PRIMASK(uint32_t priMask) {
+	MockCpu::primask = priMask;
+}
+
+inline void __disable_irq() {
+	MockCpu::primask = 1;
+	MockCpu::disableCount++;
+}
+
+inline void __enable_irq() {
+	MockCpu::primask = 0;
+}
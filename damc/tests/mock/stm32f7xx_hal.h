@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// Flash HAL of the host tests: the sector is a RAM mapping at its flash address (see MockFlash::map), programming
+// clears bits like the flash does
+
+typedef enum { HAL_OK, HAL_ERROR } HAL_StatusTypeDef;
+
+typedef struct {
+	uint32_t TypeErase;
+	uint32_t Banks;
+	uint32_t Sector;
+	uint32_t NbSectors;
+	uint32_t VoltageRange;
+} FLASH_EraseInitTypeDef;
+
+#define FLASH_TYPEERASE_SECTORS 0
+#define FLASH_SECTOR_7 7
+#define FLASH_VOLTAGE_RANGE_3 2
+#define FLASH_TYPEPROGRAM_WORD 2
+
+struct MockFlash {
+	// Sector 7 of the STM32F723, the last 128K of its 512K flash
+	static constexpr uint32_t SECTOR_7_ADDRESS = 0x08060000;
+	static constexpr uint32_t SECTOR_7_SIZE = 128 * 1024;
+
+	static inline int programCount = 0;
+	static inline int eraseCount = 0;
+	// Number of words programmed before failing like a power loss, -1 to never fail
+	static inline int failAfter = -1;
+};
+
+inline void HAL_FLASH_Unlock() {}
+inline void HAL_FLASH_Lock() {}
+
+inline HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef* eraseInit, uint32_t* sectorError) {
+	if(eraseInit->Sector != FLASH_SECTOR_7 || eraseInit->NbSectors != 1)
+		return HAL_ERROR;
+
+	MockFlash::eraseCount++;
+	memset((void*) (uintptr_t) MockFlash::SECTOR_7_ADDRESS, 0xFF, MockFlash::SECTOR_7_SIZE);
+	*sectorError = 0xFFFFFFFF;
+	return HAL_OK;
+}
+
+inline HAL_StatusTypeDef HAL_FLASH_Program(uint32_t typeProgram, uint32_t address, uint64_t data) {
+	if(typeProgram != FLASH_TYPEPROGRAM_WORD || address < MockFlash::SECTOR_7_ADDRESS ||
+	   address + 4 > MockFlash::SECTOR_7_ADDRESS + MockFlash::SECTOR_7_SIZE || (address & 3) != 0)
+		return HAL_ERROR;
+
+	if(MockFlash::failAfter == 0)
+		return HAL_ERROR;
+	if(MockFlash::failAfter > 0)
+		MockFlash::failAfter--;
+
+	MockFlash::programCount++;
+	*(uint32_t*) (uintptr_t) address &= (uint32_t) data;
+	return HAL_OK;
+}
+
+inline void SCB_InvalidateDCache_by_Addr(uint32_t*, int32_t) {}